@@ -1,8 +1,11 @@
 #version 150
 
 uniform sampler2D tex0;
+uniform vec4 globalColor;
 uniform vec3 chromaColor;
 uniform float tolerance;
+uniform float softness;
+uniform float spill;
 
 in vec2 texCoordVarying;
 out vec4 outputColor;
@@ -11,15 +14,22 @@ void main() {
     // Sample the texture
     vec4 color = texture(tex0, texCoordVarying);
     
-    // Calculate color distance from chroma key color
-    float distance = length(color.rgb - chromaColor);
+    // Distance from the chroma key color, normalized to 0-1
+    float distance = length(color.rgb - chromaColor) / sqrt(3.0);
     
-    // Create a smooth mask based on distance
-    float mask = smoothstep(tolerance, tolerance + 0.1, distance);
+    // Smooth mask from the tolerance out over the softness
+    float mask = smoothstep(tolerance, tolerance + max(softness, 0.0001), distance);
+    
+    // Remove the chroma component along the key color's chroma
+    vec3 keyChroma = chromaColor - dot(chromaColor, vec3(1.0 / 3.0));
+    float keyLength = length(keyChroma);
+    vec3 direction = keyLength > 0.0001 ? keyChroma / keyLength : vec3(0.0);
+    float amount = max(dot(color.rgb - dot(color.rgb, vec3(1.0 / 3.0)), direction), 0.0);
+    color.rgb = clamp(color.rgb - direction * amount * spill, 0.0, 1.0);
     
     // Apply mask to alpha channel
     color.a *= mask;
     
-    // Output the result
-    outputColor = color;
+    // Output the result with the current draw color (opacity)
+    outputColor = color * globalColor;
 }
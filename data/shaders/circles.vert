@@ -0,0 +1,38 @@
+#version 150
+
+// Instanced soft circles for the background CIRCLES pattern.
+// The mesh is a unit triangle fan: position.xy on the unit circle and
+// position.z = 0 at the centre, 1 on the rim.
+uniform mat4 modelViewProjectionMatrix;
+uniform vec2 resolution;
+uniform float phase;
+uniform float colorShift;
+uniform int circleCount;
+
+in vec4 position;
+
+out vec4 circleColor;
+
+const float TWO_PI = 6.28318530718;
+
+// HSB to RGB with hue in degrees
+vec3 hsb2rgb(float hue, float saturation, float brightness) {
+    vec3 k = mod(vec3(5.0, 3.0, 1.0) + hue / 60.0, 6.0);
+    return brightness - brightness * saturation * clamp(min(k, 4.0 - k), 0.0, 1.0);
+}
+
+void main() {
+    float i = float(gl_InstanceID);
+
+    // Three circles per row
+    vec2 centre = resolution * vec2(0.2 + 0.6 * mod(i, 3.0) / 2.0, 0.2 + 0.6 * floor(i / 3.0) / 2.0);
+
+    float baseRadius = 50.0 + 30.0 * sin(phase * TWO_PI);
+    float radius = baseRadius * (0.5 + sin(i + phase * TWO_PI) * 0.5);
+
+    float hue = mod(colorShift + i * (360.0 / float(circleCount)), 360.0);
+    float alpha = mix(200.0 / 255.0, 0.0, position.z);
+    circleColor = vec4(hsb2rgb(hue, 1.0, 200.0 / 255.0), alpha);
+
+    gl_Position = modelViewProjectionMatrix * vec4(centre + position.xy * radius, 0.0, 1.0);
+}
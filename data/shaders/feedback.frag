@@ -1,11 +1,22 @@
 #version 150
 
+// FX feedback: the previous result zoomed, rotated, offset, hue shifted and
+// faded, mixed with the current input in one pass
 uniform sampler2D tex0;
+uniform sampler2D feedbackTex;
+uniform vec2 resolution;
+uniform float zoom;
+uniform float rotate;
+uniform vec2 offset;
 uniform float colorShift;
+uniform float fade;
+uniform float amount;
 
 in vec2 texCoordVarying;
 out vec4 outputColor;
 
+const float TWO_PI = 6.28318530718;
+
 vec3 rgb2hsv(vec3 c) {
     vec4 K = vec4(0.0, -1.0 / 3.0, 2.0 / 3.0, -1.0);
     vec4 p = mix(vec4(c.bg, K.wz), vec4(c.gb, K.xy), step(c.b, c.g));
@@ -23,18 +34,29 @@ vec3 hsv2rgb(vec3 c) {
 }
 
 void main() {
-    // Get the original color
-    vec4 color = texture(tex0, texCoordVarying);
-    
-    // Convert to HSV
-    vec3 hsv = rgb2hsv(color.rgb);
-    
+    vec4 current = texture(tex0, texCoordVarying);
+
+    // Inverse of the zoom, rotation and offset, in pixels so the aspect ratio holds
+    vec2 centre = resolution * 0.5;
+    vec2 position = texCoordVarying * resolution - centre;
+    float angle = -rotate * TWO_PI;
+    float c = cos(angle);
+    float s = sin(angle);
+    vec2 source = (centre + vec2(c * position.x - s * position.y, s * position.x + c * position.y) / zoom - offset) / resolution;
+
+    // Nothing is pulled in from outside the frame
+    vec2 inside = step(vec2(0.0), source) * step(source, vec2(1.0));
+    vec4 feedback = texture(feedbackTex, source);
+
     // Apply hue shift
-    hsv.x = fract(hsv.x + colorShift);
-    
-    // Convert back to RGB
-    color.rgb = hsv2rgb(hsv);
-    
-    // Output the result
-    outputColor = color;
+    if (colorShift != 0.0) {
+        vec3 hsv = rgb2hsv(feedback.rgb);
+        hsv.x = fract(hsv.x + colorShift);
+        feedback.rgb = hsv2rgb(hsv);
+    }
+
+    // Fade the history, then mix it over the input
+    feedback *= 1.0 - fade;
+    float weight = amount * inside.x * inside.y;
+    outputColor = vec4(mix(current.rgb, feedback.rgb, weight), max(current.a, feedback.a * weight));
 }
@@ -0,0 +1,14 @@
+#version 150
+
+// Noise pattern vertex shader
+uniform mat4 modelViewProjectionMatrix;
+
+in vec4 position;
+
+// Canvas position in pixels, used as the noise domain
+out vec2 pixelCoord;
+
+void main() {
+    pixelCoord = position.xy;
+    gl_Position = modelViewProjectionMatrix * position;
+}
@@ -0,0 +1,8 @@
+#version 150
+
+in vec4 colorVarying;
+out vec4 outputColor;
+
+void main() {
+    outputColor = colorVarying;
+}
@@ -0,0 +1,27 @@
+#version 150
+
+// Instanced discs for GPU particles. Instance i reads its state from texel
+// (i % columns, i / columns); nothing per particle comes from the CPU.
+uniform mat4 modelViewProjectionMatrix;
+uniform sampler2D stateA;   // x, y, rotation, scale
+uniform sampler2D colors;   // rgb, opacity
+uniform int columns;
+uniform vec2 resolution;
+uniform float radius;
+
+in vec4 position;
+
+out vec4 colorVarying;
+
+void main() {
+    ivec2 texel = ivec2(gl_InstanceID % columns, gl_InstanceID / columns);
+    vec4 state = texelFetch(stateA, texel, 0);
+
+    vec2 local = position.xy * radius * state.w;
+    float c = cos(state.z);
+    float s = sin(state.z);
+    vec2 rotated = vec2(c * local.x - s * local.y, s * local.x + c * local.y);
+
+    colorVarying = texelFetch(colors, texel, 0);
+    gl_Position = modelViewProjectionMatrix * vec4(state.xy * resolution + rotated, 0.0, 1.0);
+}
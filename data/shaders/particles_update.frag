@@ -0,0 +1,90 @@
+#version 150
+
+// One simulation step for GPU particles, with the same motion and audio
+// rules as SpriteSystem. Each texel is one particle. The state is split
+// over three textures, all written in one pass; GpuParticles binds each
+// output to its attachment before linking.
+uniform sampler2D stateA;      // x, y, rotation, scale
+uniform sampler2D stateB;      // velocity x, velocity y, rotation speed, circle phase
+uniform sampler2D stateC;      // wave phase x, wave phase y, unused, unused
+uniform sampler2D motionParams; // motion type, motion amount, circle radius, audio reactivity
+uniform sampler2D waveParams;   // amplitude x, amplitude y, frequency x, frequency y
+uniform sampler2D baseParams;   // base x, base y, band index, unused
+
+uniform float deltaTime;
+// Band energies, the last entry being the average of all bands
+uniform float bandEnergies[6];
+
+out vec4 outputPosition;   // -> stateA
+out vec4 outputVelocity;   // -> stateB
+out vec4 outputAttributes; // -> stateC
+
+const float PI = 3.14159265359;
+const float HALF_PI = 1.57079632679;
+const float TWO_PI = 6.28318530718;
+
+// Motion types, as in MotionType
+const int MOTION_LINEAR = 1;
+const int MOTION_CIRCULAR = 2;
+const int MOTION_BOUNCE = 3;
+const int MOTION_WAVE = 4;
+
+void main() {
+    ivec2 texel = ivec2(gl_FragCoord.xy);
+    vec4 a = texelFetch(stateA, texel, 0);
+    vec4 b = texelFetch(stateB, texel, 0);
+    vec4 c = texelFetch(stateC, texel, 0);
+    vec4 motion = texelFetch(motionParams, texel, 0);
+    vec4 wave = texelFetch(waveParams, texel, 0);
+    vec4 base = texelFetch(baseParams, texel, 0);
+
+    vec2 position = a.xy;
+    float rotation = a.z;
+    float scale = a.w;
+    vec2 velocity = b.xy;
+    float spin = b.z;
+    float circlePhase = b.w;
+    vec2 wavePhase = c.xy;
+
+    int type = int(motion.x + 0.5);
+    float amount = motion.y;
+    float reactivity = motion.w;
+
+    // Audio reactivity: grow slightly and spin faster with energy
+    float impact = reactivity > 0.0 ? bandEnergies[int(base.z + 0.5)] * reactivity : 0.0;
+    scale *= 1.0 + impact * 0.1;
+    spin += impact * 0.1;
+
+    if (type == MOTION_LINEAR) {
+        // Move, wrapping around the edges
+        position += velocity * deltaTime;
+        position = mix(position, vec2(1.0), vec2(lessThan(position, vec2(0.0))));
+        position = mix(position, vec2(0.0), vec2(greaterThan(position, vec2(1.0))));
+    } else if (type == MOTION_CIRCULAR) {
+        // Orbit the base position, facing the direction of travel
+        circlePhase += deltaTime * amount;
+        position = base.xy + vec2(cos(circlePhase), sin(circlePhase)) * motion.z;
+        rotation = circlePhase + HALF_PI;
+    } else if (type == MOTION_BOUNCE) {
+        // Move, reflecting off the edges and stepping back inside
+        position += velocity * deltaTime * amount;
+        bvec2 hit = bvec2(position.x <= 0.0 || position.x >= 1.0, position.y <= 0.0 || position.y >= 1.0);
+        velocity = mix(velocity, -velocity, vec2(hit));
+        position = mix(position, clamp(position, 0.01, 0.99), vec2(hit));
+    } else if (type == MOTION_WAVE) {
+        // Lissajous path around the base position, facing along it
+        wavePhase += deltaTime * wave.zw * amount;
+        position = base.xy + vec2(cos(wavePhase.x), sin(wavePhase.y)) * wave.xy;
+        float dx = -sin(wavePhase.x) * wave.x * wave.z;
+        float dy = cos(wavePhase.y) * wave.y * wave.w;
+        rotation = atan(dy, dx);
+    }
+
+    // Spin, keeping rotation within (-TWO_PI, TWO_PI)
+    rotation += spin * deltaTime;
+    rotation -= TWO_PI * trunc(rotation / TWO_PI);
+
+    outputPosition = vec4(position, rotation, scale);
+    outputVelocity = vec4(velocity, spin, circlePhase);
+    outputAttributes = vec4(wavePhase, 0.0, 0.0);
+}
@@ -0,0 +1,16 @@
+#version 150
+
+uniform sampler2D atlas;
+uniform int textured;
+
+in vec2 texCoordVarying;
+in vec4 colorVarying;
+out vec4 outputColor;
+
+void main() {
+    if (textured != 0) {
+        outputColor = texture(atlas, texCoordVarying) * colorVarying;
+    } else {
+        outputColor = colorVarying;
+    }
+}
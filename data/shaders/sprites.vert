@@ -0,0 +1,35 @@
+#version 150
+
+// Instanced sprites. The mesh is a unit shape (quad or disc) in [-1, 1];
+// each instance places, rotates and colours one copy of it.
+uniform mat4 modelViewProjectionMatrix;
+
+// Frames per row and rows in the atlas
+uniform vec2 atlasGrid;
+
+in vec4 position;
+in vec2 texcoord;
+
+// x, y, rotation in radians, scale
+in vec4 instanceTransform;
+// half width, half height, atlas frame, unused
+in vec4 instanceShape;
+in vec4 instanceColor;
+
+out vec2 texCoordVarying;
+out vec4 colorVarying;
+
+void main() {
+    vec2 local = position.xy * instanceShape.xy * instanceTransform.w;
+    float c = cos(instanceTransform.z);
+    float s = sin(instanceTransform.z);
+    vec2 rotated = vec2(c * local.x - s * local.y, s * local.x + c * local.y);
+
+    // Frames are laid out row by row
+    float frame = instanceShape.z;
+    vec2 cell = vec2(mod(frame, atlasGrid.x), floor(frame / atlasGrid.x));
+    texCoordVarying = (cell + texcoord) / atlasGrid;
+    colorVarying = instanceColor;
+
+    gl_Position = modelViewProjectionMatrix * vec4(instanceTransform.xy + rotated, 0.0, 1.0);
+}
@@ -6,7 +6,7 @@ uniform float amplitude;
 uniform float frequency;
 uniform float speed;
 uniform vec2 resolution;
-uniform string direction; // "horizontal", "vertical", "both"
+uniform int direction; // 0 = horizontal, 1 = vertical, 2 = both
 uniform float noiseAmount;
 
 in vec2 texCoordVarying;
@@ -22,7 +22,7 @@ void main() {
     vec2 uv = texCoordVarying;
     
     // Apply wave distortion
-    if (direction == "horizontal" || direction == "both") {
+    if (direction != 1) {
         // Horizontal wave
         float xWave = amplitude * 0.01 * sin(uv.y * frequency * 10.0 + time * speed);
         // Add noise if enabled
@@ -32,7 +32,7 @@ void main() {
         uv.x += xWave;
     }
     
-    if (direction == "vertical" || direction == "both") {
+    if (direction != 0) {
         // Vertical wave
         float yWave = amplitude * 0.01 * sin(uv.x * frequency * 10.0 + time * speed);
         // Add noise if enabled
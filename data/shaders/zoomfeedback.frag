@@ -0,0 +1,53 @@
+#version 150
+
+// Background feedback: previous frame zoomed and rotated about the centre,
+// hue shifted and faded, in one pass
+uniform sampler2D tex0;
+uniform vec2 resolution;
+uniform float zoom;
+uniform float rotate;
+uniform float colorShift;
+uniform float amount;
+
+in vec2 texCoordVarying;
+out vec4 outputColor;
+
+const float TWO_PI = 6.28318530718;
+
+vec3 rgb2hsv(vec3 c) {
+    vec4 K = vec4(0.0, -1.0 / 3.0, 2.0 / 3.0, -1.0);
+    vec4 p = mix(vec4(c.bg, K.wz), vec4(c.gb, K.xy), step(c.b, c.g));
+    vec4 q = mix(vec4(p.xyw, c.r), vec4(c.r, p.yzx), step(p.x, c.r));
+
+    float d = q.x - min(q.w, q.y);
+    float e = 1.0e-10;
+    return vec3(abs(q.z + (q.w - q.y) / (6.0 * d + e)), d / (q.x + e), q.x);
+}
+
+vec3 hsv2rgb(vec3 c) {
+    vec4 K = vec4(1.0, 2.0 / 3.0, 1.0 / 3.0, 3.0);
+    vec3 p = abs(fract(c.xxx + K.xyz) * 6.0 - K.www);
+    return c.z * mix(K.xxx, clamp(p - K.xxx, 0.0, 1.0), c.y);
+}
+
+void main() {
+    // Inverse of the zoom and rotation, in pixels so the aspect ratio holds
+    vec2 centre = resolution * 0.5;
+    vec2 offset = texCoordVarying * resolution - centre;
+    float angle = -rotate * TWO_PI;
+    float c = cos(angle);
+    float s = sin(angle);
+    vec2 source = (centre + vec2(c * offset.x - s * offset.y, s * offset.x + c * offset.y) / zoom) / resolution;
+
+    // Nothing is pulled in from outside the frame
+    vec2 inside = step(vec2(0.0), source) * step(source, vec2(1.0));
+    vec4 color = texture(tex0, source);
+
+    // Apply hue shift
+    vec3 hsv = rgb2hsv(color.rgb);
+    hsv.x = fract(hsv.x + colorShift);
+    color.rgb = hsv2rgb(hsv);
+
+    color.a *= amount * inside.x * inside.y;
+    outputColor = color;
+}
@@ -1,5 +1,24 @@
 // File: src/Layers/BackgroundLayer.cpp
 #include "BackgroundLayer.h"
+#include "../Utils/ParallelFor.h"
+
+// CPU noise is sampled every noiseCellSize pixels and interpolated. At the
+// default density a noise feature spans about 40 pixels, so this is not visible
+static const int noiseCellSize = 4;
+
+// HSB to RGB with hue in degrees and all other values 0-1. Branch-free,
+// matching hsb2rgb() in shaders/noise.frag
+static inline float hsbChannel(float n, float hue, float saturation, float brightness) {
+    float k = n + hue / 60.0f;
+    k -= k >= 6.0f ? 6.0f : 0.0f;
+    float ramp = std::min(std::min(k, 4.0f - k), 1.0f);
+    return brightness - brightness * saturation * std::max(ramp, 0.0f);
+}
+
+// Patterns keep hue in degrees, like the shaders; ofColor::fromHsb takes 0-255
+static inline ofColor colorFromHueDegrees(float hue, float saturation, float brightness, float alpha = 255) {
+    return ofColor::fromHsb(hue * 255.0f / 360.0f, saturation, brightness, alpha);
+}
 
 BackgroundLayer::BackgroundLayer() {
     width = 1280;
@@ -23,7 +42,13 @@ BackgroundLayer::BackgroundLayer() {
     patternTime = 0.0;
     
     cameraSource = nullptr;
-    hasFeedbackTexture = false;
+    feedbackSource = nullptr;
+    feedbackLatency = 0;
+    feedbackDelayIndex = 0;
+    outputIndex = 0;
+    
+    noiseGridWidth = 0;
+    noiseGridHeight = 0;
 }
 
 BackgroundLayer::~BackgroundLayer() {
@@ -34,21 +59,51 @@ void BackgroundLayer::setup(int width, int height) {
     this->width = width;
     this->height = height;
     
-    // Set up FBOs
-    outputFbo.allocate(width, height, GL_RGBA);
-    feedbackFbo.allocate(width, height, GL_RGBA);
+    // Set up and clear the ping-pong FBOs
+    for (int i = 0; i < 2; i++) {
+        outputFbos[i].allocate(width, height, GL_RGBA);
+        outputFbos[i].begin();
+        ofClear(0, 0, 0, 0);
+        outputFbos[i].end();
+    }
+    outputIndex = 0;
+    
+    // Load the feedback shader up front so enabling feedback never stalls
+    if (!feedbackShader.load("shaders/zoomfeedback")) {
+        ofLogError("BackgroundLayer") << "Failed to load feedback shader";
+    }
     
-    // Clear FBOs
-    outputFbo.begin();
-    ofClear(0, 0, 0, 0);
-    outputFbo.end();
+    // Build pattern geometry once
+    setupPatternMeshes();
+    colorMeshType = "";
     
-    feedbackFbo.begin();
-    ofClear(0, 0, 0, 0);
-    feedbackFbo.end();
+    // Load the circles shader; without it each circle is drawn separately
+    if (!circlesShader.load("shaders/circles")) {
+        ofLogWarning("BackgroundLayer") << "Failed to load circles shader, drawing circles one by one";
+    }
+    
+    // Load the noise shader; without it the noise pattern renders on the CPU
+    if (!noiseShader.load("shaders/noise")) {
+        ofLogWarning("BackgroundLayer") << "Failed to load noise shader, using CPU noise";
+    }
+    
+    // Persistent buffers for the CPU noise fallback
+    noisePixels.allocate(width, height, OF_PIXELS_RGB);
+    noiseTexture.allocate(width, height, GL_RGB);
+    
+    noiseGridWidth = width / noiseCellSize + 2;
+    noiseGridHeight = height / noiseCellSize + 2;
+    noiseGrid.assign(noiseGridWidth * noiseGridHeight, 0);
+    
+    noiseColumns.resize(width);
+    noiseColumnWeights.resize(width);
+    for (int x = 0; x < width; x++) {
+        noiseColumns[x] = x / noiseCellSize;
+        noiseColumnWeights[x] = (float)(x % noiseCellSize) / noiseCellSize;
+    }
 }
 
-void BackgroundLayer::update(float deltaTime, float* audioData, int numBands, float phase) {
+void BackgroundLayer::update(float deltaTime, const AudioFrame& audio) {
     // Update pattern time
     patternTime += deltaTime * patternSpeed;
     
@@ -58,18 +113,26 @@ void BackgroundLayer::update(float deltaTime, float* audioData, int numBands, fl
     }
     
     // Apply audio reactivity
-    if (audioData != nullptr) {
-        applyAudioReactivity(audioData, numBands);
-    }
+    applyAudioReactivity(audio);
 }
 
 void BackgroundLayer::draw() {
-    outputFbo.begin();
+    // Draw into the other FBO; the current one holds the previous frame
+    ofFbo& previous = outputFbos[outputIndex];
+    ofFbo& target = outputFbos[1 - outputIndex];
+    
+    // Advance the feedback delay before binding the target
+    const ofTexture* feedbackTexture = nullptr;
+    if (feedbackAmount > 0.0) {
+        feedbackTexture = updateFeedbackDelay();
+    }
+    
+    target.begin();
     ofClear(0, 0, 0, 255);
     
     // Apply feedback if enabled
     if (feedbackAmount > 0.0) {
-        applyFeedback();
+        applyFeedback(previous, feedbackTexture);
     }
     
     // Render based on source type
@@ -88,7 +151,8 @@ void BackgroundLayer::draw() {
             break;
     }
     
-    outputFbo.end();
+    target.end();
+    outputIndex = 1 - outputIndex;
 }
 
 void BackgroundLayer::setSourceType(SourceType type) {
@@ -107,13 +171,118 @@ void BackgroundLayer::setCameraSource(ofVideoGrabber& camera) {
     sourceType = CAMERA;
 }
 
-void BackgroundLayer::setFeedbackTexture(ofPixels& pixels) {
-    if (!feedbackTexture.isAllocated()) {
-        feedbackTexture.allocate(pixels);
-    } else {
-        feedbackTexture.loadData(pixels);
+void BackgroundLayer::setFeedbackLatency(int frames) {
+    feedbackLatency = max(0, frames);
+    
+    // Drop the ring; it is reallocated at the new length on next use
+    feedbackDelay.clear();
+    feedbackDelayIndex = 0;
+}
+
+const ofTexture* BackgroundLayer::updateFeedbackDelay() {
+    if (feedbackSource == nullptr || !feedbackSource->isAllocated()) {
+        return nullptr;
     }
-    hasFeedbackTexture = true;
+    
+    // Live: sample the source directly
+    if (feedbackLatency == 0) {
+        return feedbackSource;
+    }
+    
+    // (Re)allocate the ring when the length or source size changes
+    int sourceWidth = feedbackSource->getWidth();
+    int sourceHeight = feedbackSource->getHeight();
+    if ((int)feedbackDelay.size() != feedbackLatency + 1 ||
+        feedbackDelay[0].getWidth() != sourceWidth ||
+        feedbackDelay[0].getHeight() != sourceHeight) {
+        feedbackDelay.resize(feedbackLatency + 1);
+        for (auto& fbo : feedbackDelay) {
+            fbo.allocate(sourceWidth, sourceHeight, GL_RGBA);
+            fbo.begin();
+            ofClear(0, 0, 0, 0);
+            fbo.end();
+        }
+        feedbackDelayIndex = 0;
+    }
+    
+    // Copy this frame into the ring on the GPU
+    feedbackDelay[feedbackDelayIndex].begin();
+    ofClear(0, 0, 0, 0);
+    feedbackSource->draw(0, 0);
+    feedbackDelay[feedbackDelayIndex].end();
+    
+    // The next slot is the oldest, written feedbackLatency frames ago
+    feedbackDelayIndex = (feedbackDelayIndex + 1) % feedbackDelay.size();
+    return &feedbackDelay[feedbackDelayIndex].getTexture();
+}
+
+void BackgroundLayer::setupPatternMeshes() {
+    // Gradient pattern: corners top-left, top-right, bottom-left, bottom-right
+    gradientMesh.clear();
+    gradientMesh.setMode(OF_PRIMITIVE_TRIANGLE_STRIP);
+    gradientMesh.addVertex(ofVec3f(0, 0, 0));
+    gradientMesh.addVertex(ofVec3f(width, 0, 0));
+    gradientMesh.addVertex(ofVec3f(0, height, 0));
+    gradientMesh.addVertex(ofVec3f(width, height, 0));
+    for (int i = 0; i < 4; i++) {
+        gradientMesh.addColor(ofColor::white);
+    }
+    
+    // Unit disc for the circles pattern; z marks the rim for the shader
+    int segments = 32;
+    circleMesh.clear();
+    circleMesh.setMode(OF_PRIMITIVE_TRIANGLE_FAN);
+    circleMesh.addVertex(ofVec3f(0, 0, 0));
+    circleMesh.addColor(ofColor(255, 255, 255, 200));
+    for (int j = 0; j <= segments; j++) {
+        float angle = TWO_PI * j / segments;
+        circleMesh.addVertex(ofVec3f(cos(angle), sin(angle), 1));
+        circleMesh.addColor(ofColor(255, 255, 255, 0));
+    }
+}
+
+void BackgroundLayer::rebuildColorMesh() {
+    colorMesh.clear();
+    
+    if (gradientType == "linear") {
+        // Linear gradient from top to bottom
+        colorMesh.setMode(OF_PRIMITIVE_TRIANGLE_STRIP);
+        colorMesh.addVertex(ofVec3f(0, 0, 0));
+        colorMesh.addVertex(ofVec3f(width, 0, 0));
+        colorMesh.addVertex(ofVec3f(0, height, 0));
+        colorMesh.addVertex(ofVec3f(width, height, 0));
+        
+        colorMesh.addColor(colorStart);
+        colorMesh.addColor(colorStart);
+        colorMesh.addColor(colorEnd);
+        colorMesh.addColor(colorEnd);
+    } else if (gradientType == "radial") {
+        // Radial gradient from center
+        int numSegments = 32;
+        float centerX = width / 2;
+        float centerY = height / 2;
+        float radius = sqrt(width * width + height * height) / 2;
+        
+        colorMesh.setMode(OF_PRIMITIVE_TRIANGLE_FAN);
+        
+        // Add center vertex
+        colorMesh.addVertex(ofVec3f(centerX, centerY, 0));
+        colorMesh.addColor(colorStart);
+        
+        // Add outer vertices
+        for (int i = 0; i <= numSegments; i++) {
+            float angle = TWO_PI * i / numSegments;
+            float x = centerX + radius * cos(angle);
+            float y = centerY + radius * sin(angle);
+            
+            colorMesh.addVertex(ofVec3f(x, y, 0));
+            colorMesh.addColor(colorEnd);
+        }
+    }
+    
+    colorMeshType = gradientType;
+    colorMeshStart = colorStart;
+    colorMeshEnd = colorEnd;
 }
 
 void BackgroundLayer::renderColorBackground() {
@@ -125,48 +294,13 @@ void BackgroundLayer::renderColorBackground() {
         ofSetColor(colorStart);
         ofDrawRectangle(0, 0, width, height);
     } else {
-        // Create gradient mesh
-        ofMesh mesh;
-        mesh.setMode(OF_PRIMITIVE_TRIANGLE_STRIP);
-        
-        if (gradientType == "linear") {
-            // Linear gradient from top to bottom
-            mesh.addVertex(ofVec3f(0, 0, 0));
-            mesh.addVertex(ofVec3f(width, 0, 0));
-            mesh.addVertex(ofVec3f(0, height, 0));
-            mesh.addVertex(ofVec3f(width, height, 0));
-            
-            mesh.addColor(colorStart);
-            mesh.addColor(colorStart);
-            mesh.addColor(colorEnd);
-            mesh.addColor(colorEnd);
-        } else if (gradientType == "radial") {
-            // Radial gradient from center
-            int numSegments = 32;
-            float centerX = width / 2;
-            float centerY = height / 2;
-            float radius = sqrt(width * width + height * height) / 2;
-            
-            // Add center vertex
-            mesh.addVertex(ofVec3f(centerX, centerY, 0));
-            mesh.addColor(colorStart);
-            
-            // Add outer vertices
-            for (int i = 0; i <= numSegments; i++) {
-                float angle = TWO_PI * i / numSegments;
-                float x = centerX + radius * cos(angle);
-                float y = centerY + radius * sin(angle);
-                
-                mesh.addVertex(ofVec3f(x, y, 0));
-                mesh.addColor(colorEnd);
-            }
-            
-            // Set to triangle fan mode
-            mesh.setMode(OF_PRIMITIVE_TRIANGLE_FAN);
+        // Rebuild the gradient mesh only when it changed
+        if (colorMeshType != gradientType || colorMeshStart != colorStart || colorMeshEnd != colorEnd) {
+            rebuildColorMesh();
         }
         
         // Draw gradient mesh
-        mesh.draw();
+        colorMesh.draw();
     }
     
     ofPopStyle();
@@ -272,27 +406,18 @@ void BackgroundLayer::renderGradientPattern(float phase) {
     float hue3 = fmodf(baseHue + 240.0, 360.0);
     
     // Create shifting colors
-    ofColor color1 = ofColor::fromHsb(hue1, 255, 200);
-    ofColor color2 = ofColor::fromHsb(hue2, 255, 200);
-    ofColor color3 = ofColor::fromHsb(hue3, 255, 200);
-    
-    // Create gradient mesh
-    ofMesh mesh;
-    mesh.setMode(OF_PRIMITIVE_TRIANGLE_STRIP);
+    ofColor color1 = colorFromHueDegrees(hue1, 255, 200);
+    ofColor color2 = colorFromHueDegrees(hue2, 255, 200);
+    ofColor color3 = colorFromHueDegrees(hue3, 255, 200);
     
-    // Linear gradient from top left to bottom right
-    mesh.addVertex(ofVec3f(0, 0, 0));
-    mesh.addVertex(ofVec3f(width, 0, 0));
-    mesh.addVertex(ofVec3f(0, height, 0));
-    mesh.addVertex(ofVec3f(width, height, 0));
-    
-    mesh.addColor(color1);
-    mesh.addColor(color2);
-    mesh.addColor(color3);
-    mesh.addColor(color1);
+    // Update the corner colors of the cached mesh
+    gradientMesh.setColor(0, color1);
+    gradientMesh.setColor(1, color2);
+    gradientMesh.setColor(2, color3);
+    gradientMesh.setColor(3, color1);
     
     // Draw gradient mesh
-    mesh.draw();
+    gradientMesh.draw();
     
     ofPopStyle();
 }
@@ -309,7 +434,7 @@ void BackgroundLayer::renderBarsPattern(float phase) {
         
         // Calculate color based on position
         float hue = fmodf(colorShift + i * (360.0f / barCount), 360.0f);
-        ofColor color = ofColor::fromHsb(hue, 255, 200);
+        ofColor color = colorFromHueDegrees(hue, 255, 200);
         ofSetColor(color);
         
         // Draw bar
@@ -325,42 +450,43 @@ void BackgroundLayer::renderCirclesPattern(float phase) {
     ofBackground(0);
     
     int circleCount = max(1, (int)(patternDensity * 5.0));
-    float baseRadius = 50.0 + 30.0 * sin(phase * TWO_PI);
     
-    for (int i = 0; i < circleCount; i++) {
-        // Calculate circle position based on index
-        float x = width * (0.2 + 0.6 * (i % 3) / 2.0);
-        float y = height * (0.2 + 0.6 * floor(i / 3.0) / 2.0);
-        
-        // Calculate radius with variation
-        float radius = baseRadius * (0.5 + sin(i + phase * TWO_PI) * 0.5);
-        
-        // Calculate color based on position and time
-        float hue = fmodf(colorShift + i * (360.0f / circleCount), 360.0f);
-        
-        // Create gradient for each circle
-        ofColor centerColor = ofColor::fromHsb(hue, 255, 200, 200);
-        ofColor edgeColor = ofColor::fromHsb(hue, 255, 200, 0);
-        
-        // Draw circle with gradient
-        ofMesh mesh;
-        mesh.setMode(OF_PRIMITIVE_TRIANGLE_FAN);
-        
-        // Center vertex
-        mesh.addVertex(ofVec3f(x, y, 0));
-        mesh.addColor(centerColor);
+    if (circlesShader.isLoaded()) {
+        // All circles in one instanced draw; layout, radius and hue are computed per instance
+        circlesShader.begin();
+        circlesShader.setUniform2f("resolution", width, height);
+        circlesShader.setUniform1f("phase", phase);
+        circlesShader.setUniform1f("colorShift", colorShift);
+        circlesShader.setUniform1i("circleCount", circleCount);
+        circleMesh.drawInstanced(OF_MESH_FILL, circleCount);
+        circlesShader.end();
+    } else {
+        float baseRadius = 50.0 + 30.0 * sin(phase * TWO_PI);
         
-        // Edge vertices
-        int segments = 32;
-        for (int j = 0; j <= segments; j++) {
-            float angle = TWO_PI * j / segments;
-            float px = x + radius * cos(angle);
-            float py = y + radius * sin(angle);
-            mesh.addVertex(ofVec3f(px, py, 0));
-            mesh.addColor(edgeColor);
+        for (int i = 0; i < circleCount; i++) {
+            // Calculate circle position based on index
+            float x = width * (0.2 + 0.6 * (i % 3) / 2.0);
+            float y = height * (0.2 + 0.6 * floor(i / 3.0) / 2.0);
+            
+            // Calculate radius with variation
+            float radius = baseRadius * (0.5 + sin(i + phase * TWO_PI) * 0.5);
+            
+            // Calculate color based on position and time
+            float hue = fmodf(colorShift + i * (360.0f / circleCount), 360.0f);
+            ofColor centerColor = colorFromHueDegrees(hue, 255, 200, 200);
+            ofColor edgeColor = colorFromHueDegrees(hue, 255, 200, 0);
+            
+            // Recolor and draw the cached unit disc
+            for (size_t j = 0; j < circleMesh.getNumVertices(); j++) {
+                circleMesh.setColor(j, j == 0 ? centerColor : edgeColor);
+            }
+            
+            ofPushMatrix();
+            ofTranslate(x, y);
+            ofScale(radius, radius);
+            circleMesh.draw();
+            ofPopMatrix();
         }
-        
-        mesh.draw();
     }
     
     ofPopStyle();
@@ -368,114 +494,124 @@ void BackgroundLayer::renderCirclesPattern(float phase) {
 
 void BackgroundLayer::renderNoisePattern() {
     ofPushStyle();
+    ofSetColor(255);
+    
+    if (noiseShader.isLoaded()) {
+        // Evaluate the noise per fragment
+        noiseShader.begin();
+        noiseShader.setUniform1f("density", patternDensity);
+        noiseShader.setUniform1f("time", patternTime);
+        noiseShader.setUniform1f("baseHue", colorShift);
+        ofDrawRectangle(0, 0, width, height);
+        noiseShader.end();
+    } else {
+        // CPU fallback into the persistent texture
+        updateNoisePixels();
+        noiseTexture.loadData(noisePixels);
+        noiseTexture.draw(0, 0);
+    }
     
-    // Create noise with perlin
-    ofPixels pixels;
-    pixels.allocate(width, height, OF_PIXELS_RGB);
-    
-    // Base hue for color shifting
+    ofPopStyle();
+}
+
+void BackgroundLayer::updateNoisePixels() {
+    float frequency = 0.005 * patternDensity;
+    float z = patternTime * 0.1;
     float baseHue = colorShift;
     
-    // Generate noise pixels
-    for (int y = 0; y < height; y++) {
-        for (int x = 0; x < width; x++) {
-            // Simple noise function
-            float noise = ofNoise(x * 0.005 * patternDensity, y * 0.005 * patternDensity, patternTime * 0.1);
-            
-            // Apply noise pattern - convert to HSL for better control
-            float hue = fmodf(baseHue + noise * 60.0, 360.0);
-            float saturation = 0.8;
-            float lightness = 0.1 + noise * 0.3;
-            
-            // Convert HSL to RGB
-            ofColor color = ofColor::fromHsb(hue, saturation * 255, lightness * 255);
+    // Sample the noise field on the coarse grid
+    ParallelFor::run(noiseGridHeight, [&](int begin, int end) {
+        for (int gy = begin; gy < end; gy++) {
+            float* row = noiseGrid.data() + gy * noiseGridWidth;
+            for (int gx = 0; gx < noiseGridWidth; gx++) {
+                row[gx] = ofNoise(gx * noiseCellSize * frequency, gy * noiseCellSize * frequency, z);
+            }
+        }
+    });
+    
+    // Interpolate and shade every pixel
+    unsigned char* data = noisePixels.getData();
+    const int* columns = noiseColumns.data();
+    const float* columnWeights = noiseColumnWeights.data();
+    
+    ParallelFor::run(height, [&](int begin, int end) {
+        for (int y = begin; y < end; y++) {
+            const float* top = noiseGrid.data() + (y / noiseCellSize) * noiseGridWidth;
+            const float* bottom = top + noiseGridWidth;
+            float fy = (float)(y % noiseCellSize) / noiseCellSize;
+            unsigned char* out = data + (size_t)y * width * 3;
             
-            // Set pixel color
-            pixels.setColor(x, y, color);
+            for (int x = 0; x < width; x++) {
+                int gx = columns[x];
+                float fx = columnWeights[x];
+                float upper = top[gx] + (top[gx + 1] - top[gx]) * fx;
+                float lower = bottom[gx] + (bottom[gx + 1] - bottom[gx]) * fx;
+                float noise = upper + (lower - upper) * fy;
+                
+                float hue = fmodf(baseHue + noise * 60.0f, 360.0f);
+                float brightness = 0.1f + noise * 0.3f;
+                
+                out[x * 3 + 0] = (unsigned char)(hsbChannel(5.0f, hue, 0.8f, brightness) * 255.0f);
+                out[x * 3 + 1] = (unsigned char)(hsbChannel(3.0f, hue, 0.8f, brightness) * 255.0f);
+                out[x * 3 + 2] = (unsigned char)(hsbChannel(1.0f, hue, 0.8f, brightness) * 255.0f);
+            }
         }
-    }
-    
-    // Draw noise pattern
-    ofTexture tex;
-    tex.loadData(pixels);
-    tex.draw(0, 0);
-    
-    ofPopStyle();
+    });
 }
 
-void BackgroundLayer::applyFeedback() {
+void BackgroundLayer::applyFeedback(ofFbo& previous, const ofTexture* feedbackTexture) {
     if (feedbackAmount <= 0.0) return;
     
-    // Save current output to feedback buffer
-    feedbackFbo.begin();
-    outputFbo.draw(0, 0);
-    feedbackFbo.end();
-    
-    ofPushMatrix();
     ofPushStyle();
-    
-    // Set blend mode and alpha
     ofEnableAlphaBlending();
-    ofSetColor(255, 255, 255, 255 * feedbackAmount);
-    
-    // Apply transformations for feedback
-    ofTranslate(width / 2, height / 2);
-    ofRotateZDeg(feedbackRotate * 360.0);
-    ofScale(feedbackZoom, feedbackZoom);
-    ofTranslate(-width / 2, -height / 2);
-    
-    // Apply color shift if needed
-    static ofShader feedbackShader;
-    if (colorShift != 0.0) {
-        // Load shader if not already loaded
-        if (!feedbackShader.isLoaded()) {
-            bool loaded = feedbackShader.load("shaders/feedback");
-            if (!loaded) {
-                ofLogError("BackgroundLayer") << "Failed to load feedback shader";
-            }
-        }
-        
-        // Begin shader
+    ofSetColor(255);
+    
+    if (feedbackShader.isLoaded()) {
+        // Zoom, rotation, hue shift and fade in one pass
         feedbackShader.begin();
+        feedbackShader.setUniform2f("resolution", width, height);
+        feedbackShader.setUniform1f("zoom", feedbackZoom);
+        feedbackShader.setUniform1f("rotate", feedbackRotate);
         feedbackShader.setUniform1f("colorShift", colorShift / 360.0); // Normalize to 0-1 range
-    }
-    
-    // Draw previous buffer content
-    feedbackFbo.draw(0, 0);
-    
-    // End shader if used
-    if (colorShift != 0.0) {
+        feedbackShader.setUniform1f("amount", feedbackAmount);
+        previous.draw(0, 0);
         feedbackShader.end();
+    } else {
+        // No shader: zoom and rotate with the matrix and fade with alpha,
+        // without the hue shift
+        ofPushMatrix();
+        ofTranslate(width / 2, height / 2);
+        ofRotateZDeg(feedbackRotate * 360.0);
+        ofScale(feedbackZoom, feedbackZoom);
+        ofTranslate(-width / 2, -height / 2);
+        
+        ofSetColor(255, 255, 255, 255 * feedbackAmount);
+        previous.draw(0, 0);
+        
+        ofPopMatrix();
     }
     
-    // Draw camera feedback if available
-    if (hasFeedbackTexture) {
+    // Draw camera feedback if available, with the same zoom and rotation
+    if (feedbackTexture != nullptr) {
+        ofPushMatrix();
+        ofTranslate(width / 2, height / 2);
+        ofRotateZDeg(feedbackRotate * 360.0);
+        ofScale(feedbackZoom, feedbackZoom);
+        ofTranslate(-width / 2, -height / 2);
+        
         ofSetColor(255, 255, 255, 100);
-        feedbackTexture.draw(0, 0, width, height);
+        feedbackTexture->draw(0, 0, width, height);
+        
+        ofPopMatrix();
     }
     
     ofPopStyle();
-    ofPopMatrix();
 }
 
-void BackgroundLayer::applyAudioReactivity(float* audioData, int numBands) {
-    if (audioData == nullptr || numBands <= 0) return;
-    
-    // Calculate bass energy (first 1/4 of bands)
-    float bassEnergy = 0.0;
-    int bassBands = numBands / 4;
-    for (int i = 0; i < bassBands; i++) {
-        bassEnergy += audioData[i];
-    }
-    bassEnergy /= bassBands;
-    
-    // Calculate mid energy (middle 1/2 of bands)
-    float midEnergy = 0.0;
-    int midBands = numBands / 2;
-    for (int i = numBands / 4; i < numBands * 3 / 4; i++) {
-        midEnergy += audioData[i];
-    }
-    midEnergy /= midBands;
+void BackgroundLayer::applyAudioReactivity(const AudioFrame& audio) {
+    // Bass and mid energy, reduced once per frame by AudioAnalyzer
+    float bassEnergy = audio.getBandEnergy(AUDIO_BAND_BASS);
+    float midEnergy = audio.getBandEnergy(AUDIO_BAND_MID);
     
     // Modulate feedback parameters based on audio
     feedbackAmount = ofLerp(feedbackAmount, bassEnergy * 0.8, 0.1);
@@ -509,6 +645,7 @@ void BackgroundLayer::savePreset(ofXml& xml) {
     feedbackXml.appendChild("zoom").set(ofToString(feedbackZoom));
     feedbackXml.appendChild("rotate").set(ofToString(feedbackRotate));
     feedbackXml.appendChild("colorShift").set(ofToString(colorShift));
+    feedbackXml.appendChild("latency").set(ofToString(feedbackLatency));
     xml.appendChild("feedback").appendChild(feedbackXml);
     
     // Save pattern parameters
@@ -562,6 +699,9 @@ void BackgroundLayer::loadPreset(ofXml& xml) {
         setFeedbackZoom(ofToFloat(feedbackXml.getChild("zoom").getValue()));
         setFeedbackRotate(ofToFloat(feedbackXml.getChild("rotate").getValue()));
         setColorShift(ofToFloat(feedbackXml.getChild("colorShift").getValue()));
+        if (feedbackXml.find("latency").size() > 0) {
+            setFeedbackLatency(ofToInt(feedbackXml.getChild("latency").getValue()));
+        }
     }
     
     // Load pattern parameters
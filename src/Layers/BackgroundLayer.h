@@ -2,6 +2,7 @@
 #pragma once
 
 #include "ofMain.h"
+#include "../Utils/AudioFrame.h"
 
 class BackgroundLayer {
 public:
@@ -9,14 +10,19 @@ public:
     ~BackgroundLayer();
     
     void setup(int width, int height);
-    void update(float deltaTime, float* audioData, int numBands, float phase);
+    void update(float deltaTime, const AudioFrame& audio);
     void draw();
     
-    // Set feedback texture from camera
-    void setFeedbackTexture(ofPixels& pixels);
+    // Sample a texture owned elsewhere (e.g. the camera's) as feedback,
+    // or stop with nullptr. The texture must outlive its use here
+    void setFeedbackSource(const ofTexture* texture) { feedbackSource = texture; }
     
-    // Get output FBO
-    ofFbo& getOutputFbo() { return outputFbo; }
+    // Delay the feedback source by this many frames (0 = live)
+    void setFeedbackLatency(int frames);
+    int getFeedbackLatency() const { return feedbackLatency; }
+    
+    // Get output FBO, the most recently drawn of the ping-pong pair
+    ofFbo& getOutputFbo() { return outputFbos[outputIndex]; }
     
     // Save and load presets
     void savePreset(ofXml& xml);
@@ -105,13 +111,45 @@ private:
     float feedbackRotate;
     float colorShift;
     
-    // FBOs for rendering
-    ofFbo outputFbo;
-    ofFbo feedbackFbo;
-    
-    // Feedback texture
-    ofTexture feedbackTexture;
-    bool hasFeedbackTexture;
+    // Ping-pong FBOs: each frame draws into one while the feedback pass
+    // samples the other, so nothing is read from the bound target
+    ofFbo outputFbos[2];
+    int outputIndex;
+    ofShader feedbackShader;
+    
+    // External feedback source and the ring of past frames used to
+    // delay it. The ring holds latency + 1 frames: this frame is written
+    // to one slot while the slot written latency frames ago is sampled
+    const ofTexture* feedbackSource;
+    int feedbackLatency;
+    vector<ofFbo> feedbackDelay;
+    int feedbackDelayIndex;
+    
+    // Cached meshes. The color gradient is rebuilt only when its type,
+    // colors or size change; the gradient pattern only updates its four
+    // vertex colors; circles are one instanced draw of a unit disc
+    ofVboMesh colorMesh;
+    string colorMeshType;
+    ofColor colorMeshStart;
+    ofColor colorMeshEnd;
+    ofVboMesh gradientMesh;
+    ofVboMesh circleMesh;
+    ofShader circlesShader;
+    
+    // Noise pattern: GPU shader, with a CPU fallback that renders into
+    // persistent pixels and texture
+    ofShader noiseShader;
+    ofPixels noisePixels;
+    ofTexture noiseTexture;
+    vector<float> noiseGrid;
+    vector<int> noiseColumns;
+    vector<float> noiseColumnWeights;
+    int noiseGridWidth;
+    int noiseGridHeight;
+    
+    // Build the cached meshes
+    void rebuildColorMesh();
+    void setupPatternMeshes();
     
     // Render methods for different sources
     void renderColorBackground();
@@ -124,10 +162,16 @@ private:
     void renderBarsPattern(float phase);
     void renderCirclesPattern(float phase);
     void renderNoisePattern();
+    void updateNoisePixels();
+    
+    // Draw the previous frame through the feedback shader, then the
+    // external feedback texture if there is one
+    void applyFeedback(ofFbo& previous, const ofTexture* feedbackTexture);
     
-    // Apply feedback effect
-    void applyFeedback();
+    // Push the feedback source into the delay ring and return the texture
+    // to sample this frame, or nullptr without a source
+    const ofTexture* updateFeedbackDelay();
     
     // Apply audio reactivity
-    void applyAudioReactivity(float* audioData, int numBands);
+    void applyAudioReactivity(const AudioFrame& audio);
 };
\ No newline at end of file
@@ -2,6 +2,8 @@
 #pragma once
 
 #include "ofMain.h"
+#include "../Utils/AudioFrame.h"
+#include "../Utils/CameraPipeline.h"
 
 class CameraLayer {
 public:
@@ -9,7 +11,7 @@ public:
     ~CameraLayer();
     
     void setup(int width, int height);
-    void update(float deltaTime, float* audioData, int numBands, float phase);
+    void update(float deltaTime, const AudioFrame& audio);
     void draw();
     
     // Get output FBO
@@ -19,8 +21,16 @@ public:
     void savePreset(ofXml& xml);
     void loadPreset(ofXml& xml);
     
-    // Camera control
-    bool setupCamera(int deviceId = 0);
+    // Camera control. Each camera is an independent pipeline with its own
+    // capture thread, resolution, frame rate, transform and key settings;
+    // all are composited into the output FBO in one pass, in order
+    int addCamera(int deviceId, int width = 640, int height = 480, int frameRate = 30);
+    int addPatternCamera(int width = 640, int height = 480, int frameRate = 30);
+    void removeCamera(int index);
+    void clearCameras();
+    int getNumCameras() const { return pipelines.size(); }
+    CameraPipeline* getCamera(int index);
+    
     void setActive(bool active) { this->active = active; }
     bool isActive() { return active; }
     
@@ -28,60 +38,30 @@ public:
     void setFeedbackEnabled(bool enabled) { feedbackEnabled = enabled; }
     bool isFeedbackEnabled() { return feedbackEnabled; }
     
-    // Set parameters
-    void setX(float x) { this->x = x; }
-    void setY(float y) { this->y = y; }
-    void setScale(float scale) { this->scale = scale; }
-    void setRotation(float rotation) { this->rotation = rotation; }
-    void setOpacity(float opacity) { this->opacity = opacity; }
-    void setMirror(bool mirror) { this->mirror = mirror; }
-    
-    // Chroma key settings
-    void setChromaKey(bool enabled) { chromaKeyEnabled = enabled; }
-    void setChromaColor(ofColor color) { chromaColor = color; }
-    void setChromaTolerance(float tolerance) { chromaTolerance = tolerance; }
+    // Which camera feeds the background feedback
+    void setFeedbackCamera(int index) { feedbackCamera = index; }
+    int getFeedbackCamera() { return feedbackCamera; }
     
-    // Get parameters
-    float getX() { return x; }
-    float getY() { return y; }
-    float getScale() { return scale; }
-    float getRotation() { return rotation; }
-    float getOpacity() { return opacity; }
-    bool getMirror() { return mirror; }
+    // Feedback camera texture for other layers to sample, or nullptr when
+    // inactive
+    const ofTexture* getCameraTexture();
     
-    // Set parameter by name
+    // Set parameter by name on the first camera
     bool setParameter(string name, float value);
     
 private:
     int width, height;
     
-    // Camera settings
-    ofVideoGrabber camera;
     bool active;
     bool feedbackEnabled;
+    int feedbackCamera;
     
-    // Position and transform
-    float x;
-    float y;
-    float scale;
-    float rotation;
-    float opacity;
-    bool mirror;
-    
-    // Chroma key settings
-    bool chromaKeyEnabled;
-    ofColor chromaColor;
-    float chromaTolerance;
+    // Cameras, drawn in order
+    vector<CameraPipeline*> pipelines;
     
-    // Shader for chroma keying
+    // Shader for chroma keying, shared by all cameras
     ofShader chromaKeyShader;
     
     // FBO for rendering
     ofFbo outputFbo;
-    
-    // Apply chroma key effect
-    void applyChromaKey(ofTexture& texture);
-    
-    // Apply audio reactivity
-    void applyAudioReactivity(float* audioData, int numBands);
-};
\ No newline at end of file
+};
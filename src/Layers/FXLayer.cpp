@@ -1,10 +1,14 @@
 // File: src/Layers/FXLayer.cpp
 #include "FXLayer.h"
 #include "PixelateEffect.h"
+#include "GlitchEffect.h"
+#include "WaveEffect.h"
+#include "FeedbackEffect.h"
 
 FXLayer::FXLayer() {
     width = 1280;
     height = 720;
+    outputFbo = &pingPongFbos[0];
     
     // Initialize global parameters
     globalParams["pixelate"] = 1.0;
@@ -12,8 +16,8 @@ FXLayer::FXLayer() {
 
 FXLayer::~FXLayer() {
     // Clean up effects
-    for (auto& effect : effects) {
-        delete effect.second;
+    for (auto effect : effects) {
+        delete effect;
     }
     effects.clear();
 }
@@ -22,18 +26,14 @@ void FXLayer::setup(int width, int height) {
     this->width = width;
     this->height = height;
     
-    // Allocate FBOs
-    outputFbo.allocate(width, height, GL_RGBA);
-    tempFbo.allocate(width, height, GL_RGBA);
-    
-    // Clear FBOs
-    outputFbo.begin();
-    ofClear(0, 0, 0, 0);
-    outputFbo.end();
-    
-    tempFbo.begin();
-    ofClear(0, 0, 0, 0);
-    tempFbo.end();
+    // Allocate and clear the ping-pong FBOs
+    for (int i = 0; i < 2; i++) {
+        pingPongFbos[i].allocate(width, height, GL_RGBA);
+        pingPongFbos[i].begin();
+        ofClear(0, 0, 0, 0);
+        pingPongFbos[i].end();
+    }
+    outputFbo = &pingPongFbos[0];
     
     // Initialize default effects
     initializeDefaultEffects();
@@ -43,90 +43,165 @@ void FXLayer::initializeDefaultEffects() {
     // Add pixelate effect
     PixelateEffect* pixelate = new PixelateEffect();
     pixelate->setup(width, height);
-    effects["pixelate"] = pixelate;
+    addEffect(pixelate);
+    
+    // The rest are available but start disabled
+    GlitchEffect* glitch = new GlitchEffect();
+    glitch->setup(width, height);
+    glitch->setEnabled(false);
+    addEffect(glitch);
+    
+    WaveEffect* wave = new WaveEffect();
+    wave->setup(width, height);
+    wave->setEnabled(false);
+    addEffect(wave);
+    
+    FeedbackEffect* feedback = new FeedbackEffect();
+    feedback->setup(width, height);
+    feedback->setEnabled(false);
+    addEffect(feedback);
 }
 
-void FXLayer::update(float phase, float* audioData, int numBands) {
+void FXLayer::update(const AudioFrame& audio) {
     // Update all effects
-    for (auto& effect : effects) {
-        if (effect.second->isEnabled()) {
-            effect.second->update(phase, audioData, numBands, globalParams);
+    for (auto effect : effects) {
+        if (effect->isEnabled()) {
+            effect->update(audio, globalParams);
         }
     }
 }
 
 void FXLayer::process(ofFbo& inputFbo) {
-    // Copy input to output FBO
-    outputFbo.begin();
-    ofClear(0, 0, 0, 0);
-    inputFbo.draw(0, 0);
-    outputFbo.end();
+    // With nothing to do the input is the output; no copy
+    ofFbo* source = &inputFbo;
+    int target = 0;
     
-    // Process each effect in sequence
-    for (auto& effect : effects) {
-        if (effect.second->isEnabled() && effect.second->getIntensity() > 0.0) {
-            // Copy current output to temp buffer
-            tempFbo.begin();
-            ofClear(0, 0, 0, 0);
-            outputFbo.draw(0, 0);
-            tempFbo.end();
-            
-            // Apply effect to temp and store in output
-            outputFbo.begin();
-            ofClear(0, 0, 0, 0);
-            effect.second->apply(tempFbo);
-            outputFbo.end();
+    // Each pass renders its source once into the other target
+    int count = (int)effects.size();
+    int i = 0;
+    while (i < count) {
+        Effect* effect = effects[i];
+        if (!effect->isEnabled() || effect->getIntensity() <= 0.0) {
+            i++;
+            continue;
+        }
+        
+        // Collect the run of active fusable effects starting here.
+        // Disabled effects inside the run are skipped, not breaking it
+        fusedRun.clear();
+        int next = i;
+        while (next < count) {
+            Effect* candidate = effects[next];
+            if (candidate->isEnabled() && candidate->getIntensity() > 0.0) {
+                if (!candidate->isFusable()) break;
+                fusedRun.push_back(candidate);
+            }
+            next++;
+        }
+        
+        // Stateful effects render into their own FBO, needing no target
+        if (fusedRun.size() < 2) {
+            ofFbo* ownFbo = effect->applyToOwnFbo(*source);
+            if (ownFbo != nullptr) {
+                source = ownFbo;
+                i++;
+                continue;
+            }
+        }
+        
+        ofFbo& targetFbo = pingPongFbos[target];
+        targetFbo.begin();
+        ofClear(0, 0, 0, 0);
+        
+        if (fusedRun.size() >= 2 && fusion.begin(fusedRun)) {
+            // One pass for the whole run
+            ofSetColor(255);
+            source->draw(0, 0);
+            fusion.end();
+            i = next;
+        } else {
+            // Single effect, or the run could not be fused
+            effect->apply(*source);
+            i++;
         }
+        
+        targetFbo.end();
+        
+        source = &targetFbo;
+        target = 1 - target;
     }
+    
+    outputFbo = source;
 }
 
 void FXLayer::addEffect(Effect* effect) {
     if (effect == nullptr) return;
     
-    // Check if effect already exists
-    if (effects.find(effect->getName()) != effects.end()) {
-        // Delete old effect
-        delete effects[effect->getName()];
+    // Replace an existing effect of the same name in place
+    int index = getEffectIndex(effect->getName());
+    if (index >= 0) {
+        delete effects[index];
+        effects[index] = effect;
+        return;
     }
     
-    // Add new effect
-    effects[effect->getName()] = effect;
+    // Add new effect at the end of the chain
+    effects.push_back(effect);
 }
 
 void FXLayer::removeEffect(string name) {
-    auto it = effects.find(name);
-    if (it != effects.end()) {
-        delete it->second;
-        effects.erase(it);
+    int index = getEffectIndex(name);
+    if (index >= 0) {
+        delete effects[index];
+        effects.erase(effects.begin() + index);
     }
 }
 
 Effect* FXLayer::getEffect(string name) {
-    auto it = effects.find(name);
-    if (it != effects.end()) {
-        return it->second;
+    int index = getEffectIndex(name);
+    if (index >= 0) {
+        return effects[index];
     }
     return nullptr;
 }
 
 bool FXLayer::hasEffect(string name) {
-    return effects.find(name) != effects.end();
+    return getEffectIndex(name) >= 0;
+}
+
+int FXLayer::getEffectIndex(string name) {
+    for (int i = 0; i < (int)effects.size(); i++) {
+        if (effects[i]->getName() == name) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+void FXLayer::moveEffect(string name, int index) {
+    int current = getEffectIndex(name);
+    if (current < 0) return;
+    
+    index = std::max(0, std::min(index, (int)effects.size() - 1));
+    Effect* effect = effects[current];
+    effects.erase(effects.begin() + current);
+    effects.insert(effects.begin() + index, effect);
 }
 
 void FXLayer::enableEffect(string name, bool enabled) {
-    auto it = effects.find(name);
-    if (it != effects.end()) {
-        it->second->setEnabled(enabled);
+    Effect* effect = getEffect(name);
+    if (effect != nullptr) {
+        effect->setEnabled(enabled);
     }
 }
 
-void FXLayer::setEffectParameter(string effectName, string paramName, float value) {
-    auto it = effects.find(effectName);
-    if (it != effects.end()) {
-        it->second->setParameter(paramName, value);
+void FXLayer::setEffectParameter(const string& effectName, const string& paramName, float value) {
+    Effect* effect = getEffect(effectName);
+    if (effect != nullptr) {
+        effect->setParameter(paramName, value);
     }
 }
 
 void FXLayer::setGlobalParam(string name, float value) {
     globalParams[name] = value;
-}
\ No newline at end of file
+}
@@ -4,6 +4,7 @@
 #include "ofMain.h"
 #include "Effect.h"
 #include "PixelateEffect.h"
+#include "../Utils/ShaderFusion.h"
 
 class FXLayer {
 public:
@@ -11,28 +12,37 @@ public:
     ~FXLayer();
     
     void setup(int width, int height);
-    void update(float phase, float* audioData, int numBands);
+    void update(const AudioFrame& audio);
     
-    // Process an input FBO with all active effects
+    // Run the effect chain over an input FBO. The first pass reads the
+    // input directly and the rest ping-pong between two FBOs. Consecutive
+    // fusable effects share one pass through a generated shader, and
+    // stateful effects such as feedback hand back their own FBO
     void process(ofFbo& inputFbo);
     
-    // Get output FBO
-    ofFbo& getOutputFbo() { return outputFbo; }
+    // Get output FBO: the last pass of the chain, or the input itself when
+    // no effect is active
+    ofFbo& getOutputFbo() { return *outputFbo; }
     
-    // Effect management
+    // Effect management. Effects run in chain order; addEffect appends,
+    // or replaces an effect of the same name in place
     void addEffect(Effect* effect);
     void removeEffect(string name);
     Effect* getEffect(string name);
     bool hasEffect(string name);
     
-    // Get effects map
-    map<string, Effect*>& getEffects() { return effects; }
+    // Effect chain, in processing order
+    const vector<Effect*>& getEffects() { return effects; }
+    
+    // Reorder the chain
+    int getEffectIndex(string name);
+    void moveEffect(string name, int index);
     
     // Enable/disable effect
     void enableEffect(string name, bool enabled);
     
     // Set effect parameter
-    void setEffectParameter(string effectName, string paramName, float value);
+    void setEffectParameter(const string& effectName, const string& paramName, float value);
     
     // Set global parameters that affect all effects
     void setGlobalParam(string name, float value);
@@ -40,16 +50,22 @@ public:
 private:
     int width, height;
     
-    // FBOs for rendering
-    ofFbo outputFbo;
-    ofFbo tempFbo;
+    // Ping-pong targets for the chain
+    ofFbo pingPongFbos[2];
+    
+    // Fused programs for runs of fusable effects
+    ShaderFusion fusion;
+    vector<Effect*> fusedRun;
+    
+    // Result of the last process()
+    ofFbo* outputFbo;
     
-    // Effects
-    map<string, Effect*> effects;
+    // Effects, in processing order
+    vector<Effect*> effects;
     
     // Global parameters
     map<string, float> globalParams;
     
     // Initialize default effects
     void initializeDefaultEffects();
-};
\ No newline at end of file
+};
@@ -12,6 +12,10 @@ SpriteLayer::SpriteLayer() {
     motionAmount = 1.0;
     blendMode = "screen";
     audioReactivity = 0.5;
+    
+    particleMode = false;
+    particleCount = 10000;
+    particlesDirty = true;
 }
 
 SpriteLayer::~SpriteLayer() {
@@ -31,16 +35,31 @@ void SpriteLayer::setup(int width, int height) {
     ofClear(0, 0, 0, 0);
     outputFbo.end();
     
+    // Set up the batch renderer
+    batch.setup();
+    
     // Initialize sprites list
     clearSprites();
 }
 
-void SpriteLayer::update(float deltaTime, float* audioData, int numBands) {
-    // Update each sprite
+void SpriteLayer::update(float deltaTime, const AudioFrame& audio) {
+    // Particles replace the sprite list entirely
+    if (particleMode) {
+        if (particlesDirty) {
+            rebuildParticles();
+        }
+        particles.update(deltaTime, audio);
+        return;
+    }
+    
+    // Per-sprite work first: trails record where sprites were
     for (auto& sprite : sprites) {
-        sprite->update(deltaTime, audioData, numBands);
+        sprite->update(deltaTime, audio);
     }
     
+    // Then move every sprite at once
+    system.update(deltaTime, audio);
+    
     // Maintain sprite density
     maintainDensity();
 }
@@ -64,9 +83,17 @@ void SpriteLayer::draw() {
         ofEnableAlphaBlending();
     }
     
-    // Draw each sprite
-    for (auto& sprite : sprites) {
-        sprite->draw(width, height);
+    if (particleMode) {
+        // Drawn straight from the GPU state
+        particles.draw(width, height);
+    } else {
+        // Gather every sprite and trail point, then draw them in a few
+        // instanced calls
+        batch.begin();
+        for (auto& sprite : sprites) {
+            sprite->addToBatch(batch, width, height);
+        }
+        batch.draw();
     }
     
     // Reset blend mode
@@ -84,6 +111,9 @@ void SpriteLayer::addSprite(Sprite* sprite) {
     // Add to used IDs
     usedIds.insert(sprite->getId());
     
+    // Hand the sprite's state to the system
+    sprite->attach(&system);
+    
     // Set sprite parameters
     sprite->setScale(sprite->getScale() * spriteScale);
     sprite->setMotionSpeed(sprite->getMotionSpeed() * motionAmount);
@@ -157,31 +187,7 @@ void SpriteLayer::setMotionAmount(float amount) {
 void SpriteLayer::maintainDensity() {
     // If we need more sprites, add them
     while (sprites.size() < density) {
-        // In a real implementation, this would add sprites from a library
-        // For now, create a basic sprite
-        float x = ofRandom(0, 1);
-        float y = ofRandom(0, 1);
-        float scale = ofRandom(0.5, 1.5) * spriteScale;
-        float rotation = ofRandom(0, TWO_PI);
-        ofColor color = ofColor(ofRandom(100, 255), ofRandom(100, 255), ofRandom(100, 255));
-        
-        BasicSprite* sprite = new BasicSprite();
-        sprite->setup(x, y, scale, rotation, color);
-        sprite->setMaxTrailLength(maxTrailLength);
-        sprite->setMotionSpeed(ofRandom(0.1, 0.3) * motionAmount);
-        sprite->setAudioReactivity(audioReactivity);
-        
-        // Set random motion behavior
-        float motionType = ofRandom(0, 3);
-        if (motionType < 1) {
-            sprite->setMotionType(MOTION_CIRCULAR);
-        } else if (motionType < 2) {
-            sprite->setMotionType(MOTION_BOUNCE);
-        } else {
-            sprite->setMotionType(MOTION_WAVE);
-        }
-        
-        addSprite(sprite);
+        addSprite(createRandomSprite());
     }
     
     // If we have too many sprites, remove some
@@ -191,6 +197,68 @@ void SpriteLayer::maintainDensity() {
     }
 }
 
+BasicSprite* SpriteLayer::createRandomSprite() {
+    // In a real implementation, this would add sprites from a library
+    // For now, create a basic sprite
+    float x = ofRandom(0, 1);
+    float y = ofRandom(0, 1);
+    float scale = ofRandom(0.5, 1.5) * spriteScale;
+    float rotation = ofRandom(0, TWO_PI);
+    ofColor color = ofColor(ofRandom(100, 255), ofRandom(100, 255), ofRandom(100, 255));
+    
+    BasicSprite* sprite = new BasicSprite();
+    sprite->setup(x, y, scale, rotation, color);
+    sprite->setMaxTrailLength(maxTrailLength);
+    sprite->setMotionSpeed(ofRandom(0.1, 0.3) * motionAmount);
+    sprite->setAudioReactivity(audioReactivity);
+    
+    // Set random motion behavior
+    float motionType = ofRandom(0, 3);
+    if (motionType < 1) {
+        sprite->setMotionType(MOTION_CIRCULAR);
+    } else if (motionType < 2) {
+        sprite->setMotionType(MOTION_BOUNCE);
+    } else {
+        sprite->setMotionType(MOTION_WAVE);
+    }
+    
+    return sprite;
+}
+
+void SpriteLayer::setParticleMode(bool enabled) {
+    if (enabled != particleMode) {
+        particleMode = enabled;
+        particlesDirty = true;
+    }
+}
+
+void SpriteLayer::setParticleCount(int count) {
+    count = max(1, count);
+    if (count != particleCount) {
+        particleCount = count;
+        particlesDirty = true;
+    }
+}
+
+void SpriteLayer::rebuildParticles() {
+    particlesDirty = false;
+    
+    // Same random sprites as the CPU path, without keeping them around
+    vector<SpriteState> states(particleCount);
+    vector<ofFloatColor> colors(particleCount);
+    for (int i = 0; i < particleCount; i++) {
+        BasicSprite* sprite = createRandomSprite();
+        states[i] = sprite->getState();
+        colors[i] = ofFloatColor(sprite->getColor());
+        delete sprite;
+    }
+    
+    if (!particles.setup(states, colors)) {
+        ofLogWarning("SpriteLayer") << "GPU particles unavailable, using sprites";
+        particleMode = false;
+    }
+}
+
 string SpriteLayer::generateSpriteId() {
     // Generate a unique ID
     string id;
@@ -210,6 +278,8 @@ void SpriteLayer::savePreset(ofXml& xml) {
     xml.appendChild("motionAmount").set(ofToString(motionAmount));
     xml.appendChild("blendMode").set(blendMode);
     xml.appendChild("audioReactivity").set(ofToString(audioReactivity));
+    xml.appendChild("particleMode").set(particleMode ? "1" : "0");
+    xml.appendChild("particleCount").set(ofToString(particleCount));
     
     // Save sprites
     ofXml spritesXml;
@@ -275,6 +345,16 @@ void SpriteLayer::loadPreset(ofXml& xml) {
         setAudioReactivity(ofToFloat(xml.getChild("audioReactivity").getValue()));
     }
     
+    auto particleCountNode = xml.find("particleCount");
+    if (particleCountNode.size() > 0) {
+        setParticleCount(ofToInt(xml.getChild("particleCount").getValue()));
+    }
+    
+    auto particleModeNode = xml.find("particleMode");
+    if (particleModeNode.size() > 0) {
+        setParticleMode(xml.getChild("particleMode").getValue() == "1");
+    }
+    
     // Load sprites
     auto spritesNode = xml.find("sprites");
     if (spritesNode.size() > 0) {
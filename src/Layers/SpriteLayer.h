@@ -3,6 +3,7 @@
 
 #include "ofMain.h"
 #include "../Utils/Sprite.h"
+#include "../Utils/GpuParticles.h"
 
 class SpriteLayer {
 public:
@@ -10,7 +11,7 @@ public:
     ~SpriteLayer();
     
     void setup(int width, int height);
-    void update(float deltaTime, float* audioData, int numBands);
+    void update(float deltaTime, const AudioFrame& audio);
     void draw();
     
     // Get output FBO
@@ -43,6 +44,11 @@ public:
     void setBlendMode(string mode) { blendMode = mode; }
     void setAudioReactivity(float reactivity) { audioReactivity = reactivity; }
     
+    // Simulate and draw particleCount basic sprites on the GPU instead of
+    // the sprite list. Particles have no trails
+    void setParticleMode(bool enabled);
+    void setParticleCount(int count);
+    
     // Get parameters
     int getDensity() { return density; }
     int getMaxTrailLength() { return maxTrailLength; }
@@ -50,12 +56,15 @@ public:
     float getMotionAmount() { return motionAmount; }
     string getBlendMode() { return blendMode; }
     float getAudioReactivity() { return audioReactivity; }
+    bool getParticleMode() { return particleMode; }
+    int getParticleCount() { return particleCount; }
     
 private:
     int width, height;
     
-    // Sprites
+    // Sprites, handles into the system that simulates them
     vector<Sprite*> sprites;
+    SpriteSystem system;
     
     // Sprite properties
     int density;
@@ -68,9 +77,24 @@ private:
     // FBO for rendering
     ofFbo outputFbo;
     
+    // Instanced renderer for all sprites and trails
+    SpriteBatch batch;
+    
+    // GPU particles, rebuilt when the mode or count changes
+    GpuParticles particles;
+    bool particleMode;
+    int particleCount;
+    bool particlesDirty;
+    
     // Maintain proper sprite density
     void maintainDensity();
     
+    // Basic sprite with random placement, colour and motion
+    BasicSprite* createRandomSprite();
+    
+    // Fill the particles from fresh random sprites
+    void rebuildParticles();
+    
     // Currently available sprite IDs to avoid duplicates
     std::set<string> usedIds;
     
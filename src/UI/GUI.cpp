@@ -24,6 +24,7 @@ void GUI::setup(ofApp* app) {
     backgroundParams.feedbackAmount = bg.getFeedbackAmount();
     backgroundParams.feedbackZoom = bg.getFeedbackZoom();
     backgroundParams.feedbackRotate = bg.getFeedbackRotate();
+    backgroundParams.feedbackLatency = bg.getFeedbackLatency();
     backgroundParams.colorShift = bg.getColorShift();
     backgroundParams.patternType = (int)bg.getPatternType();
     backgroundParams.patternSpeed = bg.getPatternSpeed();
@@ -40,30 +41,20 @@ void GUI::setup(ofApp* app) {
     spriteParams.motionAmount = app->spriteLayer.getMotionAmount();
     spriteParams.blendMode = app->spriteLayer.getBlendMode();
     spriteParams.audioReactivity = app->spriteLayer.getAudioReactivity();
+    spriteParams.particleMode = app->spriteLayer.getParticleMode();
+    spriteParams.particleCount = app->spriteLayer.getParticleCount();
     
     // FX params (initialize with existing effects)
-    for (auto& effect : app->fxLayer.getEffects()) {
-        string name = effect.first;
-        fxParams.effectsEnabled[name] = effect.second->isEnabled();
-        fxParams.effectsIntensity[name] = effect.second->getIntensity();
+    for (auto effect : app->fxLayer.getEffects()) {
+        string name = effect->getName();
+        fxParams.effectsEnabled[name] = effect->isEnabled();
+        fxParams.effectsIntensity[name] = effect->getIntensity();
         
         // Get effect parameters
         map<string, float> params;
-        // This is a simplified approach - in a real app, you would iterate through 
-        // all parameters or have a more structured way to access them
-        if (name == "pixelate") {
-            params["sizeX"] = effect.second->getParameter("sizeX");
-            params["sizeY"] = effect.second->getParameter("sizeY");
-            params["dynamicSize"] = effect.second->getParameter("dynamicSize");
-            params["threshold"] = effect.second->getParameter("threshold");
-        } else if (name == "feedback") {
-            params["amount"] = effect.second->getParameter("amount");
-            params["zoom"] = effect.second->getParameter("zoom");
-            params["rotate"] = effect.second->getParameter("rotate");
-            params["offsetX"] = effect.second->getParameter("offsetX");
-            params["offsetY"] = effect.second->getParameter("offsetY");
-            params["hueShift"] = effect.second->getParameter("hueShift");
-            params["fade"] = effect.second->getParameter("fade");
+        for (int i = 0; i < effect->getNumParameters(); i++) {
+            const string& paramName = effect->getParameterName(i);
+            params[paramName] = effect->getParameter(paramName);
         }
         
         fxParams.effectParams[name] = params;
@@ -72,15 +63,10 @@ void GUI::setup(ofApp* app) {
     // Camera params
     cameraParams.active = app->cameraLayer.isActive();
     cameraParams.feedbackEnabled = app->cameraLayer.isFeedbackEnabled();
-    cameraParams.x = app->cameraLayer.getX();
-    cameraParams.y = app->cameraLayer.getY();
-    cameraParams.scale = app->cameraLayer.getScale();
-    cameraParams.rotation = app->cameraLayer.getRotation();
-    cameraParams.opacity = app->cameraLayer.getOpacity();
-    cameraParams.mirror = app->cameraLayer.getMirror();
-    cameraParams.chromaKeyEnabled = false; // Initialize
-    cameraParams.chromaColor = ofColor(0, 255, 0); // Initialize
-    cameraParams.chromaTolerance = 0.4f; // Initialize
+    cameraParams.selectedCamera = 0;
+    cameraParams.newDevice = 0;
+    cameraParams.newResolution = 1;
+    cameraParams.newFrameRate = 30;
     
     // Audio params
     audioParams.gain = 1.0f;
@@ -227,6 +213,10 @@ void GUI::drawBackgroundTab() {
             app->backgroundLayer.setFeedbackRotate(backgroundParams.feedbackRotate);
         }
         
+        if (ImGui::SliderInt("Camera Delay (frames)", &backgroundParams.feedbackLatency, 0, 30)) {
+            app->backgroundLayer.setFeedbackLatency(backgroundParams.feedbackLatency);
+        }
+        
         if (ImGui::SliderFloat("Color Shift", &backgroundParams.colorShift, 0.0f, 1.0f)) {
             app->backgroundLayer.setColorShift(backgroundParams.colorShift);
         }
@@ -269,6 +259,20 @@ void GUI::drawSpriteTab() {
             app->spriteLayer.setAudioReactivity(spriteParams.audioReactivity);
         }
         
+        // GPU particles replace the sprites above, without trails. The layer
+        // falls back to sprites if the particle shaders fail to load
+        ImGui::Separator();
+        spriteParams.particleMode = app->spriteLayer.getParticleMode();
+        if (ImGui::Checkbox("GPU Particles", &spriteParams.particleMode)) {
+            app->spriteLayer.setParticleMode(spriteParams.particleMode);
+        }
+        
+        if (spriteParams.particleMode) {
+            if (ImGui::SliderInt("Particle Count", &spriteParams.particleCount, 1000, 100000)) {
+                app->spriteLayer.setParticleCount(spriteParams.particleCount);
+            }
+        }
+        
         // Sprite library (placeholder for now)
         ImGui::Separator();
         ImGui::Text("Sprite Library");
@@ -282,10 +286,12 @@ void GUI::drawSpriteTab() {
 
 void GUI::drawFXTab() {
     if (ImGui::Begin("FX Layer", nullptr, ImGuiWindowFlags_AlwaysAutoResize)) {
-        // Loop through available effects
-        for (auto& effectPair : app->fxLayer.getEffects()) {
-            string name = effectPair.first;
-            Effect* effect = effectPair.second;
+        // Loop through the effect chain in processing order. Reordering
+        // takes effect next frame, so iterate over a copy
+        vector<Effect*> chain = app->fxLayer.getEffects();
+        for (int index = 0; index < (int)chain.size(); index++) {
+            Effect* effect = chain[index];
+            string name = effect->getName();
             
             ImGui::Separator();
             
@@ -296,6 +302,16 @@ void GUI::drawFXTab() {
                 app->fxLayer.enableEffect(name, enabled);
             }
             
+            // Chain order
+            ImGui::SameLine();
+            if (ImGui::SmallButton(("Up##" + name).c_str()) && index > 0) {
+                app->fxLayer.moveEffect(name, index - 1);
+            }
+            ImGui::SameLine();
+            if (ImGui::SmallButton(("Down##" + name).c_str()) && index < (int)chain.size() - 1) {
+                app->fxLayer.moveEffect(name, index + 1);
+            }
+            
             // Only show parameters if effect is enabled
             if (enabled) {
                 // Effect intensity
@@ -326,6 +342,61 @@ void GUI::drawFXTab() {
                         params["dynamicSize"] = dynamicSize ? 1.0f : 0.0f;
                         app->fxLayer.setEffectParameter(name, "dynamicSize", params["dynamicSize"]);
                     }
+                } else if (name == "glitch") {
+                    auto& params = fxParams.effectParams[name];
+                    
+                    if (ImGui::SliderFloat("Amount##glitch", &params["amount"], 0.0f, 1.0f)) {
+                        app->fxLayer.setEffectParameter(name, "amount", params["amount"]);
+                    }
+                    
+                    if (ImGui::SliderFloat("Noise##glitch", &params["noiseAmount"], 0.0f, 1.0f)) {
+                        app->fxLayer.setEffectParameter(name, "noiseAmount", params["noiseAmount"]);
+                    }
+                    
+                    if (ImGui::SliderFloat("Audio Reactivity##glitch", &params["audioReactivity"], 0.0f, 1.0f)) {
+                        app->fxLayer.setEffectParameter(name, "audioReactivity", params["audioReactivity"]);
+                    }
+                    
+                    bool colorShift = params["colorShift"] > 0.5f;
+                    if (ImGui::Checkbox("RGB Split", &colorShift)) {
+                        params["colorShift"] = colorShift ? 1.0f : 0.0f;
+                        app->fxLayer.setEffectParameter(name, "colorShift", params["colorShift"]);
+                    }
+                    
+                    bool scanlines = params["scanlines"] > 0.5f;
+                    if (ImGui::Checkbox("Scanlines", &scanlines)) {
+                        params["scanlines"] = scanlines ? 1.0f : 0.0f;
+                        app->fxLayer.setEffectParameter(name, "scanlines", params["scanlines"]);
+                    }
+                } else if (name == "wave") {
+                    auto& params = fxParams.effectParams[name];
+                    
+                    if (ImGui::SliderFloat("Amplitude", &params["amplitude"], 0.0f, 10.0f)) {
+                        app->fxLayer.setEffectParameter(name, "amplitude", params["amplitude"]);
+                    }
+                    
+                    if (ImGui::SliderFloat("Frequency", &params["frequency"], 0.1f, 10.0f)) {
+                        app->fxLayer.setEffectParameter(name, "frequency", params["frequency"]);
+                    }
+                    
+                    if (ImGui::SliderFloat("Speed", &params["speed"], 0.0f, 10.0f)) {
+                        app->fxLayer.setEffectParameter(name, "speed", params["speed"]);
+                    }
+                    
+                    if (ImGui::SliderFloat("Noise##wave", &params["noiseAmount"], 0.0f, 1.0f)) {
+                        app->fxLayer.setEffectParameter(name, "noiseAmount", params["noiseAmount"]);
+                    }
+                    
+                    if (ImGui::SliderFloat("Audio Reactivity##wave", &params["audioReactivity"], 0.0f, 1.0f)) {
+                        app->fxLayer.setEffectParameter(name, "audioReactivity", params["audioReactivity"]);
+                    }
+                    
+                    static const char* directionNames[] = { "Horizontal", "Vertical", "Both" };
+                    int direction = (int)params["direction"];
+                    if (ImGui::Combo("Direction", &direction, directionNames, 3)) {
+                        params["direction"] = direction;
+                        app->fxLayer.setEffectParameter(name, "direction", params["direction"]);
+                    }
                 } else if (name == "feedback") {
                     auto& params = fxParams.effectParams[name];
                     
@@ -373,38 +444,138 @@ void GUI::drawCameraTab() {
         }
         
         if (active) {
-            // Camera device selection
-            if (ImGui::Button("Setup Camera")) {
-                app->cameraLayer.setupCamera(0); // Use device 0 for now
-            }
+            // New camera settings
+            static const char* resolutionNames[] = { "320x240", "640x480", "1280x720", "1920x1080" };
+            static const int resolutionSizes[][2] = { {320, 240}, {640, 480}, {1280, 720}, {1920, 1080} };
             
-            ImGui::Separator();
+            ImGui::SliderInt("Device", &cameraParams.newDevice, 0, 9);
+            ImGui::Combo("Resolution", &cameraParams.newResolution, resolutionNames, 4);
+            ImGui::SliderInt("Frame Rate", &cameraParams.newFrameRate, 5, 60);
             
-            // Position and transform
-            if (ImGui::SliderFloat("X Position", &cameraParams.x, 0.0f, 1.0f)) {
-                app->cameraLayer.setX(cameraParams.x);
-            }
+            int newWidth = resolutionSizes[cameraParams.newResolution][0];
+            int newHeight = resolutionSizes[cameraParams.newResolution][1];
             
-            if (ImGui::SliderFloat("Y Position", &cameraParams.y, 0.0f, 1.0f)) {
-                app->cameraLayer.setY(cameraParams.y);
+            if (ImGui::Button("Add Camera")) {
+                int index = app->cameraLayer.addCamera(cameraParams.newDevice, newWidth, newHeight, cameraParams.newFrameRate);
+                if (index >= 0) {
+                    cameraParams.selectedCamera = index;
+                }
             }
             
-            if (ImGui::SliderFloat("Scale", &cameraParams.scale, 0.1f, 3.0f)) {
-                app->cameraLayer.setScale(cameraParams.scale);
+            ImGui::SameLine();
+            
+            // Synthetic source, for running without camera hardware
+            if (ImGui::Button("Add Pattern Source")) {
+                int index = app->cameraLayer.addPatternCamera(newWidth, newHeight, cameraParams.newFrameRate);
+                if (index >= 0) {
+                    cameraParams.selectedCamera = index;
+                }
             }
             
-            if (ImGui::SliderFloat("Rotation", &cameraParams.rotation, -PI, PI)) {
-                app->cameraLayer.setRotation(cameraParams.rotation);
+            ImGui::Separator();
+            
+            // Camera list
+            int numCameras = app->cameraLayer.getNumCameras();
+            for (int i = 0; i < numCameras; i++) {
+                CameraPipeline* camera = app->cameraLayer.getCamera(i);
+                string label = ofToString(i + 1) + ": " + camera->getName() + " " +
+                    ofToString(camera->getRequestedWidth()) + "x" + ofToString(camera->getRequestedHeight()) +
+                    " @ " + ofToString(camera->getFrameRate());
+                ImGui::PushID(i);
+                if (ImGui::Selectable(label.c_str(), cameraParams.selectedCamera == i)) {
+                    cameraParams.selectedCamera = i;
+                }
+                ImGui::PopID();
             }
             
-            if (ImGui::SliderFloat("Opacity", &cameraParams.opacity, 0.0f, 1.0f)) {
-                app->cameraLayer.setOpacity(cameraParams.opacity);
+            CameraPipeline* camera = app->cameraLayer.getCamera(cameraParams.selectedCamera);
+            if (camera != nullptr) {
+                if (ImGui::Button("Remove Camera")) {
+                    app->cameraLayer.removeCamera(cameraParams.selectedCamera);
+                    cameraParams.selectedCamera = max(0, cameraParams.selectedCamera - 1);
+                    camera = app->cameraLayer.getCamera(cameraParams.selectedCamera);
+                }
             }
             
-            bool mirror = cameraParams.mirror;
-            if (ImGui::Checkbox("Mirror", &mirror)) {
-                cameraParams.mirror = mirror;
-                app->cameraLayer.setMirror(mirror);
+            if (camera != nullptr) {
+                ImGui::Separator();
+                
+                bool visible = camera->isVisible();
+                if (ImGui::Checkbox("Visible", &visible)) {
+                    camera->setVisible(visible);
+                }
+                
+                // Position and transform
+                float x = camera->getX();
+                if (ImGui::SliderFloat("X Position", &x, 0.0f, 1.0f)) {
+                    camera->setX(x);
+                }
+                
+                float y = camera->getY();
+                if (ImGui::SliderFloat("Y Position", &y, 0.0f, 1.0f)) {
+                    camera->setY(y);
+                }
+                
+                float scale = camera->getScale();
+                if (ImGui::SliderFloat("Scale", &scale, 0.1f, 3.0f)) {
+                    camera->setScale(scale);
+                }
+                
+                float rotation = camera->getRotation();
+                if (ImGui::SliderFloat("Rotation", &rotation, -PI, PI)) {
+                    camera->setRotation(rotation);
+                }
+                
+                float opacity = camera->getOpacity();
+                if (ImGui::SliderFloat("Opacity", &opacity, 0.0f, 1.0f)) {
+                    camera->setOpacity(opacity);
+                }
+                
+                bool mirror = camera->getMirror();
+                if (ImGui::Checkbox("Mirror", &mirror)) {
+                    camera->setMirror(mirror);
+                }
+                
+                bool frameBlending = camera->getFrameBlending();
+                if (ImGui::Checkbox("Blend Camera Frames", &frameBlending)) {
+                    camera->setFrameBlending(frameBlending);
+                }
+                
+                ImGui::Separator();
+                
+                // Chroma key controls
+                bool chromaKeyEnabled = camera->getChromaKey();
+                if (ImGui::Checkbox("Enable Chroma Key", &chromaKeyEnabled)) {
+                    camera->setChromaKey(chromaKeyEnabled);
+                }
+                
+                if (chromaKeyEnabled) {
+                    ofColor chromaColor = camera->getChromaColor();
+                    float color[3] = {
+                        chromaColor.r / 255.0f,
+                        chromaColor.g / 255.0f,
+                        chromaColor.b / 255.0f
+                    };
+                    
+                    if (ImGui::ColorEdit3("Chroma Color", color)) {
+                        camera->setChromaColor(ofColor(color[0] * 255.0f, color[1] * 255.0f, color[2] * 255.0f));
+                    }
+                    
+                    float tolerance = camera->getChromaTolerance();
+                    if (ImGui::SliderFloat("Tolerance", &tolerance, 0.0f, 1.0f)) {
+                        camera->setChromaTolerance(tolerance);
+                    }
+                    
+                    float softness = camera->getChromaSoftness();
+                    if (ImGui::SliderFloat("Softness", &softness, 0.0f, 0.5f)) {
+                        camera->setChromaSoftness(softness);
+                    }
+                    
+                    float spill = camera->getChromaSpill();
+                    if (ImGui::SliderFloat("Spill", &spill, 0.0f, 1.0f)) {
+                        camera->setChromaSpill(spill);
+                    }
+                }
             }
             
             ImGui::Separator();
@@ -416,31 +587,10 @@ void GUI::drawCameraTab() {
                 app->cameraLayer.setFeedbackEnabled(feedbackEnabled);
             }
             
-            ImGui::Separator();
-            
-            // Chroma key controls
-            bool chromaKeyEnabled = cameraParams.chromaKeyEnabled;
-            if (ImGui::Checkbox("Enable Chroma Key", &chromaKeyEnabled)) {
-                cameraParams.chromaKeyEnabled = chromaKeyEnabled;
-                app->cameraLayer.setChromaKey(chromaKeyEnabled);
-            }
-            
-            if (chromaKeyEnabled) {
-                float color[3] = {
-                    cameraParams.chromaColor.r / 255.0f,
-                    cameraParams.chromaColor.g / 255.0f,
-                    cameraParams.chromaColor.b / 255.0f
-                };
-                
-                if (ImGui::ColorEdit3("Chroma Color", color)) {
-                    cameraParams.chromaColor.r = color[0] * 255.0f;
-                    cameraParams.chromaColor.g = color[1] * 255.0f;
-                    cameraParams.chromaColor.b = color[2] * 255.0f;
-                    app->cameraLayer.setChromaColor(cameraParams.chromaColor);
-                }
-                
-                if (ImGui::SliderFloat("Tolerance", &cameraParams.chromaTolerance, 0.0f, 1.0f)) {
-                    app->cameraLayer.setChromaTolerance(cameraParams.chromaTolerance);
+            if (feedbackEnabled && numCameras > 1) {
+                int feedbackCamera = app->cameraLayer.getFeedbackCamera() + 1;
+                if (ImGui::SliderInt("Feedback Camera", &feedbackCamera, 1, numCameras)) {
+                    app->cameraLayer.setFeedbackCamera(feedbackCamera - 1);
                 }
             }
         }
@@ -466,6 +616,28 @@ void GUI::drawTempoTab() {
             app->audioAnalyzer.setupLineInput(0);
         }
         
+        // Track replay (drop a WAV file on the window to load one)
+        if (app->audioAnalyzer.isTrackLoading()) {
+            ImGui::TextDisabled("Analyzing track...");
+        }
+        
+        if (app->audioAnalyzer.isTrackLoaded()) {
+            if (app->audioAnalyzer.isTrackPlaying()) {
+                if (ImGui::Button("Pause Track")) {
+                    app->audioAnalyzer.pauseTrack();
+                }
+            } else if (ImGui::Button("Play Track")) {
+                app->audioAnalyzer.playTrack();
+            }
+            
+            float position = app->audioAnalyzer.getTrackPosition();
+            if (ImGui::SliderFloat("Position", &position, 0.0f, app->audioAnalyzer.getTrackDuration(), "%.1f s")) {
+                app->audioAnalyzer.seekTrack(position);
+            }
+        } else {
+            ImGui::TextDisabled("Drop a WAV file to replay a track");
+        }
+        
         ImGui::Separator();
         
         // Clock source
@@ -491,7 +663,7 @@ void GUI::drawTempoTab() {
             }
         } else {
             // Display detected BPM for other clock sources
-            ImGui::Text("Detected BPM: %.1f", app->audioAnalyzer.getBPM());
+            ImGui::Text("Detected BPM: %.1f", app->audioAnalyzer.getFrame().bpm);
         }
         
         ImGui::Separator();
@@ -500,14 +672,25 @@ void GUI::drawTempoTab() {
         ImGui::Text("Audio Input");
         
         // Draw a simple visualizer
-        float* spectrum = app->audioAnalyzer.getSpectrum();
-        int numBands = app->audioAnalyzer.getNumBands();
+        const AudioFrame& audio = app->audioAnalyzer.getFrame();
         
-        if (spectrum && numBands > 0) {
-            ImGui::PlotHistogram("##spectrum", spectrum, numBands, 0, nullptr, 0.0f, 1.0f, ImVec2(300, 80));
+        if (!audio.spectrum.empty()) {
+            ImGui::PlotHistogram("##spectrum", audio.spectrum.data(), audio.spectrum.size(), 0, nullptr, 0.0f, 1.0f, ImVec2(300, 80));
         } else {
             ImGui::Text("No audio input detected");
         }
+        
+        // Reduced bands
+        const char* bandScales[] = { "Log", "Mel" };
+        int scaleIndex = app->audioAnalyzer.getBandScale();
+        int numScaleBands = app->audioAnalyzer.getNumScaleBands();
+        bool scaleChanged = ImGui::Combo("Band Scale", &scaleIndex, bandScales, 2);
+        scaleChanged |= ImGui::SliderInt("Bands", &numScaleBands, 4, 64);
+        if (scaleChanged) {
+            app->audioAnalyzer.setBandScale((BandScale)scaleIndex, numScaleBands);
+        }
+        
+        ImGui::PlotHistogram("##bands", audio.scaleBands, audio.numScaleBands, 0, nullptr, 0.0f, 1.0f, ImVec2(300, 60));
     }
     ImGui::End();
 }
@@ -517,15 +700,17 @@ void GUI::drawAudioPanel() {
     ImGui::SetNextWindowSize(ImVec2(200, 60), ImGuiCond_FirstUseEver);
     
     if (ImGui::Begin("Audio Monitor", &showAudioPanel, ImGuiWindowFlags_NoResize | ImGuiWindowFlags_NoCollapse)) {
+        const AudioFrame& audio = app->audioAnalyzer.getFrame();
+        
         // Display BPM
-        ImGui::Text("BPM: %.1f", app->audioAnalyzer.getBPM());
+        ImGui::Text("BPM: %.1f", audio.bpm);
         
         // Confidence meter
-        float confidence = 0.7f; // In a real implementation, get from audio analyzer
+        float confidence = audio.beatConfidence;
         ImGui::ProgressBar(confidence, ImVec2(100, 10));
         
         // Beat indicator
-        bool onBeat = app->audioAnalyzer.isOnBeat();
+        bool onBeat = audio.onBeat;
         ImGui::SameLine();
         if (onBeat) {
             ImGui::TextColored(ImVec4(1.0f, 0.5f, 0.0f, 1.0f), "●");
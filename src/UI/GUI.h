@@ -55,6 +55,7 @@ private:
         float feedbackAmount;
         float feedbackZoom;
         float feedbackRotate;
+        int feedbackLatency;
         float colorShift;
         int patternType;
         float patternSpeed;
@@ -72,6 +73,8 @@ private:
         float motionAmount;
         string blendMode;
         float audioReactivity;
+        bool particleMode;
+        int particleCount;
     } spriteParams;
     
     struct {
@@ -83,15 +86,14 @@ private:
     struct {
         bool active;
         bool feedbackEnabled;
-        float x;
-        float y;
-        float scale;
-        float rotation;
-        float opacity;
-        bool mirror;
-        bool chromaKeyEnabled;
-        ofColor chromaColor;
-        float chromaTolerance;
+        
+        // Camera being edited; per-camera settings are read from it directly
+        int selectedCamera;
+        
+        // Source for the next added camera
+        int newDevice;
+        int newResolution;
+        int newFrameRate;
     } cameraParams;
     
     struct {
@@ -0,0 +1,62 @@
+// File: src/Utils/AllocationCounter.cpp
+#include "AllocationCounter.h"
+#include <cstdlib>
+#include <new>
+
+#ifndef NDEBUG
+
+// Trivially-initialized, so it is safe to touch from operator new at any time
+static thread_local uint64_t threadAllocations = 0;
+
+static void* countedAllocate(size_t size) {
+    threadAllocations++;
+    void* ptr = malloc(size > 0 ? size : 1);
+    if (ptr == nullptr) {
+        throw std::bad_alloc();
+    }
+    return ptr;
+}
+
+void* operator new(size_t size) {
+    return countedAllocate(size);
+}
+
+void* operator new[](size_t size) {
+    return countedAllocate(size);
+}
+
+void operator delete(void* ptr) noexcept {
+    free(ptr);
+}
+
+void operator delete[](void* ptr) noexcept {
+    free(ptr);
+}
+
+void operator delete(void* ptr, size_t) noexcept {
+    free(ptr);
+}
+
+void operator delete[](void* ptr, size_t) noexcept {
+    free(ptr);
+}
+
+uint64_t AllocationCounter::getThreadAllocations() {
+    return threadAllocations;
+}
+
+bool AllocationCounter::isEnabled() {
+    return true;
+}
+
+#else
+
+uint64_t AllocationCounter::getThreadAllocations() {
+    return 0;
+}
+
+bool AllocationCounter::isEnabled() {
+    return false;
+}
+
+#endif
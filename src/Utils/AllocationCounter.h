@@ -0,0 +1,16 @@
+// File: src/Utils/AllocationCounter.h
+#pragma once
+
+#include "ofMain.h"
+
+// Counts heap allocations per thread in debug builds by replacing the
+// global operator new. Release builds (NDEBUG) compile the counter out
+// and always report zero.
+class AllocationCounter {
+public:
+    // Allocations made so far by the calling thread
+    static uint64_t getThreadAllocations();
+
+    // Whether allocations are being counted in this build
+    static bool isEnabled();
+};
@@ -1,120 +1,322 @@
 // File: src/Utils/AudioAnalyzer.cpp
 #include "AudioAnalyzer.h"
+#include "OfflineAnalyzer.h"
+#include "AllocationCounter.h"
+#include <sys/stat.h>
+
+// Modification time of a file in seconds, or 0 if it cannot be read
+static int64_t getModifiedTime(const string& path) {
+    struct stat info;
+    if (stat(ofToDataPath(path).c_str(), &info) != 0) {
+        return 0;
+    }
+    return (int64_t)info.st_mtime;
+}
 
 //--------------------------------------------------------------
 // BeatDetector Implementation
 //--------------------------------------------------------------
 
 BeatDetector::BeatDetector() {
+    hopRate = 44100.0 / 512.0;
+    
     bpm = 120;
     confidence = 0;
     phase = 0;
-    onBeat = false;
+    beatCount = 0;
+    onsetCount = 0;
     
-    // Beat detection parameters
-    beatThreshold = 0.15;
-    minBeatInterval = 300; // Minimum ms between beats (200 BPM)
-    lastBeatTime = 0;
+    for (int i = 0; i < fluxBandCount; i++) {
+        fluxBandPeaks[i] = 0;
+    }
     
-    maxBeatTimes = 10;
+    // Onset picking parameters
+    hopIndex = 0;
+    lastOnsetHop = 0;
+    onsetThresholdRatio = 1.4;
+    onsetThresholdDelta = 0.05;
+    onsetThresholdWindow = 16;
+    minOnsetHops = 4;
+    
+    // Tempo estimation parameters
+    minLag = 1;
+    maxLag = 2;
+    tempoInterval = 43;
+    estimatedPeriod = 0;
+    pendingPeriod = 0;
+    pendingCount = 0;
+    
+    // PLL parameters
+    beatPhase = 0;
+    periodHops = 0;
+    phaseGain = 0.2;
+    periodGain = 0.02;
+    lockWindow = 0.25;
 }
 
 BeatDetector::~BeatDetector() {
-    // Clean up resources
+    stop();
 }
 
-void BeatDetector::setup(int bufferSize) {
-    // Initialize energy history buffer (about 1 second worth)
-    int historySize = 43; // About 1 second of history at 44.1kHz
-    energyHistory.resize(historySize, 0);
-    
-    beatHistory.clear();
-    beatTimes.clear();
+void BeatDetector::setup(int hopSize, int sampleRate, int numBins) {
+    hopRate = (float)sampleRate / hopSize;
+    
+    // Split the spectrum into low/mid/high flux bands (below 150 Hz, below 2 kHz, rest)
+    float binHz = sampleRate / (2.0f * numBins);
+    fluxBandEdges[0] = 1; // skip DC
+    fluxBandEdges[1] = ofClamp((int)(150.0f / binHz), 2, numBins);
+    fluxBandEdges[2] = ofClamp((int)(2000.0f / binHz), fluxBandEdges[1] + 1, numBins);
+    fluxBandEdges[3] = numBins;
+    previousSpectrum.assign(numBins, 0);
+    
+    // Beat lags between 200 and 60 BPM; comb harmonics reach 4x the longest lag
+    minLag = std::max(1, (int)floor(60.0f * hopRate / 200.0f));
+    maxLag = (int)ceil(60.0f * hopRate / 60.0f);
+    
+    // About 6 seconds of onset history, re-estimated twice a second
+    odfHistory.setup(std::max(maxLag * 4 + 1, (int)(6.0f * hopRate)));
+    odfLinear.assign(odfHistory.capacity(), 0);
+    autocorrelation.assign(maxLag * 4 + 1, 0);
+    tempoInterval = std::max(1, (int)(hopRate / 2));
+    
+    // Start at 120 BPM until the estimator locks
+    estimatedPeriod = 60.0f * hopRate / 120.0f;
+    periodHops = estimatedPeriod;
+    beatPhase = 0;
+    hopIndex = 0;
+    lastOnsetHop = 0;
+    
+    fluxRing.setup(1024);
 }
 
-void BeatDetector::update(float* spectrum, int numBands, float* waveform, int bufferSize) {
-    float now = ofGetElapsedTimeMillis();
-    
-    // Calculate bass energy
-    float bassEnergy = 0;
-    int bassBands = std::min(numBands / 4, 4); // Use first few bands for bass
+void BeatDetector::start() {
+    if (!isThreadRunning()) {
+        startThread();
+    }
+}
+
+void BeatDetector::stop() {
+    if (isThreadRunning()) {
+        stopThread();
+        wakeCondition.notify_one();
+        waitForThread(false);
+    }
+}
+
+void BeatDetector::process(const float* magnitudes, int numBins) {
+    float flux = computeFlux(magnitudes, numBins);
     
-    for (int i = 0; i < bassBands; i++) {
-        bassEnergy += spectrum[i];
+    if (isThreadRunning()) {
+        // Hand off to the tracking thread
+        fluxRing.write(&flux, 1);
+        wakeCondition.notify_one();
+    } else {
+        processFlux(flux);
+    }
+}
+
+float BeatDetector::computeFlux(const float* magnitudes, int numBins) {
+    float bandFlux[fluxBandCount];
+    computeBandFlux(magnitudes, numBins, bandFlux);
+    return combineBandFlux(bandFlux);
+}
+
+void BeatDetector::computeBandFlux(const float* magnitudes, int numBins, float* bandFlux) {
+    numBins = std::min(numBins, (int)previousSpectrum.size());
+    
+    for (int band = 0; band < fluxBandCount; band++) {
+        // Half-wave rectified difference of log-compressed magnitudes
+        float sum = 0;
+        for (int i = fluxBandEdges[band]; i < std::min(fluxBandEdges[band + 1], numBins); i++) {
+            float compressed = log1pf(100.0f * magnitudes[i]);
+            float difference = compressed - previousSpectrum[i];
+            sum += difference > 0 ? difference : 0;
+            previousSpectrum[i] = compressed;
+        }
+        bandFlux[band] = sum;
+    }
+}
+
+float BeatDetector::combineBandFlux(const float* bandFlux) {
+    float flux = 0;
+    for (int band = 0; band < fluxBandCount; band++) {
+        // Whiten each band against its slowly decaying peak so a loud band
+        // can't mask onsets in the others
+        fluxBandPeaks[band] = std::max(bandFlux[band], fluxBandPeaks[band] * 0.997f);
+        flux += bandFlux[band] / std::max(fluxBandPeaks[band], 1.0f);
     }
-    bassEnergy /= bassBands;
     
-    // Add to energy history
-    energyHistory.push_back(bassEnergy);
-    if (energyHistory.size() > 43) {
-        energyHistory.erase(energyHistory.begin());
+    return flux / fluxBandCount;
+}
+
+void BeatDetector::threadedFunction() {
+    float flux;
+    
+    while (isThreadRunning()) {
+        // Sleep until the analysis path has produced new hops
+        {
+            std::unique_lock<std::mutex> lock(wakeMutex);
+            wakeCondition.wait_for(lock, std::chrono::milliseconds(10));
+        }
+        
+        while (fluxRing.read(&flux, 1) == 1) {
+            processFlux(flux);
+        }
     }
+}
+
+void BeatDetector::processFlux(float flux) {
+    if (periodHops <= 0) return;
+    
+    hopIndex++;
+    odfHistory.push(flux);
     
-    // Calculate average energy
-    float avgEnergy = 0;
-    for (auto e : energyHistory) {
-        avgEnergy += e;
+    // Advance the phase-locked loop by one hop
+    beatPhase += 1.0f / periodHops;
+    if (beatPhase >= 1.0f) {
+        beatPhase -= 1.0f;
+        beatCount++;
     }
-    avgEnergy /= energyHistory.size();
     
-    // Check for beat
-    onBeat = false;
-    if (bassEnergy > avgEnergy + beatThreshold && 
-        bassEnergy > 0.1 && 
-        now - lastBeatTime > minBeatInterval) {
-        
-        // Beat detected
-        onBeat = true;
+    // Pick the previous hop as an onset if it is a local peak above an
+    // adaptive threshold (mean of the recent detection function)
+    size_t count = odfHistory.size();
+    if (count > (size_t)onsetThresholdWindow) {
+        float mean = 0;
+        for (size_t i = count - onsetThresholdWindow; i < count; i++) {
+            mean += odfHistory[i];
+        }
+        mean /= onsetThresholdWindow;
         
-        // Calculate time since last beat
-        float beatInterval = now - lastBeatTime;
-        lastBeatTime = now;
+        float threshold = mean * onsetThresholdRatio + onsetThresholdDelta;
+        float candidate = odfHistory[count - 2];
+        bool isPeak = candidate > odfHistory[count - 3] && candidate >= flux;
         
-        // Only keep reasonable intervals (300-2000ms = 30-200 BPM)
-        if (beatInterval >= 300 && beatInterval <= 2000) {
-            beatHistory.push_back(beatInterval);
+        if (isPeak && candidate > threshold && hopIndex - lastOnsetHop > (uint64_t)minOnsetHops) {
+            lastOnsetHop = hopIndex - 1;
+            onsetCount++;
             
-            // Keep only recent beats
-            if (beatHistory.size() > 8) {
-                beatHistory.erase(beatHistory.begin());
-            }
-            
-            // Store beat time for BPM calculation
-            beatTimes.push_back(now);
-            if (beatTimes.size() > maxBeatTimes) {
-                beatTimes.erase(beatTimes.begin());
-            }
+            // Phase error of the onset against the nearest predicted beat
+            float onsetPhase = beatPhase - 1.0f / periodHops;
+            float error = onsetPhase - roundf(onsetPhase);
             
-            // Calculate BPM if we have enough beats
-            if (beatTimes.size() >= 4) {
-                vector<float> intervals;
-                for (int i = 1; i < beatTimes.size(); i++) {
-                    intervals.push_back(beatTimes[i] - beatTimes[i-1]);
-                }
+            // Off-beat (syncopated) onsets fall outside the lock window and are ignored
+            if (fabsf(error) < lockWindow) {
+                float weight = ofClamp(candidate / threshold - 1.0f, 0.0f, 1.0f);
                 
-                // Average interval
-                float avgInterval = 0;
-                for (auto i : intervals) {
-                    avgInterval += i;
-                }
-                avgInterval /= intervals.size();
+                beatPhase -= phaseGain * weight * error;
+                beatPhase = std::max(0.0f, beatPhase);
                 
-                // Convert to BPM
-                float newBpm = 60000 / avgInterval;
-                
-                // Only update BPM if it's in a reasonable range (40-200 BPM)
-                if (newBpm >= 40 && newBpm <= 200) {
-                    // Smooth BPM changes
-                    bpm = bpm * 0.8 + newBpm * 0.2;
-                    confidence = std::min(1.0f, beatTimes.size() / (float)maxBeatTimes);
-                }
+                // Onsets arriving late mean the true period is longer
+                periodHops += periodGain * weight * error * periodHops;
+                periodHops = ofClamp(periodHops, estimatedPeriod * 0.95f, estimatedPeriod * 1.05f);
             }
         }
     }
     
-    // Update phase based on current BPM
-    float beatInterval = 60000 / bpm;
-    phase = fmodf((now - lastBeatTime), beatInterval) / beatInterval;
+    // Periodically re-estimate tempo from the whole history
+    if (hopIndex % tempoInterval == 0 && odfHistory.size() > (size_t)(maxLag * 4)) {
+        estimateTempo();
+    }
+    
+    // Publish results
+    bpm = 60.0f * hopRate / periodHops;
+    phase = beatPhase;
+}
+
+void BeatDetector::estimateTempo() {
+    // Copy the history out of the ring with the mean removed
+    int n = odfHistory.size();
+    float mean = 0;
+    for (int i = 0; i < n; i++) {
+        odfLinear[i] = odfHistory[i];
+        mean += odfLinear[i];
+    }
+    mean /= n;
+    for (int i = 0; i < n; i++) {
+        odfLinear[i] -= mean;
+    }
+    
+    // Unbiased autocorrelation up to 4x the longest beat lag
+    int maxCombLag = std::min(maxLag * 4, n - 1);
+    for (int lag = minLag; lag <= maxCombLag; lag++) {
+        float sum = 0;
+        for (int i = lag; i < n; i++) {
+            sum += odfLinear[i] * odfLinear[i - lag];
+        }
+        autocorrelation[lag] = sum / (n - lag);
+    }
+    
+    // Comb filter: a beat period also explains energy at its multiples.
+    // Weight by a log-Gaussian tempo prior centred on 120 BPM
+    float lag120 = 60.0f * hopRate / 120.0f;
+    float bestScore = -1e30f;
+    float scoreSum = 0;
+    int bestLag = minLag;
+    for (int lag = minLag; lag <= maxLag; lag++) {
+        float octaves = log2f(lag / lag120);
+        float score = combScore(lag, maxCombLag) * expf(-0.5f * octaves * octaves);
+        scoreSum += std::max(score, 0.0f);
+        
+        if (score > bestScore) {
+            bestScore = score;
+            bestLag = lag;
+        }
+    }
+    
+    if (bestScore <= 0) {
+        confidence = 0;
+        return;
+    }
+    
+    // Peak sharpness relative to the mean score
+    float meanScore = scoreSum / (maxLag - minLag + 1);
+    confidence = ofClamp(1.0f - meanScore / bestScore, 0.0f, 1.0f);
+    
+    // Parabolic interpolation of the comb peak for a fractional lag
+    float refinedLag = bestLag;
+    if (bestLag > minLag && bestLag < maxLag) {
+        float left = combScore(bestLag - 1, maxCombLag);
+        float centre = combScore(bestLag, maxCombLag);
+        float right = combScore(bestLag + 1, maxCombLag);
+        float denominator = left - 2.0f * centre + right;
+        if (denominator < 0) {
+            refinedLag += ofClamp(0.5f * (left - right) / denominator, -0.5f, 0.5f);
+        }
+    }
+    
+    // Follow small drifts immediately; require two agreeing estimates
+    // before jumping to a different tempo
+    if (fabsf(refinedLag - estimatedPeriod) < estimatedPeriod * 0.05f) {
+        estimatedPeriod = estimatedPeriod * 0.7f + refinedLag * 0.3f;
+        pendingCount = 0;
+    } else if (pendingCount > 0 && fabsf(refinedLag - pendingPeriod) < pendingPeriod * 0.05f) {
+        estimatedPeriod = refinedLag;
+        pendingCount = 0;
+    } else {
+        pendingPeriod = refinedLag;
+        pendingCount = 1;
+    }
+    
+    // Pull the PLL period into the estimator's range
+    periodHops = ofClamp(periodHops, estimatedPeriod * 0.95f, estimatedPeriod * 1.05f);
+}
+
+float BeatDetector::combScore(int lag, int maxCombLag) {
+    // The k-th multiple of a fractional period can sit up to k - 1 lags
+    // away from k * lag, so search a window that widens with k
+    float sum = 0;
+    for (int k = 1; k <= 4; k++) {
+        int centre = k * lag;
+        if (centre > maxCombLag) break;
+        
+        float peak = autocorrelation[centre];
+        for (int j = std::max(minLag, centre - (k - 1)); j <= std::min(maxCombLag, centre + (k - 1)); j++) {
+            peak = std::max(peak, autocorrelation[j]);
+        }
+        sum += peak;
+    }
+    return sum;
 }
 
 //--------------------------------------------------------------
@@ -123,11 +325,13 @@ void BeatDetector::update(float* spectrum, int numBands, float* waveform, int bu
 
 AudioAnalyzer::AudioAnalyzer() {
     bufferSize = 1024;
+    hopSize = bufferSize / 2;
     sampleRate = 44100;
     numBands = bufferSize / 2;
     inputGain = 1.0;
     inputReady = false;
     energy = 0;
+    minDecibels = -70.0;
     
     // Allocate arrays
     spectrum = new float[numBands];
@@ -142,41 +346,83 @@ AudioAnalyzer::AudioAnalyzer() {
         waveform[i] = 0;
     }
     
-    // Initialize audio buffer
-    audioBuffer.resize(bufferSize, 0);
+    // Initialize sample ring (about 185 ms at 44.1kHz) and analysis window
+    sampleRing.setup(bufferSize * 8);
+    inputScratch.resize(bufferSize, 0);
+    analysisWindow.resize(bufferSize, 0);
+    
+    // Initialize FFT and its working buffers
+    fft.setup(bufferSize);
+    magnitudes.resize(numBands, 0);
+    
+    // Initialize band reduction (16 log-spaced bands by default)
+    bandScale = BAND_SCALE_LOG;
+    numScaleBands = 16;
+    energyRow = 0;
+    scaleRow = 0;
+    
+    // Initialize triggers and thresholds
+    for (int i = 0; i < AUDIO_BAND_COUNT; i++) {
+        bandTriggers[i] = false;
+    }
     
-    // Initialize band levels and thresholds
-    bandLevels["bass"] = 0;
-    bandLevels["lowMid"] = 0;
-    bandLevels["mid"] = 0;
-    bandLevels["highMid"] = 0;
-    bandLevels["high"] = 0;
+    bandThresholds[AUDIO_BAND_BASS] = 0.6;
+    bandThresholds[AUDIO_BAND_LOW_MID] = 0.5;
+    bandThresholds[AUDIO_BAND_MID] = 0.4;
+    bandThresholds[AUDIO_BAND_HIGH_MID] = 0.3;
+    bandThresholds[AUDIO_BAND_HIGH] = 0.2;
     
-    bandThresholds["bass"] = 0.6;
-    bandThresholds["lowMid"] = 0.5;
-    bandThresholds["mid"] = 0.4;
-    bandThresholds["highMid"] = 0.3;
-    bandThresholds["high"] = 0.2;
+    bpm = 120;
+    beatPhase = 0;
+    beatConfidence = 0;
+    onBeat = false;
+    onset = false;
+    lastBeatCount = 0;
+    lastOnsetCount = 0;
+    
+    trackMode = false;
+    trackPlaying = false;
+    trackPosition = 0;
+    trackSeekRequest = -1;
+    lastTrackFrame = -1;
+    trackLoadState = TRACK_LOAD_IDLE;
+    trackLoadSucceeded = false;
+    pendingTrackPlay = false;
+    inputDeviceId = 0;
+    
+    setupBandReducer();
+    
+    // Size the published snapshots
+    for (int i = 0; i < TripleBuffer<AudioFrame>::size(); i++) {
+        frames.getBuffer(i).setup(numBands, bufferSize);
+    }
+    publishedFrames = 0;
     
-    bandTriggers["bass"] = false;
-    bandTriggers["lowMid"] = false;
-    bandTriggers["mid"] = false;
-    bandTriggers["highMid"] = false;
-    bandTriggers["high"] = false;
+    frameAllocations = 0;
+    allocationWarningShown = false;
 }
 
 AudioAnalyzer::~AudioAnalyzer() {
-    // Clean up resources
-    delete[] spectrum;
-    delete[] waveform;
+    // Let a running track load finish; it writes into this object
+    if (trackLoader.joinable()) {
+        trackLoader.join();
+    }
     
     // Close sound stream
     soundStream.close();
+    
+    // Stop the beat tracking thread
+    beatDetector.stop();
+    
+    // Clean up resources
+    delete[] spectrum;
+    delete[] waveform;
 }
 
 void AudioAnalyzer::setup() {
-    // Initialize beat detector
-    beatDetector.setup(bufferSize);
+    // Initialize beat detector and its tracking thread
+    beatDetector.setup(hopSize, sampleRate, numBands);
+    beatDetector.start();
     
     // Try to setup default input
     setupMicrophone();
@@ -186,6 +432,17 @@ bool AudioAnalyzer::setupMicrophone(int deviceId) {
     // Close any existing sound stream
     soundStream.close();
     
+    // No producer is running now, so stale samples can be dropped
+    sampleRing.reset();
+    
+    // Leave track replay
+    trackMode = false;
+    trackPlaying = false;
+    setupBandReducer();
+    
+    // Remember the device so a failed track load can come back to it
+    inputDeviceId = deviceId;
+    
     // Set up sound stream with device ID
     ofSoundStreamSettings settings;
     
@@ -236,150 +493,408 @@ void AudioAnalyzer::setInputGain(float gain) {
 }
 
 void AudioAnalyzer::audioIn(ofSoundBuffer& input) {
-    // Copy audio buffer with gain applied
-    for (int i = 0; i < bufferSize && i < input.getNumFrames(); i++) {
-        audioBuffer[i] = input[i] * inputGain;
+    // Runs on the sound-stream thread: apply gain and hand samples to the ring
+    size_t numFrames = input.getNumFrames();
+    size_t offset = 0;
+    
+    while (offset < numFrames) {
+        size_t count = std::min(numFrames - offset, inputScratch.size());
+        for (size_t i = 0; i < count; i++) {
+            inputScratch[i] = input[offset + i] * inputGain;
+        }
+        
+        // If update() stalls long enough to fill the ring, the newest samples are dropped
+        sampleRing.write(inputScratch.data(), count);
+        offset += count;
     }
 }
 
-void AudioAnalyzer::update() {
-    if (!inputReady) return;
+bool AudioAnalyzer::loadTrack(const string& path, bool playWhenLoaded) {
+    if (trackLoadState.load() == TRACK_LOAD_RUNNING) {
+        ofLogWarning("AudioAnalyzer") << "Still loading " << pendingTrackPath << ", ignoring " << path;
+        return false;
+    }
     
-    // Perform FFT on audio buffer
-    float* fftBuffer = new float[bufferSize];
-    for (int i = 0; i < bufferSize; i++) {
-        fftBuffer[i] = audioBuffer[i];
+    // Any earlier loader has finished; a result not yet picked up is replaced
+    if (trackLoader.joinable()) {
+        trackLoader.join();
     }
     
-    // Apply window function to reduce spectral leakage
-    for (int i = 0; i < bufferSize; i++) {
-        // Hann window
-        float window = 0.5 * (1 - cos(TWO_PI * i / (bufferSize - 1)));
-        fftBuffer[i] *= window;
+    pendingTrackPath = path;
+    pendingTrackPlay = playWhenLoaded;
+    trackLoadState = TRACK_LOAD_RUNNING;
+    trackLoader = std::thread(&AudioAnalyzer::loadPendingTrack, this, path, bufferSize, minDecibels);
+    return true;
+}
+
+void AudioAnalyzer::loadPendingTrack(string path, int bufferSize, float minDecibels) {
+    bool success = pendingTrackAudio.load(path);
+    
+    if (success) {
+        // Reuse the cached analysis only if it was made from this exact
+        // file with the same analyzer settings
+        string cachePath = path + ".msft";
+        int64_t modifiedTime = getModifiedTime(path);
+        bool cacheValid = pendingFeatureTrack.load(cachePath) &&
+                          pendingFeatureTrack.getNumSamples() == pendingTrackAudio.getNumSamples() &&
+                          pendingFeatureTrack.getSampleRate() == pendingTrackAudio.getSampleRate() &&
+                          pendingFeatureTrack.getBufferSize() == bufferSize &&
+                          pendingFeatureTrack.getMinDecibels() == minDecibels &&
+                          pendingFeatureTrack.getSourceModifiedTime() == modifiedTime;
+        
+        if (!cacheValid) {
+            OfflineAnalyzer offlineAnalyzer;
+            offlineAnalyzer.setBufferSize(bufferSize);
+            offlineAnalyzer.setMinDecibels(minDecibels);
+            
+            success = offlineAnalyzer.analyze(pendingTrackAudio.getSamples(), pendingTrackAudio.getSampleRate(), pendingFeatureTrack);
+            if (success) {
+                pendingFeatureTrack.setSource(modifiedTime, minDecibels);
+                pendingFeatureTrack.save(cachePath);
+            }
+        }
     }
     
-    // Compute FFT
-    // Note: In a real implementation, this would use ofxFft or similar addon
-    // For this example, we'll simulate FFT results
-    for (int i = 0; i < numBands; i++) {
-        // Generate fake spectrum data for demonstration
-        // In a real implementation, this would use actual FFT results
-        float level = 0.0;
+    if (!success) {
+        pendingTrackAudio.clear();
+        pendingFeatureTrack.clear();
+    }
+    
+    // Publishes the pending track to the main thread
+    trackLoadSucceeded = success;
+    trackLoadState = TRACK_LOAD_DONE;
+}
+
+void AudioAnalyzer::finishTrackLoad() {
+    if (trackLoadState.load() != TRACK_LOAD_DONE) return;
+    
+    trackLoader.join();
+    trackLoadState = TRACK_LOAD_IDLE;
+    
+    if (!trackLoadSucceeded) {
+        ofLogError("AudioAnalyzer") << "Could not load track " << pendingTrackPath << ", keeping the current input";
+        return;
+    }
+    
+    // The sound-stream thread reads the track, so stop it before swapping
+    bool wasTrackMode = trackMode;
+    bool wasPlaying = trackPlaying;
+    uint64_t previousPosition = trackPosition;
+    soundStream.close();
+    trackPlaying = false;
+    
+    std::swap(trackAudio, pendingTrackAudio);
+    std::swap(featureTrack, pendingFeatureTrack);
+    
+    if (openTrackOutput()) {
+        trackMode = true;
+        inputReady = false;
+        trackPlaying = pendingTrackPlay;
+        setupBandReducer();
+        ofLogNotice("AudioAnalyzer") << "Loaded track " << pendingTrackPath << " (" << featureTrack.getNumFrames() << " frames)";
+    } else {
+        // Put back whatever was running before
+        std::swap(trackAudio, pendingTrackAudio);
+        std::swap(featureTrack, pendingFeatureTrack);
         
-        // Simulate some energy in different frequency ranges
-        if (i < numBands / 8) {
-            // Bass (low frequencies)
-            level = ofNoise(ofGetElapsedTimef() * 2, i * 0.1) * 0.8;
-        } else if (i < numBands / 4) {
-            // Low mids
-            level = ofNoise(ofGetElapsedTimef() * 1.5, i * 0.05) * 0.6;
-        } else if (i < numBands / 2) {
-            // Mids
-            level = ofNoise(ofGetElapsedTimef(), i * 0.02) * 0.5;
+        if (wasTrackMode && openTrackOutput()) {
+            trackPosition = previousPosition;
+            trackPlaying = wasPlaying;
         } else {
-            // Highs
-            level = ofNoise(ofGetElapsedTimef() * 0.8, i * 0.01) * 0.3;
+            setupMicrophone(inputDeviceId);
         }
-        
-        // Smooth spectrum values
-        spectrum[i] = spectrum[i] * 0.8 + level * 0.2;
     }
     
-    // Copy audio buffer to waveform
-    for (int i = 0; i < bufferSize; i++) {
-        waveform[i] = audioBuffer[i];
+    pendingTrackAudio.clear();
+    pendingFeatureTrack.clear();
+}
+
+bool AudioAnalyzer::openTrackOutput() {
+    // Open an output stream at the file's own rate
+    ofSoundStreamSettings settings;
+    auto devices = soundStream.getMatchingDevices("", 0, 2);
+    if (devices.empty()) {
+        ofLogError("AudioAnalyzer") << "No output devices found";
+        return false;
     }
     
-    // Calculate band levels
-    calculateBandLevels();
+    settings.setOutDevice(devices[0]);
+    settings.setOutListener(this);
+    settings.sampleRate = trackAudio.getSampleRate();
+    settings.numOutputChannels = 2;
+    settings.numInputChannels = 0;
+    settings.bufferSize = bufferSize;
     
-    // Calculate overall energy
-    calculateEnergy();
+    trackPosition = 0;
+    trackSeekRequest = -1;
+    lastTrackFrame = -1;
     
-    // Update triggers
-    updateTriggers();
+    if (!soundStream.setup(settings)) {
+        ofLogError("AudioAnalyzer") << "Failed to open output at " << trackAudio.getSampleRate() << " Hz";
+        return false;
+    }
+    return true;
+}
+
+void AudioAnalyzer::playTrack() {
+    if (trackMode) {
+        trackPlaying = true;
+    }
+}
+
+void AudioAnalyzer::pauseTrack() {
+    trackPlaying = false;
+}
+
+void AudioAnalyzer::seekTrack(float seconds) {
+    if (!trackMode) return;
     
-    // Update beat detector
-    beatDetector.update(spectrum, numBands, waveform, bufferSize);
+    int64_t position = (int64_t)(seconds * trackAudio.getSampleRate());
+    trackSeekRequest = std::max<int64_t>(0, std::min<int64_t>(position, trackAudio.getNumSamples()));
+}
+
+float AudioAnalyzer::getTrackPosition() {
+    if (!trackMode) return 0;
+    return (float)trackPosition.load() / trackAudio.getSampleRate();
+}
+
+void AudioAnalyzer::audioOut(ofSoundBuffer& output) {
+    // Runs on the sound-stream thread: play the decoded track
+    int64_t seek = trackSeekRequest.exchange(-1);
+    uint64_t position = seek >= 0 ? seek : trackPosition.load();
+    
+    const vector<float>& samples = trackAudio.getSamples();
+    size_t numFrames = output.getNumFrames();
+    size_t numChannels = output.getNumChannels();
+    bool playing = trackPlaying;
+    
+    for (size_t frame = 0; frame < numFrames; frame++) {
+        float sample = 0;
+        if (playing && position < samples.size()) {
+            sample = samples[position++];
+        }
+        for (size_t channel = 0; channel < numChannels; channel++) {
+            output[frame * numChannels + channel] = sample;
+        }
+    }
     
-    // Clean up
-    delete[] fftBuffer;
+    trackPosition = position;
+    if (position >= samples.size()) {
+        trackPlaying = false;
+    }
 }
 
-void AudioAnalyzer::calculateBandLevels() {
-    // Define frequency bands
-    int bassStart = 0;
-    int bassEnd = numBands / 8;
+void AudioAnalyzer::updateTrack() {
+    uint64_t position = trackPosition.load();
+    int trackHop = featureTrack.getHopSize();
+    int frame = std::min((int)(position / trackHop) - 1, featureTrack.getNumFrames() - 1);
+    
+    if (frame < 0) {
+        // Nothing analyzed yet at the very start of the track
+        for (int i = 0; i < numBands; i++) {
+            spectrum[i] = 0;
+        }
+        onBeat = false;
+        onset = false;
+        lastTrackFrame = -1;
+    } else {
+        // Dequantize the spectrum
+        const uint8_t* quantized = featureTrack.getSpectrum(frame);
+        int bins = std::min(numBands, featureTrack.getNumBins());
+        for (int i = 0; i < bins; i++) {
+            spectrum[i] = quantized[i] / 255.0f;
+        }
+        
+        // Report every event passed since the last frame; after a seek
+        // backwards only the current frame counts
+        int firstFrame = frame > lastTrackFrame ? lastTrackFrame + 1 : frame;
+        uint8_t flags = 0;
+        for (int i = firstFrame; i <= frame; i++) {
+            flags |= featureTrack.flags(i);
+        }
+        onBeat = frame != lastTrackFrame && (flags & FEATURE_BEAT);
+        onset = frame != lastTrackFrame && (flags & FEATURE_ONSET);
+        lastTrackFrame = frame;
+        
+        // Advance the phase through the part of a hop played since the frame
+        bpm = featureTrack.bpm(frame);
+        beatConfidence = featureTrack.confidence(frame);
+        float hopsPerBeat = 60.0f * featureTrack.getSampleRate() / (trackHop * std::max(bpm, 1.0f));
+        float hopFraction = (float)(position - (uint64_t)(frame + 1) * trackHop) / trackHop;
+        beatPhase = fmodf(featureTrack.phase(frame) + hopFraction / hopsPerBeat, 1.0f);
+    }
+    
+    // Waveform is the window ending at the play position
+    const vector<float>& samples = trackAudio.getSamples();
+    for (int i = 0; i < bufferSize; i++) {
+        int64_t index = (int64_t)position - bufferSize + i;
+        waveform[i] = (index >= 0 && index < (int64_t)samples.size()) ? samples[index] : 0;
+    }
     
-    int lowMidStart = numBands / 8;
-    int lowMidEnd = numBands / 4;
+    reduceBands();
+    updateTriggers();
+}
+
+void AudioAnalyzer::update() {
+    // Switch to a track once its background load has finished
+    finishTrackLoad();
     
-    int midStart = numBands / 4;
-    int midEnd = numBands / 2;
+    if (trackMode) {
+        updateTrack();
+        publishFrame();
+        return;
+    }
     
-    int highMidStart = numBands / 2;
-    int highMidEnd = numBands * 3 / 4;
+    if (!inputReady) return;
     
-    int highStart = numBands * 3 / 4;
-    int highEnd = numBands - 1;
+    // Everything below must stay allocation-free; debug builds verify it
+    uint64_t allocationsBefore = AllocationCounter::getThreadAllocations();
     
-    // Calculate average energy in each band
-    float bassSum = 0;
-    for (int i = bassStart; i <= bassEnd; i++) {
-        bassSum += spectrum[i];
+    // Consume every sample that arrived since the last frame, one hop at a time.
+    // A partial hop stays in the ring until the next frame
+    int keep = bufferSize - hopSize;
+    while (sampleRing.available() >= (size_t)hopSize) {
+        // Slide the analysis window and append the new hop
+        memmove(analysisWindow.data(), analysisWindow.data() + hopSize, keep * sizeof(float));
+        sampleRing.read(analysisWindow.data() + keep, hopSize);
+        
+        analyzeHop();
     }
-    bandLevels["bass"] = bassSum / (bassEnd - bassStart + 1);
     
-    float lowMidSum = 0;
-    for (int i = lowMidStart; i <= lowMidEnd; i++) {
-        lowMidSum += spectrum[i];
+    // Copy the most recent window to waveform
+    for (int i = 0; i < bufferSize; i++) {
+        waveform[i] = analysisWindow[i];
     }
-    bandLevels["lowMid"] = lowMidSum / (lowMidEnd - lowMidStart + 1);
     
-    float midSum = 0;
-    for (int i = midStart; i <= midEnd; i++) {
-        midSum += spectrum[i];
-    }
-    bandLevels["mid"] = midSum / (midEnd - midStart + 1);
+    // Calculate band levels, energy and scale bands
+    reduceBands();
+    
+    // Update triggers
+    updateTriggers();
     
-    float highMidSum = 0;
-    for (int i = highMidStart; i <= highMidEnd; i++) {
-        highMidSum += spectrum[i];
+    // Latch beat and onset events published by the tracking thread
+    uint32_t beatCount = beatDetector.getBeatCount();
+    uint32_t onsetCount = beatDetector.getOnsetCount();
+    onBeat = beatCount != lastBeatCount;
+    onset = onsetCount != lastOnsetCount;
+    lastBeatCount = beatCount;
+    lastOnsetCount = onsetCount;
+    
+    bpm = beatDetector.getBPM();
+    beatPhase = beatDetector.getPhase();
+    beatConfidence = beatDetector.getConfidence();
+    
+    // Hand the results to rendering
+    publishFrame();
+    
+    frameAllocations = AllocationCounter::getThreadAllocations() - allocationsBefore;
+    if (frameAllocations > 0 && !allocationWarningShown) {
+        ofLogWarning("AudioAnalyzer") << "Analysis path made " << frameAllocations << " heap allocations in one frame";
+        allocationWarningShown = true;
     }
-    bandLevels["highMid"] = highMidSum / (highMidEnd - highMidStart + 1);
+}
+
+void AudioAnalyzer::publishFrame() {
+    AudioFrame& frame = frames.getWriteBuffer();
+    
+    std::copy(spectrum, spectrum + numBands, frame.spectrum.begin());
+    std::copy(waveform, waveform + bufferSize, frame.waveform.begin());
     
-    float highSum = 0;
-    for (int i = highStart; i <= highEnd; i++) {
-        highSum += spectrum[i];
+    for (int band = 0; band < AUDIO_BAND_COUNT; band++) {
+        frame.bandLevels[band] = reducedBands[band];
+        frame.bandTriggers[band] = bandTriggers[band];
     }
-    bandLevels["high"] = highSum / (highEnd - highStart + 1);
+    
+    frame.numScaleBands = numScaleBands;
+    std::copy(reducedBands.begin() + scaleRow, reducedBands.begin() + scaleRow + numScaleBands, frame.scaleBands);
+    
+    frame.energy = energy;
+    frame.bpm = bpm;
+    frame.beatPhase = beatPhase;
+    frame.beatConfidence = beatConfidence;
+    frame.onBeat = onBeat;
+    frame.onset = onset;
+    frame.frameNumber = ++publishedFrames;
+    
+    frames.publish();
 }
 
-void AudioAnalyzer::calculateEnergy() {
-    float sum = 0;
+const AudioFrame& AudioAnalyzer::acquireFrame() {
+    frames.acquire();
+    return frames.getReadBuffer();
+}
+
+void AudioAnalyzer::analyzeHop() {
+    // Compute FFT (Hann window is applied inside)
+    fft.process(analysisWindow.data(), magnitudes.data());
+    
+    float keep = spectrumSmoothing(hopSize, sampleRate);
+    
+    // Map magnitudes to a 0-1 decibel scale and smooth
     for (int i = 0; i < numBands; i++) {
-        sum += spectrum[i];
+        float level = magnitudeToLevel(magnitudes[i], minDecibels);
+        
+        // Smooth spectrum values
+        spectrum[i] = spectrum[i] * keep + level * (1.0f - keep);
     }
-    energy = sum / numBands;
+    
+    // Feed onset detection with the raw magnitudes
+    beatDetector.process(magnitudes.data(), numBands);
+}
+
+void AudioAnalyzer::setBandScale(BandScale scale, int numBands) {
+    bandScale = scale;
+    numScaleBands = ofClamp(numBands, 1, AUDIO_FRAME_MAX_SCALE_BANDS);
+    setupBandReducer();
+}
+
+void AudioAnalyzer::setupBandReducer() {
+    bandReducer.clear();
+    
+    // Named bands (inclusive bin ranges), in AudioBand order
+    const int bandStarts[AUDIO_BAND_COUNT] = {
+        0, numBands / 8, numBands / 4, numBands / 2, numBands * 3 / 4
+    };
+    const int bandEnds[AUDIO_BAND_COUNT] = {
+        numBands / 8, numBands / 4, numBands / 2, numBands * 3 / 4, numBands - 1
+    };
+    for (int band = 0; band < AUDIO_BAND_COUNT; band++) {
+        bandReducer.addRange(bandStarts[band], bandEnds[band]);
+    }
+    
+    // Overall energy
+    energyRow = bandReducer.addRange(0, numBands - 1);
+    
+    // Scale bands across the audible range
+    float rate = trackMode ? trackAudio.getSampleRate() : sampleRate;
+    scaleRow = bandReducer.addScale(bandScale, numScaleBands, 20.0f, 16000.0f, numBands, rate);
+    
+    reducedBands.assign(bandReducer.getNumRows(), 0);
+}
+
+void AudioAnalyzer::reduceBands() {
+    bandReducer.process(spectrum, reducedBands.data());
+    energy = reducedBands[energyRow];
 }
 
 void AudioAnalyzer::updateTriggers() {
-    for (auto& trigger : bandTriggers) {
-        string band = trigger.first;
-        trigger.second = bandLevels[band] > bandThresholds[band];
+    for (int band = 0; band < AUDIO_BAND_COUNT; band++) {
+        bandTriggers[band] = reducedBands[band] > bandThresholds[band];
     }
 }
 
-float AudioAnalyzer::getBandEnergy(string band) {
-    if (bandLevels.find(band) != bandLevels.end()) {
-        return bandLevels[band];
+float AudioAnalyzer::getBandEnergy(const string& band) {
+    int index = getAudioBandIndex(band);
+    if (index >= 0) {
+        return reducedBands[index];
     }
     return 0.0;
 }
 
-bool AudioAnalyzer::getTrigger(string band) {
-    if (bandTriggers.find(band) != bandTriggers.end()) {
-        return bandTriggers[band];
+bool AudioAnalyzer::getTrigger(const string& band) {
+    int index = getAudioBandIndex(band);
+    if (index >= 0) {
+        return bandTriggers[index];
     }
     return false;
 }
\ No newline at end of file
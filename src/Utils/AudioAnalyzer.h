@@ -2,39 +2,116 @@
 #pragma once
 
 #include "ofMain.h"
+#include "FFT.h"
+#include "RingBuffer.h"
+#include "CircularBuffer.h"
+#include "AudioBands.h"
+#include "BandReducer.h"
+#include "AudioFrame.h"
+#include "TripleBuffer.h"
+#include "WavFile.h"
+#include "FeatureTrack.h"
+#include <condition_variable>
 
-class BeatDetector {
+// Onset detection and tempo tracking.
+// process() runs on the analysis path once per hop and only computes a
+// multi-band spectral flux value; tempo estimation and the beat
+// phase-locked loop run on the detector's own thread.
+class BeatDetector : public ofThread {
 public:
+    // Low (< 150 Hz), mid (< 2 kHz) and high flux bands
+    static const int fluxBandCount = 3;
+    
     BeatDetector();
     ~BeatDetector();
     
-    void setup(int bufferSize);
-    void update(float* spectrum, int numBands, float* waveform, int bufferSize);
+    void setup(int hopSize, int sampleRate, int numBins);
     
-    float getBPM() { return bpm; }
-    float getConfidence() { return confidence; }
-    float getPhase() { return phase; }
-    bool isOnBeat() { return onBeat; }
+    // Start/stop the tracking thread
+    void start();
+    void stop();
+    
+    // Feed one hop of linear FFT magnitudes (analysis thread)
+    void process(const float* magnitudes, int numBins);
+    
+    // Onset strength for one hop of magnitudes
+    float computeFlux(const float* magnitudes, int numBins);
+    
+    // The two halves of computeFlux(): raw per-band flux against the
+    // previous hop, then adaptive whitening into one onset value.
+    // Offline analysis runs the first in parallel and the second in order
+    void computeBandFlux(const float* magnitudes, int numBins, float* bandFlux);
+    float combineBandFlux(const float* bandFlux);
+    
+    // Advance the tracker by one hop of onset strength. Called by the
+    // tracking thread, or directly when the thread is not running
+    void processFlux(float flux);
+    
+    float getBPM() { return bpm.load(); }
+    float getConfidence() { return confidence.load(); }
+    float getPhase() { return phase.load(); }
+    
+    // Monotonic event counters, so no beat is missed between frames
+    uint32_t getBeatCount() { return beatCount.load(); }
+    uint32_t getOnsetCount() { return onsetCount.load(); }
+    
+protected:
+    void threadedFunction() override;
     
 private:
-    float bpm;
-    float confidence;
-    float phase;
-    bool onBeat;
+    float hopRate;
     
-    // Beat detection parameters
-    vector<float> energyHistory;
-    vector<float> beatHistory;
-    float beatThreshold;
-    float minBeatInterval;
-    float lastBeatTime;
+    // Published results
+    std::atomic<float> bpm;
+    std::atomic<float> confidence;
+    std::atomic<float> phase;
+    std::atomic<uint32_t> beatCount;
+    std::atomic<uint32_t> onsetCount;
     
-    // For calculating BPM
-    vector<float> beatTimes;
-    int maxBeatTimes;
+    // Spectral flux (analysis thread)
+    vector<float> previousSpectrum;
+    int fluxBandEdges[fluxBandCount + 1];
+    float fluxBandPeaks[fluxBandCount];
+    
+    // Flux values handed to the tracking thread
+    RingBuffer<float> fluxRing;
+    std::mutex wakeMutex;
+    std::condition_variable wakeCondition;
+    
+    // Onset detection function history (tracking thread)
+    CircularBuffer<float> odfHistory;
+    uint64_t hopIndex;
+    uint64_t lastOnsetHop;
+    float onsetThresholdRatio;
+    float onsetThresholdDelta;
+    int onsetThresholdWindow;
+    int minOnsetHops;
+    
+    // Tempo estimation
+    vector<float> odfLinear;
+    vector<float> autocorrelation;
+    int minLag;
+    int maxLag;
+    int tempoInterval;
+    float estimatedPeriod;
+    float pendingPeriod;
+    int pendingCount;
+    
+    // Phase-locked loop, in hops
+    float beatPhase;
+    float periodHops;
+    float phaseGain;
+    float periodGain;
+    float lockWindow;
+    
+    // Re-estimate the beat period from the onset history
+    void estimateTempo();
+    
+    // Autocorrelation summed over the first four multiples of a lag
+    float combScore(int lag, int maxCombLag);
 };
 
-class AudioAnalyzer : public ofBaseSoundInput {
+class AudioAnalyzer : public ofBaseSoundInput, public ofBaseSoundOutput {
 public:
     AudioAnalyzer();
     ~AudioAnalyzer();
@@ -42,27 +119,75 @@ public:
     void setup();
     void update();
     
+    // Snapshot handoff to rendering. update() publishes one AudioFrame per
+    // call; acquireFrame() switches to the newest published frame, which
+    // then stays unchanged (and readable via getFrame()) until the next
+    // acquireFrame(), whichever thread update() runs on
+    const AudioFrame& acquireFrame();
+    const AudioFrame& getFrame() { return frames.getReadBuffer(); }
+    
     // Audio input setup
     bool setupMicrophone(int deviceId = 0);
     bool setupLineInput(int deviceId = 0);
     void setInputGain(float gain);
     
+    // Track replay: plays a WAV file and drives every output from its
+    // pre-computed feature track (cached next to the file as .msft and
+    // generated on first load). Decoding and analysis run on a worker
+    // thread while the current input keeps going; update() switches to the
+    // track once it is ready, or keeps the current input if the track
+    // cannot be played. Returns false if a load is already running.
+    // setupMicrophone() returns to live input
+    bool loadTrack(const string& path, bool playWhenLoaded = false);
+    bool isTrackLoading() { return trackLoadState.load() == TRACK_LOAD_RUNNING; }
+    void playTrack();
+    void pauseTrack();
+    void seekTrack(float seconds);
+    bool isTrackLoaded() { return trackMode; }
+    bool isTrackPlaying() { return trackPlaying.load(); }
+    float getTrackPosition();
+    float getTrackDuration() { return trackAudio.getDuration(); }
+    
+    // Map an FFT magnitude to the 0-1 decibel scale used by the spectrum
+    static float magnitudeToLevel(float magnitude, float minDecibels) {
+        float decibels = 20.0f * log10f(magnitude + 1e-9f);
+        return ofClamp((decibels - minDecibels) / -minDecibels, 0, 1);
+    }
+    
+    // Share of the previous spectrum kept at each hop: decays like 0.8 per
+    // frame at 60 fps whatever the hop duration, so smoothing doesn't
+    // change with sample rate or hop size
+    static float spectrumSmoothing(int hopSize, int sampleRate) {
+        float hopDuration = (float)hopSize / sampleRate;
+        return powf(0.8f, hopDuration * 60.0f);
+    }
+    
     // Get audio data
     float* getSpectrum() { return spectrum; }
     float* getWaveform() { return waveform; }
     int getNumBands() { return numBands; }
     
     // Get band energy
-    float getBandEnergy(string band);
+    float getBandEnergy(AudioBand band) { return reducedBands[band]; }
+    float getBandEnergy(const string& band);
+    const float* getBandLevels() { return reducedBands.data(); }
+    
+    // Log- or mel-spaced bands, reduced from the spectrum once per frame
+    void setBandScale(BandScale scale, int numBands);
+    BandScale getBandScale() { return bandScale; }
+    const float* getScaleBands() { return reducedBands.data() + scaleRow; }
+    int getNumScaleBands() { return numScaleBands; }
     
     // Get FFT settings
     int getBufferSize() { return bufferSize; }
     int getSampleRate() { return sampleRate; }
     
     // Beat detection
-    float getBPM() { return beatDetector.getBPM(); }
-    float getBeatPhase() { return beatDetector.getPhase(); }
-    bool isOnBeat() { return beatDetector.isOnBeat(); }
+    float getBPM() { return bpm; }
+    float getBeatPhase() { return beatPhase; }
+    float getBeatConfidence() { return beatConfidence; }
+    bool isOnBeat() { return onBeat; }
+    bool isOnset() { return onset; }
     
     // Get overall energy
     float getEnergy() { return energy; }
@@ -71,29 +196,57 @@ public:
     bool hasInput() { return inputReady; }
     
     // Trigger states for different bands
-    bool getTrigger(string band);
+    bool getTrigger(AudioBand band) { return bandTriggers[band]; }
+    bool getTrigger(const string& band);
+    
+    // Heap allocations made by the last update() (debug builds only)
+    uint64_t getFrameAllocations() { return frameAllocations; }
     
-    // Make audioIn public as it needs to be accessible by ofSoundStreamSettings
+    // Make audioIn/audioOut public as they need to be accessible by ofSoundStreamSettings
     void audioIn(ofSoundBuffer& input);
+    void audioOut(ofSoundBuffer& output);
     
 private:
     // Audio input
     ofSoundStream soundStream;
-    vector<float> audioBuffer;
     int bufferSize;
+    int hopSize;
     int sampleRate;
     float inputGain;
     bool inputReady;
     
+    // Samples handed from the sound-stream thread to update()
+    RingBuffer<float> sampleRing;
+    vector<float> inputScratch;
+    
+    // Sliding analysis window, advanced one hop at a time
+    vector<float> analysisWindow;
+    
     // FFT analysis
+    FFT fft;
+    vector<float> magnitudes;
+    float minDecibels;
     float* spectrum;
     float* waveform;
     int numBands;
     
-    // Band levels and triggers
-    map<string, float> bandLevels;
-    map<string, float> bandThresholds;
-    map<string, bool> bandTriggers;
+    // Every per-frame reduction of the spectrum comes from one kernel pass.
+    // reducedBands holds the AudioBand levels, then overall energy, then
+    // the log/mel scale bands
+    BandReducer bandReducer;
+    vector<float> reducedBands;
+    BandScale bandScale;
+    int numScaleBands;
+    int energyRow;
+    int scaleRow;
+    
+    // Band triggers, indexed by AudioBand
+    float bandThresholds[AUDIO_BAND_COUNT];
+    bool bandTriggers[AUDIO_BAND_COUNT];
+    
+    // Allocation accounting for the analysis path
+    uint64_t frameAllocations;
+    bool allocationWarningShown;
     
     // Overall energy
     float energy;
@@ -101,12 +254,71 @@ private:
     // Beat detection
     BeatDetector beatDetector;
     
-    // Calculate band levels
-    void calculateBandLevels();
+    // Beat state published once per frame
+    float bpm;
+    float beatPhase;
+    float beatConfidence;
+    bool onBeat;
+    bool onset;
+    uint32_t lastBeatCount;
+    uint32_t lastOnsetCount;
+    
+    // Track replay. The sound-stream thread owns the play position;
+    // seeks are posted to it and applied at the next buffer
+    WavFile trackAudio;
+    FeatureTrack featureTrack;
+    bool trackMode;
+    std::atomic<bool> trackPlaying;
+    std::atomic<uint64_t> trackPosition;
+    std::atomic<int64_t> trackSeekRequest;
+    int lastTrackFrame;
+    
+    // Publish the feature-track frame at the current play position
+    void updateTrack();
+    
+    // Background track loading. The worker fills the pending track and
+    // sets the state to done; update() then swaps it in
+    enum TrackLoadState {
+        TRACK_LOAD_IDLE,
+        TRACK_LOAD_RUNNING,
+        TRACK_LOAD_DONE
+    };
+    std::thread trackLoader;
+    std::atomic<int> trackLoadState;
+    bool trackLoadSucceeded;
+    string pendingTrackPath;
+    bool pendingTrackPlay;
+    WavFile pendingTrackAudio;
+    FeatureTrack pendingFeatureTrack;
+    
+    // Live input device, restored when a track fails to open
+    int inputDeviceId;
+    
+    // Worker: decode the file and load or compute its feature track
+    void loadPendingTrack(string path, int bufferSize, float minDecibels);
+    
+    // Main thread: switch to a finished pending track
+    void finishTrackLoad();
+    
+    // Open an output stream for the current track at its own rate
+    bool openTrackOutput();
+    
+    // Published snapshots
+    TripleBuffer<AudioFrame> frames;
+    uint64_t publishedFrames;
+    
+    // Copy the current analysis state into the next snapshot
+    void publishFrame();
+    
+    // Analyze the current window after it advanced by one hop
+    void analyzeHop();
+    
+    // Rebuild the band reduction rows for the current sample rate
+    void setupBandReducer();
+    
+    // Calculate band levels, energy and scale bands
+    void reduceBands();
     
     // Calculate triggers
     void updateTriggers();
-    
-    // Calculate overall energy
-    void calculateEnergy();
 };
\ No newline at end of file
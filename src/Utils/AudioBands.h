@@ -0,0 +1,30 @@
+// File: src/Utils/AudioBands.h
+#pragma once
+
+#include "ofMain.h"
+
+// Named frequency bands published by AudioAnalyzer.
+// Hot paths index arrays with these; names are only for presets and the GUI.
+enum AudioBand {
+    AUDIO_BAND_BASS,
+    AUDIO_BAND_LOW_MID,
+    AUDIO_BAND_MID,
+    AUDIO_BAND_HIGH_MID,
+    AUDIO_BAND_HIGH,
+    AUDIO_BAND_COUNT
+};
+
+inline const char* getAudioBandName(AudioBand band) {
+    static const char* names[AUDIO_BAND_COUNT] = { "bass", "lowMid", "mid", "highMid", "high" };
+    return (band >= 0 && band < AUDIO_BAND_COUNT) ? names[band] : "";
+}
+
+// Returns -1 for unknown names
+inline int getAudioBandIndex(const string& name) {
+    for (int i = 0; i < AUDIO_BAND_COUNT; i++) {
+        if (name == getAudioBandName((AudioBand)i)) {
+            return i;
+        }
+    }
+    return -1;
+}
@@ -0,0 +1,59 @@
+// File: src/Utils/AudioFrame.h
+#pragma once
+
+#include "ofMain.h"
+#include "AudioBands.h"
+
+// Upper bound for AudioAnalyzer::setBandScale()
+const int AUDIO_FRAME_MAX_SCALE_BANDS = 64;
+
+// Immutable snapshot of the audio analysis for one rendered frame.
+// AudioAnalyzer publishes one per update() through a triple buffer;
+// layers, effects and sprites only ever see it by const reference.
+struct AudioFrame {
+    AudioFrame() {
+        numScaleBands = 0;
+        energy = 0;
+        bpm = 120;
+        beatPhase = 0;
+        beatConfidence = 0;
+        onBeat = false;
+        onset = false;
+        frameNumber = 0;
+
+        for (int i = 0; i < AUDIO_BAND_COUNT; i++) {
+            bandLevels[i] = 0;
+            bandTriggers[i] = false;
+        }
+        for (int i = 0; i < AUDIO_FRAME_MAX_SCALE_BANDS; i++) {
+            scaleBands[i] = 0;
+        }
+    }
+
+    // Size the per-bin arrays once so publishing never allocates
+    void setup(int numBins, int bufferSize) {
+        spectrum.assign(numBins, 0);
+        waveform.assign(bufferSize, 0);
+    }
+
+    vector<float> spectrum;
+    vector<float> waveform;
+
+    float bandLevels[AUDIO_BAND_COUNT];
+    bool bandTriggers[AUDIO_BAND_COUNT];
+
+    float scaleBands[AUDIO_FRAME_MAX_SCALE_BANDS];
+    int numScaleBands;
+
+    float energy;
+    float bpm;
+    float beatPhase;
+    float beatConfidence;
+    bool onBeat;
+    bool onset;
+
+    // Incremented by every publish
+    uint64_t frameNumber;
+
+    float getBandEnergy(AudioBand band) const { return bandLevels[band]; }
+};
@@ -0,0 +1,114 @@
+// File: src/Utils/BandReducer.cpp
+#include "BandReducer.h"
+
+static float hzToMel(float hz) {
+    return 2595.0f * log10f(1.0f + hz / 700.0f);
+}
+
+static float melToHz(float mel) {
+    return 700.0f * (powf(10.0f, mel / 2595.0f) - 1.0f);
+}
+
+BandReducer::BandReducer() {
+}
+
+void BandReducer::clear() {
+    rowStarts.clear();
+    rowLengths.clear();
+    rowOffsets.clear();
+    weights.clear();
+}
+
+int BandReducer::addRange(int startBin, int endBin) {
+    vector<float> rowWeights(std::max(1, endBin - startBin + 1), 1.0f);
+    return addRow(startBin, rowWeights);
+}
+
+int BandReducer::addScale(BandScale scale, int numBands, float minHz, float maxHz, int numBins, float sampleRate) {
+    int firstRow = getNumRows();
+    float binHz = sampleRate / (2.0f * numBins);
+    maxHz = std::min(maxHz, sampleRate / 2.0f);
+    minHz = ofClamp(minHz, binHz, maxHz * 0.5f);
+
+    // numBands + 2 edges: each band rises from one edge to the next and falls to the one after
+    vector<float> edges(numBands + 2);
+    for (int i = 0; i < numBands + 2; i++) {
+        float t = (float)i / (numBands + 1);
+        if (scale == BAND_SCALE_MEL) {
+            edges[i] = melToHz(ofLerp(hzToMel(minHz), hzToMel(maxHz), t));
+        } else {
+            edges[i] = minHz * powf(maxHz / minHz, t);
+        }
+    }
+
+    vector<float> rowWeights;
+    for (int band = 0; band < numBands; band++) {
+        float low = edges[band] / binHz;
+        float centre = edges[band + 1] / binHz;
+        float high = edges[band + 2] / binHz;
+
+        int startBin = std::max(0, (int)ceilf(low));
+        int endBin = std::min(numBins - 1, (int)floorf(high));
+
+        // Low bands can be narrower than one bin; fall back to the nearest bin
+        if (endBin < startBin) {
+            startBin = endBin = std::min(numBins - 1, (int)roundf(centre));
+        }
+
+        rowWeights.assign(endBin - startBin + 1, 0);
+        for (int bin = startBin; bin <= endBin; bin++) {
+            float weight = bin <= centre ? (bin - low) / std::max(centre - low, 1e-6f)
+                                         : (high - bin) / std::max(high - centre, 1e-6f);
+            rowWeights[bin - startBin] = std::max(weight, 0.0f);
+        }
+        addRow(startBin, rowWeights);
+    }
+
+    return firstRow;
+}
+
+int BandReducer::addRow(int startBin, const vector<float>& rowWeights) {
+    float sum = 0;
+    for (float weight : rowWeights) {
+        sum += weight;
+    }
+    if (sum <= 0) {
+        sum = 1;
+    }
+
+    rowStarts.push_back(startBin);
+    rowLengths.push_back(rowWeights.size());
+    rowOffsets.push_back(weights.size());
+    for (float weight : rowWeights) {
+        weights.push_back(weight / sum);
+    }
+
+    return rowStarts.size() - 1;
+}
+
+void BandReducer::process(const float* spectrum, float* output) const {
+    const float* rowWeightData = weights.data();
+    int numRows = rowStarts.size();
+
+    for (int row = 0; row < numRows; row++) {
+        const float* bins = spectrum + rowStarts[row];
+        const float* w = rowWeightData + rowOffsets[row];
+        int length = rowLengths[row];
+
+        // Four independent accumulators let the compiler keep the loop in
+        // SIMD registers without reassociating a single sum
+        float sum0 = 0, sum1 = 0, sum2 = 0, sum3 = 0;
+        int i = 0;
+        for (; i + 4 <= length; i += 4) {
+            sum0 += bins[i] * w[i];
+            sum1 += bins[i + 1] * w[i + 1];
+            sum2 += bins[i + 2] * w[i + 2];
+            sum3 += bins[i + 3] * w[i + 3];
+        }
+        for (; i < length; i++) {
+            sum0 += bins[i] * w[i];
+        }
+
+        output[row] = (sum0 + sum1) + (sum2 + sum3);
+    }
+}
@@ -0,0 +1,42 @@
+// File: src/Utils/BandReducer.h
+#pragma once
+
+#include "ofMain.h"
+
+enum BandScale {
+    BAND_SCALE_LOG,
+    BAND_SCALE_MEL
+};
+
+// Reduces a spectrum to a handful of bands in one pass.
+// Each output row is a weighted average over a contiguous run of bins;
+// all weights live in one flat array so process() is a sequence of short
+// dot products over contiguous memory. Rows are built outside the frame
+// loop and process() never allocates.
+class BandReducer {
+public:
+    BandReducer();
+
+    void clear();
+
+    // Plain average of bins [startBin, endBin]; returns the row index
+    int addRange(int startBin, int endBin);
+
+    // Overlapping triangular bands spaced evenly on a log or mel axis
+    // between minHz and maxHz; returns the index of the first row
+    int addScale(BandScale scale, int numBands, float minHz, float maxHz, int numBins, float sampleRate);
+
+    // Writes getNumRows() values to output
+    void process(const float* spectrum, float* output) const;
+
+    int getNumRows() const { return rowStarts.size(); }
+
+private:
+    vector<int> rowStarts;
+    vector<int> rowLengths;
+    vector<int> rowOffsets;
+    vector<float> weights;
+
+    // Normalizes weights to sum to one and appends the row
+    int addRow(int startBin, const vector<float>& rowWeights);
+};
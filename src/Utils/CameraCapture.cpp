@@ -0,0 +1,121 @@
+// File: src/Utils/CameraCapture.cpp
+#include "CameraCapture.h"
+
+// How often the capture thread polls the grabber; well under a frame at 60 fps
+static const int capturePollMillis = 2;
+
+CameraCapture::CameraCapture() {
+    source = nullptr;
+    open = false;
+    width = 0;
+    height = 0;
+    frameCount = 0;
+    lastTimestamp = 0;
+    frameInterval = 33333;
+}
+
+CameraCapture::~CameraCapture() {
+    close();
+}
+
+bool CameraCapture::setup(CameraSource* source, int width, int height, int frameRate) {
+    close();
+    if (source == nullptr) return false;
+    
+    if (!source->setup(width, height, frameRate)) {
+        ofLogError("CameraCapture") << "Failed to open " << source->getName();
+        delete source;
+        return false;
+    }
+    
+    this->source = source;
+    sourceName = source->getName();
+    this->width = source->getWidth();
+    this->height = source->getHeight();
+    
+    // Size every frame up front so capturing never allocates
+    for (int i = 0; i < TripleBuffer<CameraFrame>::size(); i++) {
+        frames.getBuffer(i).pixels.allocate(this->width, this->height, OF_PIXELS_RGBA);
+        frames.getBuffer(i).pixels.set(0);
+    }
+    frameCount = 0;
+    lastTimestamp = 0;
+    
+    open = true;
+    startThread();
+    return true;
+}
+
+void CameraCapture::close() {
+    if (isThreadRunning()) {
+        stopThread();
+        waitForThread(false);
+    }
+    
+    if (source != nullptr) {
+        source->close();
+        delete source;
+        source = nullptr;
+    }
+    open = false;
+}
+
+bool CameraCapture::acquire() {
+    return frames.acquire();
+}
+
+void CameraCapture::threadedFunction() {
+    while (isThreadRunning()) {
+        source->update();
+        
+        if (!source->isFrameNew()) {
+            sleep(capturePollMillis);
+            continue;
+        }
+        
+        CameraFrame& frame = frames.getWriteBuffer();
+        convertToRGBA(source->getPixels(), frame.pixels);
+        frame.timestamp = ofGetElapsedTimeMicros();
+        frame.frameNumber = ++frameCount;
+        
+        // Smoothed capture interval, for pacing on the render side
+        if (lastTimestamp > 0) {
+            uint64_t interval = frame.timestamp - lastTimestamp;
+            frameInterval = (frameInterval * 7 + interval) / 8;
+        }
+        lastTimestamp = frame.timestamp;
+        
+        frames.publish();
+    }
+}
+
+void CameraCapture::convertToRGBA(const ofPixels& source, ofPixels& target) {
+    int sourceWidth = source.getWidth();
+    int sourceHeight = source.getHeight();
+    int channels = source.getNumChannels();
+    
+    if ((int)target.getWidth() != sourceWidth || (int)target.getHeight() != sourceHeight ||
+        target.getNumChannels() != 4) {
+        target.allocate(sourceWidth, sourceHeight, OF_PIXELS_RGBA);
+    }
+    
+    const unsigned char* in = source.getData();
+    unsigned char* out = target.getData();
+    size_t count = (size_t)sourceWidth * sourceHeight;
+    
+    if (channels == 4) {
+        memcpy(out, in, count * 4);
+    } else if (channels == 3) {
+        for (size_t i = 0; i < count; i++, in += 3, out += 4) {
+            out[0] = in[0];
+            out[1] = in[1];
+            out[2] = in[2];
+            out[3] = 255;
+        }
+    } else if (channels == 1) {
+        for (size_t i = 0; i < count; i++, in++, out += 4) {
+            out[0] = out[1] = out[2] = in[0];
+            out[3] = 255;
+        }
+    }
+}
@@ -0,0 +1,72 @@
+// File: src/Utils/CameraCapture.h
+#pragma once
+
+#include "ofMain.h"
+#include "TripleBuffer.h"
+#include "CameraSource.h"
+#include <atomic>
+
+// One captured camera frame, already converted to RGBA
+struct CameraFrame {
+    CameraFrame() {
+        timestamp = 0;
+        frameNumber = 0;
+    }
+    
+    ofPixels pixels;
+    
+    // ofGetElapsedTimeMicros() when the frame arrived
+    uint64_t timestamp;
+    
+    // Incremented by every captured frame
+    uint64_t frameNumber;
+};
+
+// Camera capture on a dedicated thread. The source is polled and its
+// frames are converted to RGBA off the render thread, then handed over
+// through a triple buffer, so the render thread never waits on the camera
+// and always has the newest complete frame to draw.
+class CameraCapture : public ofThread {
+public:
+    CameraCapture();
+    ~CameraCapture();
+    
+    // Open the source and start the capture thread. Takes ownership of
+    // source, which is deleted on close() or if it fails to open
+    bool setup(CameraSource* source, int width, int height, int frameRate);
+    void close();
+    bool isOpen() const { return open; }
+    
+    // Name of the open source, for the GUI
+    string getSourceName() const { return sourceName; }
+    
+    float getWidth() const { return width; }
+    float getHeight() const { return height; }
+    
+    // Render thread: take the newest captured frame. Returns false if
+    // nothing new arrived since the last call; getFrame() then still
+    // returns the previous frame
+    bool acquire();
+    const CameraFrame& getFrame() const { return frames.getReadBuffer(); }
+    
+    // Average time between captured frames, in microseconds
+    uint64_t getFrameInterval() const { return frameInterval; }
+    
+protected:
+    void threadedFunction() override;
+    
+private:
+    CameraSource* source;
+    string sourceName;
+    std::atomic<bool> open;
+    int width;
+    int height;
+    
+    TripleBuffer<CameraFrame> frames;
+    uint64_t frameCount;
+    uint64_t lastTimestamp;
+    std::atomic<uint64_t> frameInterval;
+    
+    // Copy grabber pixels into an RGBA frame
+    static void convertToRGBA(const ofPixels& source, ofPixels& target);
+};
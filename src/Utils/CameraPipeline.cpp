@@ -0,0 +1,371 @@
+// File: src/Utils/CameraPipeline.cpp
+#include "CameraPipeline.h"
+
+CameraPipeline::CameraPipeline() {
+    deviceId = -1;
+    requestedWidth = 640;
+    requestedHeight = 480;
+    frameRate = 30;
+    
+    x = 0.5;
+    y = 0.5;
+    scale = 1.0;
+    rotation = 0.0;
+    opacity = 1.0;
+    mirror = true;
+    visible = true;
+    
+    currentTexture = 0;
+    frameTimes[0] = frameTimes[1] = 0;
+    uploadedFrames = 0;
+    frameBlending = false;
+    
+    chromaKeyEnabled = false;
+    chromaColor = ofColor(0, 255, 0);  // Green
+    chromaTolerance = 0.4;
+    chromaSoftness = 0.1;
+    chromaSpill = 0.5;
+    keyedFrameNumber = 0;
+}
+
+CameraPipeline::~CameraPipeline() {
+    close();
+}
+
+bool CameraPipeline::setupDevice(int deviceId, int width, int height, int frameRate) {
+    this->deviceId = deviceId;
+    requestedWidth = width;
+    requestedHeight = height;
+    this->frameRate = frameRate;
+    uploadedFrames = 0;
+    keyedFrameNumber = 0;
+    
+    return capture.setup(new GrabberSource(deviceId), width, height, frameRate);
+}
+
+bool CameraPipeline::setupPattern(int width, int height, int frameRate) {
+    deviceId = -1;
+    requestedWidth = width;
+    requestedHeight = height;
+    this->frameRate = frameRate;
+    uploadedFrames = 0;
+    keyedFrameNumber = 0;
+    
+    return capture.setup(new PatternSource(), width, height, frameRate);
+}
+
+void CameraPipeline::close() {
+    capture.close();
+}
+
+const ofTexture* CameraPipeline::getTexture() {
+    if (!capture.isOpen() || uploadedFrames == 0) {
+        return nullptr;
+    }
+    return &cameraTextures[currentTexture];
+}
+
+void CameraPipeline::update(const AudioFrame& audio) {
+    if (!capture.isOpen()) return;
+    
+    // Pick up the newest frame from the capture thread
+    uploadCameraFrame();
+    
+    // Apply audio reactivity
+    applyAudioReactivity(audio);
+}
+
+void CameraPipeline::uploadCameraFrame() {
+    // Never waits: false just means the capture thread has nothing newer
+    if (!capture.acquire()) {
+        return;
+    }
+    
+    const CameraFrame& frame = capture.getFrame();
+    
+    // Upload into the older texture, which becomes the current one
+    currentTexture = 1 - currentTexture;
+    ofTexture& texture = cameraTextures[currentTexture];
+    if (!texture.isAllocated() ||
+        texture.getWidth() != frame.pixels.getWidth() ||
+        texture.getHeight() != frame.pixels.getHeight()) {
+        texture.allocate(frame.pixels);
+    }
+    texture.loadData(frame.pixels);
+    
+    frameTimes[currentTexture] = frame.timestamp;
+    uploadedFrames++;
+}
+
+void CameraPipeline::draw(int canvasWidth, int canvasHeight, ofShader& chromaKeyShader) {
+    // Redraw every frame, holding the latest camera frame between captures
+    if (!visible || !capture.isOpen() || uploadedFrames == 0) {
+        return;
+    }
+    
+    ofPushMatrix();
+    ofPushStyle();
+    
+    // Convert normalized coordinates to pixels
+    float pixelX = x * canvasWidth;
+    float pixelY = y * canvasHeight;
+    
+    // Calculate dimensions to maintain aspect ratio
+    float cameraWidth = capture.getWidth();
+    float cameraHeight = capture.getHeight();
+    float cameraRatio = cameraWidth / cameraHeight;
+    float screenRatio = (float)canvasWidth / canvasHeight;
+    
+    float drawWidth, drawHeight;
+    
+    if (cameraRatio > screenRatio) {
+        // Camera is wider than canvas - fit height
+        drawHeight = canvasHeight * scale;
+        drawWidth = drawHeight * cameraRatio;
+    } else {
+        // Camera is taller than canvas - fit width
+        drawWidth = canvasWidth * scale;
+        drawHeight = drawWidth / cameraRatio;
+    }
+    
+    // Apply transformations
+    ofTranslate(pixelX, pixelY);
+    ofRotateZDeg(ofRadToDeg(rotation));
+    
+    // Apply mirror if enabled
+    if (mirror) {
+        ofScale(-1, 1);
+    }
+    
+    // Set opacity
+    ofSetColor(255, 255, 255, opacity * 255);
+    
+    // Draw camera
+    if (chromaKeyEnabled) {
+        // Apply chroma key
+        applyChromaKey(drawWidth, drawHeight, chromaKeyShader);
+    } else {
+        // Draw normally
+        drawCameraFrame(drawWidth, drawHeight);
+    }
+    
+    ofPopStyle();
+    ofPopMatrix();
+}
+
+void CameraPipeline::drawCameraFrame(float drawWidth, float drawHeight) {
+    float left = -drawWidth / 2;
+    float top = -drawHeight / 2;
+    
+    if (!frameBlending || uploadedFrames < 2) {
+        cameraTextures[currentTexture].draw(left, top, drawWidth, drawHeight);
+        return;
+    }
+    
+    // Fade from the previous frame to the current one over one capture
+    // interval, starting when the current frame arrived
+    uint64_t now = ofGetElapsedTimeMicros();
+    uint64_t current = frameTimes[currentTexture];
+    uint64_t previous = frameTimes[1 - currentTexture];
+    uint64_t interval = current > previous ? current - previous : capture.getFrameInterval();
+    float blend = ofClamp((float)(now - current) / max(interval, (uint64_t)1), 0, 1);
+    
+    cameraTextures[1 - currentTexture].draw(left, top, drawWidth, drawHeight);
+    ofSetColor(255, 255, 255, opacity * blend * 255);
+    cameraTextures[currentTexture].draw(left, top, drawWidth, drawHeight);
+    ofSetColor(255, 255, 255, opacity * 255);
+}
+
+void CameraPipeline::applyChromaKey(float drawWidth, float drawHeight, ofShader& chromaKeyShader) {
+    if (chromaKeyShader.isLoaded()) {
+        // Key, spill suppression and edge softness in one pass
+        chromaKeyShader.begin();
+        chromaKeyShader.setUniform3f("chromaColor", chromaColor.r / 255.0, chromaColor.g / 255.0, chromaColor.b / 255.0);
+        chromaKeyShader.setUniform1f("tolerance", chromaTolerance);
+        chromaKeyShader.setUniform1f("softness", chromaSoftness);
+        chromaKeyShader.setUniform1f("spill", chromaSpill);
+        drawCameraFrame(drawWidth, drawHeight);
+        chromaKeyShader.end();
+        return;
+    }
+    
+    // Key the captured CPU pixels into the persistent buffers, once per
+    // camera frame; a held frame reuses the keyed texture
+    const CameraFrame& frame = capture.getFrame();
+    if (frame.frameNumber != keyedFrameNumber) {
+        chromaKey.setup(chromaColor, chromaTolerance, chromaSoftness, chromaSpill);
+        chromaKey.apply(frame.pixels, keyedPixels);
+        
+        if (!keyedTexture.isAllocated() ||
+            keyedTexture.getWidth() != keyedPixels.getWidth() ||
+            keyedTexture.getHeight() != keyedPixels.getHeight()) {
+            keyedTexture.allocate(keyedPixels);
+        }
+        keyedTexture.loadData(keyedPixels);
+        keyedFrameNumber = frame.frameNumber;
+    }
+    
+    // Draw texture
+    keyedTexture.draw(-drawWidth / 2, -drawHeight / 2, drawWidth, drawHeight);
+}
+
+void CameraPipeline::applyAudioReactivity(const AudioFrame& audio) {
+    // Example: Modulate scale with bass frequencies
+    float bassEnergy = audio.getBandEnergy(AUDIO_BAND_BASS);
+    
+    // Scale up temporarily with bass
+    scale = scale * 0.9 + (1.0 + bassEnergy * 0.2) * 0.1;
+    
+    // Rotate slightly with mid frequencies
+    float midEnergy = audio.getBandEnergy(AUDIO_BAND_MID);
+    rotation += (midEnergy - 0.5) * 0.01;
+    
+    // Ensure rotation stays in reasonable range
+    rotation = fmodf(rotation, TWO_PI);
+}
+
+bool CameraPipeline::setParameter(string name, float value) {
+    if (name == "x") {
+        x = ofClamp(value, 0, 1);
+        return true;
+    } else if (name == "y") {
+        y = ofClamp(value, 0, 1);
+        return true;
+    } else if (name == "scale") {
+        scale = ofClamp(value, 0.1, 3.0);
+        return true;
+    } else if (name == "rotation") {
+        rotation = value;
+        return true;
+    } else if (name == "opacity") {
+        opacity = ofClamp(value, 0, 1);
+        return true;
+    } else if (name == "mirror") {
+        mirror = value > 0.5;
+        return true;
+    } else if (name == "visible") {
+        visible = value > 0.5;
+        return true;
+    } else if (name == "frameBlending") {
+        frameBlending = value > 0.5;
+        return true;
+    } else if (name == "chromaKey") {
+        chromaKeyEnabled = value > 0.5;
+        return true;
+    } else if (name == "chromaTolerance") {
+        chromaTolerance = ofClamp(value, 0, 1);
+        return true;
+    } else if (name == "chromaSoftness") {
+        chromaSoftness = ofClamp(value, 0, 1);
+        return true;
+    } else if (name == "chromaSpill") {
+        chromaSpill = ofClamp(value, 0, 1);
+        return true;
+    }
+    
+    return false;
+}
+
+void CameraPipeline::savePreset(ofXml& xml) {
+    // Save source
+    xml.appendChild("device").set(ofToString(deviceId));
+    xml.appendChild("width").set(ofToString(requestedWidth));
+    xml.appendChild("height").set(ofToString(requestedHeight));
+    xml.appendChild("frameRate").set(ofToString(frameRate));
+    
+    // Save position and transform
+    xml.appendChild("x").set(ofToString(x));
+    xml.appendChild("y").set(ofToString(y));
+    xml.appendChild("scale").set(ofToString(scale));
+    xml.appendChild("rotation").set(ofToString(rotation));
+    xml.appendChild("opacity").set(ofToString(opacity));
+    xml.appendChild("mirror").set(ofToString(mirror));
+    xml.appendChild("visible").set(ofToString(visible));
+    xml.appendChild("frameBlending").set(ofToString(frameBlending));
+    
+    // Save chroma key settings
+    xml.appendChild("chromaKeyEnabled").set(ofToString(chromaKeyEnabled));
+    
+    ofXml chromaColorXml;
+    chromaColorXml.appendChild("r").set(ofToString(chromaColor.r));
+    chromaColorXml.appendChild("g").set(ofToString(chromaColor.g));
+    chromaColorXml.appendChild("b").set(ofToString(chromaColor.b));
+    xml.appendChild("chromaColor").appendChild(chromaColorXml);
+    
+    xml.appendChild("chromaTolerance").set(ofToString(chromaTolerance));
+    xml.appendChild("chromaSoftness").set(ofToString(chromaSoftness));
+    xml.appendChild("chromaSpill").set(ofToString(chromaSpill));
+}
+
+void CameraPipeline::loadPreset(ofXml& xml) {
+    // Load position and transform
+    auto xNode = xml.find("x");
+    if (xNode.size() > 0) {
+        setX(ofToFloat(xml.getChild("x").getValue()));
+    }
+    
+    auto yNode = xml.find("y");
+    if (yNode.size() > 0) {
+        setY(ofToFloat(xml.getChild("y").getValue()));
+    }
+    
+    auto scaleNode = xml.find("scale");
+    if (scaleNode.size() > 0) {
+        setScale(ofToFloat(xml.getChild("scale").getValue()));
+    }
+    
+    auto rotationNode = xml.find("rotation");
+    if (rotationNode.size() > 0) {
+        setRotation(ofToFloat(xml.getChild("rotation").getValue()));
+    }
+    
+    auto opacityNode = xml.find("opacity");
+    if (opacityNode.size() > 0) {
+        setOpacity(ofToFloat(xml.getChild("opacity").getValue()));
+    }
+    
+    auto mirrorNode = xml.find("mirror");
+    if (mirrorNode.size() > 0) {
+        setMirror(ofToBool(xml.getChild("mirror").getValue()));
+    }
+    
+    auto visibleNode = xml.find("visible");
+    if (visibleNode.size() > 0) {
+        setVisible(ofToBool(xml.getChild("visible").getValue()));
+    }
+    
+    auto frameBlendingNode = xml.find("frameBlending");
+    if (frameBlendingNode.size() > 0) {
+        setFrameBlending(ofToBool(xml.getChild("frameBlending").getValue()));
+    }
+    
+    // Load chroma key settings
+    auto chromaKeyNode = xml.find("chromaKeyEnabled");
+    if (chromaKeyNode.size() > 0) {
+        setChromaKey(ofToBool(xml.getChild("chromaKeyEnabled").getValue()));
+    }
+    
+    auto chromaColorNode = xml.find("chromaColor");
+    if (chromaColorNode.size() > 0) {
+        ofXml colorXml = xml.getChild("chromaColor");
+        int r = ofToInt(colorXml.getChild("r").getValue());
+        int g = ofToInt(colorXml.getChild("g").getValue());
+        int b = ofToInt(colorXml.getChild("b").getValue());
+        setChromaColor(ofColor(r, g, b));
+    }
+    
+    auto chromaToleranceNode = xml.find("chromaTolerance");
+    if (chromaToleranceNode.size() > 0) {
+        setChromaTolerance(ofToFloat(xml.getChild("chromaTolerance").getValue()));
+    }
+    
+    auto chromaSoftnessNode = xml.find("chromaSoftness");
+    if (chromaSoftnessNode.size() > 0) {
+        setChromaSoftness(ofToFloat(xml.getChild("chromaSoftness").getValue()));
+    }
+    
+    auto chromaSpillNode = xml.find("chromaSpill");
+    if (chromaSpillNode.size() > 0) {
+        setChromaSpill(ofToFloat(xml.getChild("chromaSpill").getValue()));
+    }
+}
@@ -0,0 +1,130 @@
+// File: src/Utils/CameraPipeline.h
+#pragma once
+
+#include "ofMain.h"
+#include "AudioFrame.h"
+#include "CameraCapture.h"
+#include "ChromaKey.h"
+
+// One camera in CameraLayer: its capture thread, the textures its frames
+// are uploaded to, and its own transform and chroma key settings
+class CameraPipeline {
+public:
+    CameraPipeline();
+    ~CameraPipeline();
+    
+    // Open a physical camera or a synthetic pattern and start capturing
+    bool setupDevice(int deviceId, int width, int height, int frameRate);
+    bool setupPattern(int width, int height, int frameRate);
+    void close();
+    bool isOpen() const { return capture.isOpen(); }
+    
+    // Device id, or -1 for a pattern source
+    int getDeviceId() const { return deviceId; }
+    int getRequestedWidth() const { return requestedWidth; }
+    int getRequestedHeight() const { return requestedHeight; }
+    int getFrameRate() const { return frameRate; }
+    string getName() const { return capture.getSourceName(); }
+    
+    // Render thread: upload the newest frame and apply audio reactivity
+    void update(const AudioFrame& audio);
+    
+    // Draw into the layer's FBO, keyed through chromaKeyShader when it is
+    // loaded or on the CPU otherwise
+    void draw(int canvasWidth, int canvasHeight, ofShader& chromaKeyShader);
+    
+    // Latest uploaded frame, or nullptr before the first one
+    const ofTexture* getTexture();
+    
+    // Transform
+    void setX(float x) { this->x = x; }
+    void setY(float y) { this->y = y; }
+    void setScale(float scale) { this->scale = scale; }
+    void setRotation(float rotation) { this->rotation = rotation; }
+    void setOpacity(float opacity) { this->opacity = opacity; }
+    void setMirror(bool mirror) { this->mirror = mirror; }
+    void setVisible(bool visible) { this->visible = visible; }
+    
+    float getX() { return x; }
+    float getY() { return y; }
+    float getScale() { return scale; }
+    float getRotation() { return rotation; }
+    float getOpacity() { return opacity; }
+    bool getMirror() { return mirror; }
+    bool isVisible() { return visible; }
+    
+    // Crossfade between the last two camera frames by capture time instead
+    // of holding each one. Smoother motion for one camera frame of latency
+    void setFrameBlending(bool enabled) { frameBlending = enabled; }
+    bool getFrameBlending() { return frameBlending; }
+    
+    // Chroma key settings
+    void setChromaKey(bool enabled) { chromaKeyEnabled = enabled; }
+    void setChromaColor(ofColor color) { chromaColor = color; }
+    void setChromaTolerance(float tolerance) { chromaTolerance = tolerance; }
+    void setChromaSoftness(float softness) { chromaSoftness = softness; }
+    void setChromaSpill(float spill) { chromaSpill = spill; }
+    
+    bool getChromaKey() { return chromaKeyEnabled; }
+    ofColor getChromaColor() { return chromaColor; }
+    float getChromaTolerance() { return chromaTolerance; }
+    float getChromaSoftness() { return chromaSoftness; }
+    float getChromaSpill() { return chromaSpill; }
+    
+    // Set parameter by name
+    bool setParameter(string name, float value);
+    
+    // Save and load settings, including the source
+    void savePreset(ofXml& xml);
+    void loadPreset(ofXml& xml);
+    
+private:
+    CameraCapture capture;
+    int deviceId;
+    int requestedWidth;
+    int requestedHeight;
+    int frameRate;
+    
+    // Position and transform
+    float x;
+    float y;
+    float scale;
+    float rotation;
+    float opacity;
+    bool mirror;
+    bool visible;
+    
+    // The last two captured frames, uploaded on the render thread, and
+    // their capture times
+    ofTexture cameraTextures[2];
+    int currentTexture;
+    uint64_t frameTimes[2];
+    int uploadedFrames;
+    bool frameBlending;
+    
+    // Chroma key settings
+    bool chromaKeyEnabled;
+    ofColor chromaColor;
+    float chromaTolerance;
+    float chromaSoftness;
+    float chromaSpill;
+    
+    // CPU fallback when the shader is unavailable, keying captured
+    // pixels into persistent buffers
+    ChromaKey chromaKey;
+    ofPixels keyedPixels;
+    ofTexture keyedTexture;
+    uint64_t keyedFrameNumber;
+    
+    // Upload the newest captured frame, if any
+    void uploadCameraFrame();
+    
+    // Draw the current frame, blended with the previous one if enabled
+    void drawCameraFrame(float drawWidth, float drawHeight);
+    
+    // Draw the camera with chroma keying applied
+    void applyChromaKey(float drawWidth, float drawHeight, ofShader& chromaKeyShader);
+    
+    // Apply audio reactivity
+    void applyAudioReactivity(const AudioFrame& audio);
+};
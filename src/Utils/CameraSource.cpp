@@ -0,0 +1,105 @@
+// File: src/Utils/CameraSource.cpp
+#include "CameraSource.h"
+
+GrabberSource::GrabberSource(int deviceId) {
+    this->deviceId = deviceId;
+}
+
+GrabberSource::~GrabberSource() {
+    close();
+}
+
+bool GrabberSource::setup(int width, int height, int frameRate) {
+    // Pixels only: textures are uploaded by the render thread
+    grabber.setDeviceID(deviceId);
+    grabber.setDesiredFrameRate(frameRate);
+    grabber.setPixelFormat(OF_PIXELS_RGB);
+    return grabber.setup(width, height, false);
+}
+
+void GrabberSource::close() {
+    if (grabber.isInitialized()) {
+        grabber.close();
+    }
+}
+
+void GrabberSource::update() {
+    grabber.update();
+}
+
+PatternSource::PatternSource() {
+    frameInterval = 33333;
+    nextFrameTime = 0;
+    frameCount = 0;
+    frameNew = false;
+}
+
+bool PatternSource::setup(int width, int height, int frameRate) {
+    if (width <= 0 || height <= 0 || frameRate <= 0) {
+        ofLogError("PatternSource") << "Invalid pattern size " << width << "x" << height << " at " << frameRate << " fps";
+        return false;
+    }
+    
+    pixels.allocate(width, height, OF_PIXELS_RGB);
+    barRow.resize(width * 3);
+    frameInterval = 1000000 / frameRate;
+    nextFrameTime = 0;
+    frameCount = 0;
+    frameNew = false;
+    return true;
+}
+
+void PatternSource::close() {
+    pixels.clear();
+}
+
+void PatternSource::update() {
+    frameNew = false;
+    if (!pixels.isAllocated()) return;
+    
+    // Pace frames like a real device, without drifting
+    uint64_t now = ofGetElapsedTimeMicros();
+    if (now < nextFrameTime) return;
+    nextFrameTime = nextFrameTime == 0 ? now + frameInterval : max(nextFrameTime + frameInterval, now);
+    
+    renderFrame();
+    frameCount++;
+    frameNew = true;
+}
+
+void PatternSource::renderFrame() {
+    int width = pixels.getWidth();
+    int height = pixels.getHeight();
+    unsigned char* data = pixels.getData();
+    
+    // Hue bars scrolling one bar per second at 30 fps
+    int barWidth = max(1, width / 8);
+    int scroll = frameCount * barWidth / 30;
+    unsigned char* row = barRow.data();
+    for (int x = 0; x < width; x++) {
+        int bar = ((x + scroll) / barWidth) % 8;
+        ofColor color = ofColor::fromHsb(bar * 32, 200, 220);
+        row[x * 3] = color.r;
+        row[x * 3 + 1] = color.g;
+        row[x * 3 + 2] = color.b;
+    }
+    for (int y = 0; y < height; y++) {
+        unsigned char* out = data + (size_t)y * width * 3;
+        memcpy(out, row, width * 3);
+    }
+    
+    // Pure green box bouncing between the edges, for chroma key checks
+    int boxSize = max(1, min(width, height) / 4);
+    int rangeX = max(1, width - boxSize);
+    int rangeY = max(1, height - boxSize);
+    int boxX = abs((frameCount * 4) % (2 * rangeX) - rangeX);
+    int boxY = abs((frameCount * 3) % (2 * rangeY) - rangeY);
+    for (int y = boxY; y < min(boxY + boxSize, height); y++) {
+        unsigned char* out = data + ((size_t)y * width + boxX) * 3;
+        for (int x = 0; x < min(boxSize, width - boxX); x++, out += 3) {
+            out[0] = 0;
+            out[1] = 255;
+            out[2] = 0;
+        }
+    }
+}
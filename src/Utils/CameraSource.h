@@ -0,0 +1,76 @@
+// File: src/Utils/CameraSource.h
+#pragma once
+
+#include "ofMain.h"
+
+// A device that delivers CPU frames to a CameraCapture thread.
+// All methods except the constructor are called from the capture thread
+// once it is running.
+class CameraSource {
+public:
+    virtual ~CameraSource() {}
+    
+    // Open at the requested size and rate; the actual size may differ
+    virtual bool setup(int width, int height, int frameRate) = 0;
+    virtual void close() = 0;
+    
+    // Poll for a frame; isFrameNew() reports whether this call got one
+    virtual void update() = 0;
+    virtual bool isFrameNew() = 0;
+    virtual const ofPixels& getPixels() = 0;
+    
+    virtual int getWidth() = 0;
+    virtual int getHeight() = 0;
+    
+    // Shown in the GUI
+    virtual string getName() = 0;
+};
+
+// A physical camera through ofVideoGrabber, pixels only
+class GrabberSource : public CameraSource {
+public:
+    GrabberSource(int deviceId);
+    ~GrabberSource();
+    
+    bool setup(int width, int height, int frameRate) override;
+    void close() override;
+    void update() override;
+    bool isFrameNew() override { return grabber.isFrameNew(); }
+    const ofPixels& getPixels() override { return grabber.getPixels(); }
+    int getWidth() override { return grabber.getWidth(); }
+    int getHeight() override { return grabber.getHeight(); }
+    string getName() override { return "Camera " + ofToString(deviceId); }
+    
+    int getDeviceId() const { return deviceId; }
+    
+private:
+    ofVideoGrabber grabber;
+    int deviceId;
+};
+
+// Synthetic camera source: scrolling hue bars with a bouncing pure green
+// box, produced at the requested frame rate. For running and keying
+// without a camera attached.
+class PatternSource : public CameraSource {
+public:
+    PatternSource();
+    
+    bool setup(int width, int height, int frameRate) override;
+    void close() override;
+    void update() override;
+    bool isFrameNew() override { return frameNew; }
+    const ofPixels& getPixels() override { return pixels; }
+    int getWidth() override { return pixels.getWidth(); }
+    int getHeight() override { return pixels.getHeight(); }
+    string getName() override { return "Pattern"; }
+    
+private:
+    ofPixels pixels;
+    vector<unsigned char> barRow;
+    uint64_t frameInterval;
+    uint64_t nextFrameTime;
+    int frameCount;
+    bool frameNew;
+    
+    void renderFrame();
+};
@@ -0,0 +1,136 @@
+// File: src/Utils/ChromaKey.cpp
+#include "ChromaKey.h"
+#include "ParallelFor.h"
+
+// Largest squared distance between two RGB colors
+static const int maxDistanceSquared = 3 * 255 * 255;
+
+// Pixels per ParallelFor task, so small frames stay on one thread
+static const int chromaKeyBlockSize = 16384;
+
+// Fixed point for spill suppression. Directions are scaled by 2^10 and the
+// per-channel spill factors by 2^22 / (3 * 2^10), so one shift undoes both
+// and the products stay inside 32 bits
+static const int directionScale = 1 << 10;
+static const int spillShift = 22;
+static const int spillRound = 1 << (spillShift - 1);
+
+ChromaKey::ChromaKey() {
+    tolerance = 0;
+    softness = 0;
+    spill = 0;
+    configured = false;
+    spillDirection[0] = spillDirection[1] = spillDirection[2] = 0;
+    spillDirectionFixed[0] = spillDirectionFixed[1] = spillDirectionFixed[2] = 0;
+    spillFixed[0] = spillFixed[1] = spillFixed[2] = 0;
+}
+
+void ChromaKey::setup(const ofColor& keyColor, float tolerance, float softness, float spill) {
+    if (configured && keyColor == this->keyColor && tolerance == this->tolerance &&
+        softness == this->softness && spill == this->spill) {
+        return;
+    }
+    
+    this->keyColor = keyColor;
+    this->tolerance = tolerance;
+    this->softness = softness;
+    this->spill = spill;
+    configured = true;
+    
+    // Alpha ramps smoothly from 0 at the tolerance to 1 at tolerance + softness,
+    // with distance normalized to 0-1 like the shader
+    alphaTable.resize(maxDistanceSquared + 1);
+    float edge = max(softness, 0.0001f);
+    for (int d2 = 0; d2 <= maxDistanceSquared; d2++) {
+        float distance = sqrtf((float)d2 / maxDistanceSquared);
+        float t = ofClamp((distance - tolerance) / edge, 0, 1);
+        alphaTable[d2] = (unsigned char)(t * t * (3.0f - 2.0f * t) * 255.0f + 0.5f);
+    }
+    
+    // Key chroma: the key color minus its mean, normalized
+    float mean = (keyColor.r + keyColor.g + keyColor.b) / 3.0f;
+    float dr = keyColor.r - mean;
+    float dg = keyColor.g - mean;
+    float db = keyColor.b - mean;
+    float length = sqrtf(dr * dr + dg * dg + db * db);
+    if (length > 0.0001f) {
+        spillDirection[0] = dr / length;
+        spillDirection[1] = dg / length;
+        spillDirection[2] = db / length;
+    } else {
+        spillDirection[0] = spillDirection[1] = spillDirection[2] = 0;
+    }
+    
+    for (int i = 0; i < 3; i++) {
+        spillDirectionFixed[i] = (int)roundf(spillDirection[i] * directionScale);
+        spillFixed[i] = (int)roundf(spillDirection[i] * spill * (1 << spillShift) / (3.0f * directionScale));
+    }
+}
+
+void ChromaKey::apply(const unsigned char* src, int srcChannels, unsigned char* dst, int numPixels) const {
+    if (!configured || numPixels <= 0) return;
+    
+    int numBlocks = (numPixels + chromaKeyBlockSize - 1) / chromaKeyBlockSize;
+    ParallelFor::run(numBlocks, [&](int begin, int end) {
+        int first = begin * chromaKeyBlockSize;
+        int last = min(end * chromaKeyBlockSize, numPixels);
+        
+        // Copy everything the loop reads into locals: stores through dst
+        // may alias anything, which would force a reload per pixel
+        const unsigned char* table = alphaTable.data();
+        const int keyR = keyColor.r;
+        const int keyG = keyColor.g;
+        const int keyB = keyColor.b;
+        const int dirR = spillDirectionFixed[0];
+        const int dirG = spillDirectionFixed[1];
+        const int dirB = spillDirectionFixed[2];
+        const int spillR = spillFixed[0];
+        const int spillG = spillFixed[1];
+        const int spillB = spillFixed[2];
+        const int channels = srcChannels;
+        const bool hasAlpha = channels == 4;
+        const unsigned char* in = src + (size_t)first * channels;
+        unsigned char* out = dst + (size_t)first * 4;
+        
+        for (int i = first; i < last; i++, in += channels, out += 4) {
+            int r = in[0];
+            int g = in[1];
+            int b = in[2];
+            int a = hasAlpha ? in[3] : 255;
+            
+            // Alpha from the distance to the key color
+            int dr = r - keyR;
+            int dg = g - keyG;
+            int db = b - keyB;
+            int keyAlpha = table[dr * dr + dg * dg + db * db];
+            
+            // Remove the chroma component along the key direction. Chroma
+            // is taken as 3 * (c - mean) to stay in integers
+            int sum = r + g + b;
+            int amount = (3 * r - sum) * dirR + (3 * g - sum) * dirG + (3 * b - sum) * dirB;
+            amount = std::max(amount, 0);
+            int outR = r - ((amount * spillR + spillRound) >> spillShift);
+            int outG = g - ((amount * spillG + spillRound) >> spillShift);
+            int outB = b - ((amount * spillB + spillRound) >> spillShift);
+            
+            out[0] = (unsigned char)std::min(std::max(outR, 0), 255);
+            out[1] = (unsigned char)std::min(std::max(outG, 0), 255);
+            out[2] = (unsigned char)std::min(std::max(outB, 0), 255);
+            out[3] = (unsigned char)((a * keyAlpha + 127) / 255);
+        }
+    });
+}
+
+void ChromaKey::apply(const ofPixels& src, ofPixels& dst) const {
+    int channels = src.getNumChannels();
+    if (channels != 3 && channels != 4) {
+        ofLogError("ChromaKey") << "Unsupported pixel format with " << channels << " channels";
+        return;
+    }
+    
+    if (dst.getWidth() != src.getWidth() || dst.getHeight() != src.getHeight() || dst.getNumChannels() != 4) {
+        dst.allocate(src.getWidth(), src.getHeight(), OF_PIXELS_RGBA);
+    }
+    
+    apply(src.getData(), channels, dst.getData(), (int)(src.getWidth() * src.getHeight()));
+}
@@ -0,0 +1,43 @@
+// File: src/Utils/ChromaKey.h
+#pragma once
+
+#include "ofMain.h"
+
+// CPU chroma key, the fallback for shaders/chromakey.frag and matching it.
+// Keyed alpha comes from a table indexed by the squared RGB distance to the
+// key color, so the per-pixel loop is a table lookup and straight-line
+// integer math with no branches. Spill is removed by subtracting the part of
+// each pixel's chroma that points along the key's chroma.
+class ChromaKey {
+public:
+    ChromaKey();
+    
+    // Set key parameters; the alpha table is only rebuilt when they change.
+    // tolerance and softness are fractions of the largest RGB distance,
+    // spill is 0 (off) to 1 (full suppression)
+    void setup(const ofColor& keyColor, float tolerance, float softness, float spill);
+    
+    // Key numPixels pixels from src (3 or 4 channels) into RGBA dst.
+    // src may equal dst when it has 4 channels, keying in place
+    void apply(const unsigned char* src, int srcChannels, unsigned char* dst, int numPixels) const;
+    
+    // Key RGB or RGBA pixels into dst, allocating dst only on a size change
+    void apply(const ofPixels& src, ofPixels& dst) const;
+    
+private:
+    ofColor keyColor;
+    float tolerance;
+    float softness;
+    float spill;
+    bool configured;
+    
+    // Alpha 0-255 indexed by dr*dr + dg*dg + db*db
+    vector<unsigned char> alphaTable;
+    
+    // Unit chroma direction of the key color, zero for a gray key
+    float spillDirection[3];
+    
+    // The same direction and the spill-scaled direction in fixed point
+    int spillDirectionFixed[3];
+    int spillFixed[3];
+};
@@ -0,0 +1,52 @@
+// File: src/Utils/CircularBuffer.h
+#pragma once
+
+#include "ofMain.h"
+
+// Fixed-capacity history buffer. Storage is allocated once in setup();
+// push() overwrites the oldest entry once full, so it never allocates.
+// Indexing runs from the oldest entry (0) to the newest (size() - 1).
+template<typename T>
+class CircularBuffer {
+public:
+    CircularBuffer() : head(0), count(0) {}
+
+    void setup(size_t capacity) {
+        buffer.assign(std::max<size_t>(1, capacity), T());
+        clear();
+    }
+
+    void clear() {
+        head = 0;
+        count = 0;
+    }
+
+    void push(const T& value) {
+        buffer[head] = value;
+        head = (head + 1) % buffer.size();
+        if (count < buffer.size()) {
+            count++;
+        }
+    }
+
+    T& operator[](size_t index) {
+        return buffer[(head + buffer.size() - count + index) % buffer.size()];
+    }
+
+    const T& operator[](size_t index) const {
+        return buffer[(head + buffer.size() - count + index) % buffer.size()];
+    }
+
+    T& front() { return (*this)[0]; }
+    T& back() { return (*this)[count - 1]; }
+
+    size_t size() const { return count; }
+    size_t capacity() const { return buffer.size(); }
+    bool empty() const { return count == 0; }
+    bool full() const { return count == buffer.size(); }
+
+private:
+    vector<T> buffer;
+    size_t head;
+    size_t count;
+};
@@ -18,61 +18,54 @@ void Effect::setup(int width, int height) {
     this->height = height;
 }
 
-void Effect::update(float phase, float* audioData, int numBands, map<string, float>& globalParams) {
+void Effect::update(const AudioFrame& audio, map<string, float>& globalParams) {
     // Base implementation does nothing
     // This should be overridden by derived classes
 }
 
-bool Effect::setParameter(string name, float value) {
+bool Effect::setParameter(const string& name, float value) {
     // Check if parameter exists
-    if (params.find(name) != params.end()) {
-        params[name] = value;
+    int handle = findParameter(name);
+    if (handle >= 0) {
+        paramValues[handle] = value;
         return true;
     }
     return false;
 }
 
-float Effect::getParameter(string name) {
+float Effect::getParameter(const string& name) {
     // Check if parameter exists
-    if (params.find(name) != params.end()) {
-        return params[name];
+    int handle = findParameter(name);
+    if (handle >= 0) {
+        return paramValues[handle];
     }
     return 0.0f;
 }
 
-void Effect::ensureParameter(string name, float defaultValue) {
-    // Create parameter if it doesn't exist
-    if (params.find(name) == params.end()) {
-        params[name] = defaultValue;
+int Effect::findParameter(const string& name) {
+    // A handful of parameters per effect; a linear scan beats a map
+    for (int i = 0; i < (int)paramNames.size(); i++) {
+        if (paramNames[i] == name) {
+            return i;
+        }
     }
+    return -1;
 }
 
-float Effect::getAudioEnergy(float* audioData, int numBands, string range) {
-    if (audioData == nullptr || numBands <= 0) {
-        return 0.0;
-    }
-    
-    int startBin = 0;
-    int endBin = numBands - 1;
-    
-    // Map frequency ranges to different parts of the spectrum
-    if (range == "bass") {
-        endBin = numBands / 4;
-    } else if (range == "mid") {
-        startBin = numBands / 4;
-        endBin = numBands * 3 / 4;
-    } else if (range == "high") {
-        startBin = numBands * 3 / 4;
-    }
-    
-    // Calculate energy in the selected range
-    float sum = 0.0;
-    for (int i = startBin; i <= endBin; i++) {
-        sum += audioData[i];
+int Effect::addParameter(const string& name, float defaultValue) {
+    // Create parameter if it doesn't exist
+    int handle = findParameter(name);
+    if (handle < 0) {
+        handle = (int)paramValues.size();
+        paramNames.push_back(name);
+        paramValues.push_back(defaultValue);
     }
-    
-    // Normalize by number of bands
-    return sum / (endBin - startBin + 1);
+    return handle;
+}
+
+float Effect::getAudioEnergy(const AudioFrame& audio, AudioBand band) {
+    // Bands are reduced once per frame by AudioAnalyzer
+    return audio.bandLevels[band];
 }
 
 // Fixed savePreset method for Effect.cpp
@@ -83,8 +76,8 @@ void Effect::savePreset(ofXml& xml) {
     
     // Save parameters
     ofXml paramsXml;
-    for (auto& param : params) {
-        paramsXml.appendChild(param.first).set(ofToString(param.second));
+    for (int i = 0; i < (int)paramValues.size(); i++) {
+        paramsXml.appendChild(paramNames[i]).set(ofToString(paramValues[i]));
     }
     xml.appendChild("parameters").appendChild(paramsXml);
 }
@@ -113,10 +106,8 @@ void Effect::loadPreset(ofXml& xml) {
             string paramName = paramNode.getName();
             float paramValue = ofToFloat(paramNode.getValue());
             
-            // Only set if the parameter exists in our map
-            if (params.find(paramName) != params.end()) {
-                params[paramName] = paramValue;
-            }
+            // Only set if the parameter is declared
+            setParameter(paramName, paramValue);
         }
     }
 }
\ No newline at end of file
@@ -2,6 +2,7 @@
 #pragma once
 
 #include "ofMain.h"
+#include "AudioFrame.h"
 
 class Effect {
 public:
@@ -12,11 +13,28 @@ public:
     virtual void setup(int width, int height);
     
     // Update the effect parameters
-    virtual void update(float phase, float* audioData, int numBands, map<string, float>& globalParams);
+    virtual void update(const AudioFrame& audio, map<string, float>& globalParams);
     
-    // Apply the effect to an input FBO
+    // Draw the effect applied to inputFbo into the currently bound target.
+    // FXLayer binds a target that is never inputFbo
     virtual void apply(ofFbo& inputFbo) = 0;
     
+    // Effects whose result is also their state render into an FBO they
+    // own instead, which the chain then reads directly. Returns that FBO,
+    // or nullptr to have FXLayer bind a target and call apply()
+    virtual ofFbo* applyToOwnFbo(ofFbo& inputFbo) { return nullptr; }
+    
+    // Shader fusion. A fusable effect is a pure per-pixel stage that
+    // ShaderFusion can merge with its neighbours into one pass. Its stage
+    // source declares uniforms and defines two functions, with every name
+    // starting with the '$' placeholder that is replaced by a unique prefix:
+    //   vec2 $uv(vec2 uv)                 - where to sample the stage input
+    //   vec4 $color(vec4 color, vec2 uv)  - color of the input at that uv
+    // tex0 and texCoordVarying are not available to stages
+    virtual bool isFusable() { return false; }
+    virtual string getStageSource() { return ""; }
+    virtual void setStageUniforms(ofShader& shader, const string& prefix) {}
+    
     // Get effect name
     string getName() { return name; }
     
@@ -28,11 +46,18 @@ public:
     float getIntensity() { return intensity; }
     void setIntensity(float intensity) { this->intensity = ofClamp(intensity, 0, 1); }
     
-    // Set parameter value
-    virtual bool setParameter(string name, float value);
+    // Set parameter value by name, for presets and the GUI
+    virtual bool setParameter(const string& name, float value);
+    
+    // Get parameter value by name, for presets and the GUI
+    virtual float getParameter(const string& name);
     
-    // Get parameter value
-    virtual float getParameter(string name);
+    // Parameters in declaration order
+    int getNumParameters() { return (int)paramValues.size(); }
+    const string& getParameterName(int handle) { return paramNames[handle]; }
+    
+    // Handle of a named parameter, or -1
+    int findParameter(const string& name);
     
     // Save/load preset
     virtual void savePreset(ofXml& xml);
@@ -45,12 +70,18 @@ protected:
     
     int width, height;
     
-    // Effect parameters
-    map<string, float> params;
+    // Effect parameters, stored densely and addressed by handle.
+    // Handles are indices, stable once declared
+    vector<string> paramNames;
+    vector<float> paramValues;
+    
+    // Declare a parameter and return its handle. Declaring an existing
+    // name returns the existing handle
+    int addParameter(const string& name, float defaultValue);
     
-    // Create parameter if it doesn't exist
-    void ensureParameter(string name, float defaultValue);
+    // Hot-path access by handle
+    float& param(int handle) { return paramValues[handle]; }
     
-    // Utility to get audio energy in a frequency range
-    float getAudioEnergy(float* audioData, int numBands, string range);
+    // Utility to get audio energy in a frequency band
+    float getAudioEnergy(const AudioFrame& audio, AudioBand band);
 };
\ No newline at end of file
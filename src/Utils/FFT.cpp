@@ -0,0 +1,146 @@
+// File: src/Utils/FFT.cpp
+#include "FFT.h"
+
+FFT::FFT() {
+    size = 0;
+    half = 0;
+    amplitudeScale = 0;
+}
+
+FFT::~FFT() {
+    // Clean up resources
+}
+
+bool FFT::setup(int size) {
+    // process() reads exactly size samples, so the size must already be a
+    // power of two; rounding it would over- or under-read the caller's buffer
+    if (!isPowerOfTwo(size)) {
+        ofLogError("FFT") << "Size " << size << " is not a power of two of at least 4";
+        this->size = 0;
+        half = 0;
+        return false;
+    }
+
+    this->size = size;
+    half = this->size / 2;
+
+    // Hann window
+    window.resize(this->size);
+    float windowSum = 0;
+    for (int i = 0; i < this->size; i++) {
+        window[i] = 0.5 * (1 - cos(TWO_PI * i / (this->size - 1)));
+        windowSum += window[i];
+    }
+
+    // Single-sided amplitude normalization for the windowed signal
+    amplitudeScale = 2.0f / windowSum;
+
+    // Bit-reversal table for the half-size transform
+    int bits = 0;
+    while ((1 << bits) < half) {
+        bits++;
+    }
+    bitReverse.resize(half);
+    for (int i = 0; i < half; i++) {
+        int reversed = 0;
+        for (int b = 0; b < bits; b++) {
+            reversed |= ((i >> b) & 1) << (bits - 1 - b);
+        }
+        bitReverse[i] = reversed;
+    }
+
+    // Stage twiddles: for a butterfly span of len, entries exp(-2*pi*i*j/len)
+    stageTwiddleRe.clear();
+    stageTwiddleIm.clear();
+    for (int len = 2; len <= half; len <<= 1) {
+        int halfLen = len / 2;
+        for (int j = 0; j < halfLen; j++) {
+            double angle = -TWO_PI * j / len;
+            stageTwiddleRe.push_back(cos(angle));
+            stageTwiddleIm.push_back(sin(angle));
+        }
+    }
+
+    // Split-step twiddles
+    splitTwiddleRe.resize(half);
+    splitTwiddleIm.resize(half);
+    for (int k = 0; k < half; k++) {
+        double angle = -TWO_PI * k / this->size;
+        splitTwiddleRe[k] = cos(angle);
+        splitTwiddleIm[k] = sin(angle);
+    }
+
+    // Working buffers
+    re.assign(half, 0);
+    im.assign(half, 0);
+    return true;
+}
+
+void FFT::process(const float* input, float* magnitudes) {
+    if (half == 0) return;
+
+    // Window and pack even/odd samples as real/imaginary parts,
+    // scattering straight into bit-reversed order
+    const float* w = window.data();
+    for (int n = 0; n < half; n++) {
+        int target = bitReverse[n];
+        re[target] = input[2 * n] * w[2 * n];
+        im[target] = input[2 * n + 1] * w[2 * n + 1];
+    }
+
+    transform();
+
+    // Split the half-size complex result into the real spectrum.
+    // DC is purely real: X[0] = Re(Z[0]) + Im(Z[0])
+    magnitudes[0] = fabsf(re[0] + im[0]) * amplitudeScale * 0.5f;
+
+    const float* cr = splitTwiddleRe.data();
+    const float* ci = splitTwiddleIm.data();
+    for (int k = 1; k < half; k++) {
+        int m = half - k;
+
+        // Even and odd sub-spectra
+        float evenRe = 0.5f * (re[k] + re[m]);
+        float evenIm = 0.5f * (im[k] - im[m]);
+        float oddRe = 0.5f * (im[k] + im[m]);
+        float oddIm = -0.5f * (re[k] - re[m]);
+
+        float xr = evenRe + cr[k] * oddRe - ci[k] * oddIm;
+        float xi = evenIm + cr[k] * oddIm + ci[k] * oddRe;
+
+        magnitudes[k] = sqrtf(xr * xr + xi * xi) * amplitudeScale;
+    }
+}
+
+void FFT::transform() {
+    float* r = re.data();
+    float* i = im.data();
+    const float* twiddleRe = stageTwiddleRe.data();
+    const float* twiddleIm = stageTwiddleIm.data();
+
+    // Iterative radix-2 decimation in time; input is already bit-reversed
+    for (int len = 2; len <= half; len <<= 1) {
+        int halfLen = len / 2;
+
+        for (int start = 0; start < half; start += len) {
+            float* aRe = r + start;
+            float* aIm = i + start;
+            float* bRe = aRe + halfLen;
+            float* bIm = aIm + halfLen;
+
+            // Contiguous butterflies over j so the loop vectorizes
+            for (int j = 0; j < halfLen; j++) {
+                float tr = bRe[j] * twiddleRe[j] - bIm[j] * twiddleIm[j];
+                float ti = bRe[j] * twiddleIm[j] + bIm[j] * twiddleRe[j];
+                bRe[j] = aRe[j] - tr;
+                bIm[j] = aIm[j] - ti;
+                aRe[j] += tr;
+                aIm[j] += ti;
+            }
+        }
+
+        // Advance to this stage's successor in the twiddle table
+        twiddleRe += halfLen;
+        twiddleIm += halfLen;
+    }
+}
@@ -0,0 +1,54 @@
+// File: src/Utils/FFT.h
+#pragma once
+
+#include "ofMain.h"
+
+// Real-input FFT with precomputed window and twiddle tables.
+// A size-point real transform is computed as a size/2-point complex
+// radix-2 transform followed by a split step, all in place on
+// preallocated split-complex buffers so the inner loops stay contiguous.
+class FFT {
+public:
+    FFT();
+    ~FFT();
+
+    // Allocate tables and buffers for a power-of-two transform size.
+    // Any other size is rejected and leaves process() a no-op
+    bool setup(int size);
+
+    static bool isPowerOfTwo(int size) { return size >= 4 && (size & (size - 1)) == 0; }
+
+    // Window and transform `size` samples, writing size / 2 magnitudes.
+    // Magnitudes are amplitude-normalized so a full-scale sine reads 1.0
+    void process(const float* input, float* magnitudes);
+
+    int getSize() const { return size; }
+    int getNumBins() const { return half; }
+    const float* getWindow() const { return window.data(); }
+
+private:
+    int size;
+    int half;
+    float amplitudeScale;
+
+    // Hann window, applied while packing the input
+    vector<float> window;
+
+    // Bit-reversal permutation for the half-size complex transform
+    vector<int> bitReverse;
+
+    // Per-stage twiddles laid out contiguously, stage after stage
+    vector<float> stageTwiddleRe;
+    vector<float> stageTwiddleIm;
+
+    // Twiddles for the real split step, exp(-2*pi*i*k/size)
+    vector<float> splitTwiddleRe;
+    vector<float> splitTwiddleIm;
+
+    // Split-complex working buffers
+    vector<float> re;
+    vector<float> im;
+
+    // In-place complex transform of re/im
+    void transform();
+};
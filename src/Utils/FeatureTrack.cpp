@@ -0,0 +1,130 @@
+// File: src/Utils/FeatureTrack.cpp
+#include "FeatureTrack.h"
+#include <fstream>
+
+static const char featureTrackMagic[4] = { 'M', 'S', 'F', 'T' };
+static const uint32_t featureTrackVersion = 2;
+
+// Fixed-size header; fields are written in host byte order
+struct FeatureTrackHeader {
+    char magic[4];
+    uint32_t version;
+    uint32_t sampleRate;
+    uint32_t hopSize;
+    uint32_t bufferSize;
+    uint32_t numBins;
+    uint32_t numFrames;
+    float minDecibels;
+    uint64_t numSamples;
+    int64_t sourceModifiedTime;
+};
+
+FeatureTrack::FeatureTrack() {
+    clear();
+}
+
+void FeatureTrack::setup(int sampleRate, int hopSize, int bufferSize, int numBins, int numFrames, uint64_t numSamples) {
+    this->sampleRate = sampleRate;
+    this->hopSize = hopSize;
+    this->bufferSize = bufferSize;
+    this->numBins = numBins;
+    this->numFrames = numFrames;
+    this->numSamples = numSamples;
+
+    spectrum.assign((size_t)numFrames * numBins, 0);
+    bpms.assign(numFrames, 0);
+    phases.assign(numFrames, 0);
+    confidences.assign(numFrames, 0);
+    frameFlags.assign(numFrames, 0);
+}
+
+void FeatureTrack::setSource(int64_t modifiedTime, float minDecibels) {
+    sourceModifiedTime = modifiedTime;
+    this->minDecibels = minDecibels;
+}
+
+void FeatureTrack::clear() {
+    sampleRate = 0;
+    hopSize = 0;
+    bufferSize = 0;
+    numBins = 0;
+    numFrames = 0;
+    numSamples = 0;
+    sourceModifiedTime = 0;
+    minDecibels = 0;
+
+    spectrum.clear();
+    bpms.clear();
+    phases.clear();
+    confidences.clear();
+    frameFlags.clear();
+}
+
+bool FeatureTrack::save(const string& path) const {
+    std::ofstream file(ofToDataPath(path), std::ios::binary);
+    if (!file) {
+        ofLogError("FeatureTrack") << "Could not write " << path;
+        return false;
+    }
+
+    FeatureTrackHeader header;
+    memcpy(header.magic, featureTrackMagic, 4);
+    header.version = featureTrackVersion;
+    header.sampleRate = sampleRate;
+    header.hopSize = hopSize;
+    header.bufferSize = bufferSize;
+    header.numBins = numBins;
+    header.numFrames = numFrames;
+    header.minDecibels = minDecibels;
+    header.numSamples = numSamples;
+    header.sourceModifiedTime = sourceModifiedTime;
+
+    file.write((const char*)&header, sizeof(header));
+    file.write((const char*)spectrum.data(), spectrum.size());
+    file.write((const char*)bpms.data(), bpms.size() * sizeof(float));
+    file.write((const char*)phases.data(), phases.size() * sizeof(float));
+    file.write((const char*)confidences.data(), confidences.size() * sizeof(float));
+    file.write((const char*)frameFlags.data(), frameFlags.size());
+
+    if (!file) {
+        ofLogError("FeatureTrack") << "Failed while writing " << path;
+        return false;
+    }
+    return true;
+}
+
+bool FeatureTrack::load(const string& path) {
+    clear();
+
+    std::ifstream file(ofToDataPath(path), std::ios::binary);
+    if (!file) {
+        return false;
+    }
+
+    FeatureTrackHeader header;
+    if (!file.read((char*)&header, sizeof(header)) || memcmp(header.magic, featureTrackMagic, 4) != 0) {
+        ofLogError("FeatureTrack") << path << " is not a feature track";
+        return false;
+    }
+
+    if (header.version != featureTrackVersion) {
+        ofLogWarning("FeatureTrack") << path << " has version " << header.version << ", expected " << featureTrackVersion;
+        return false;
+    }
+
+    setup(header.sampleRate, header.hopSize, header.bufferSize, header.numBins, header.numFrames, header.numSamples);
+    setSource(header.sourceModifiedTime, header.minDecibels);
+
+    file.read((char*)spectrum.data(), spectrum.size());
+    file.read((char*)bpms.data(), bpms.size() * sizeof(float));
+    file.read((char*)phases.data(), phases.size() * sizeof(float));
+    file.read((char*)confidences.data(), confidences.size() * sizeof(float));
+    file.read((char*)frameFlags.data(), frameFlags.size());
+
+    if (!file) {
+        ofLogError("FeatureTrack") << path << " is truncated";
+        clear();
+        return false;
+    }
+    return true;
+}
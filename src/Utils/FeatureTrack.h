@@ -0,0 +1,68 @@
+// File: src/Utils/FeatureTrack.h
+#pragma once
+
+#include "ofMain.h"
+
+// Per-frame event flags
+enum FeatureFlag {
+    FEATURE_ONSET = 1 << 0,
+    FEATURE_BEAT = 1 << 1
+};
+
+// Pre-computed analysis of an audio file, one frame per analysis hop.
+// Frame i holds the analyzer state after (i + 1) * hopSize samples have
+// been consumed. The spectrum is quantized to 8 bits per bin; band levels
+// and energy are derived from it on replay exactly as in live mode.
+class FeatureTrack {
+public:
+    FeatureTrack();
+
+    void setup(int sampleRate, int hopSize, int bufferSize, int numBins, int numFrames, uint64_t numSamples);
+    void clear();
+
+    // Binary cache ("MSFT" header followed by per-field blocks)
+    bool save(const string& path) const;
+    bool load(const string& path);
+
+    bool isLoaded() const { return numFrames > 0; }
+    int getSampleRate() const { return sampleRate; }
+    int getHopSize() const { return hopSize; }
+    int getBufferSize() const { return bufferSize; }
+    int getNumBins() const { return numBins; }
+    int getNumFrames() const { return numFrames; }
+    uint64_t getNumSamples() const { return numSamples; }
+
+    // What the track was computed from, so stale caches can be detected:
+    // the source file's modification time and the analyzer's decibel floor
+    void setSource(int64_t modifiedTime, float minDecibels);
+    int64_t getSourceModifiedTime() const { return sourceModifiedTime; }
+    float getMinDecibels() const { return minDecibels; }
+
+    // Per-frame fields
+    uint8_t* getSpectrum(int frame) { return spectrum.data() + (size_t)frame * numBins; }
+    const uint8_t* getSpectrum(int frame) const { return spectrum.data() + (size_t)frame * numBins; }
+    float& bpm(int frame) { return bpms[frame]; }
+    float& phase(int frame) { return phases[frame]; }
+    float& confidence(int frame) { return confidences[frame]; }
+    uint8_t& flags(int frame) { return frameFlags[frame]; }
+    float bpm(int frame) const { return bpms[frame]; }
+    float phase(int frame) const { return phases[frame]; }
+    float confidence(int frame) const { return confidences[frame]; }
+    uint8_t flags(int frame) const { return frameFlags[frame]; }
+
+private:
+    int sampleRate;
+    int hopSize;
+    int bufferSize;
+    int numBins;
+    int numFrames;
+    uint64_t numSamples;
+    int64_t sourceModifiedTime;
+    float minDecibels;
+
+    vector<uint8_t> spectrum;
+    vector<float> bpms;
+    vector<float> phases;
+    vector<float> confidences;
+    vector<uint8_t> frameFlags;
+};
@@ -2,14 +2,16 @@
 #include "FeedbackEffect.h"
 
 FeedbackEffect::FeedbackEffect() : Effect("feedback") {
+    historyIndex = 0;
+    
     // Initialize parameters with defaults
-    ensureParameter("amount", 0.5);
-    ensureParameter("zoom", 1.01);
-    ensureParameter("rotate", 0.002);
-    ensureParameter("offsetX", 0);
-    ensureParameter("offsetY", 0);
-    ensureParameter("hueShift", 0);
-    ensureParameter("fade", 0.1);
+    amountParam = addParameter("amount", 0.5);
+    zoomParam = addParameter("zoom", 1.01);
+    rotateParam = addParameter("rotate", 0.002);
+    offsetXParam = addParameter("offsetX", 0);
+    offsetYParam = addParameter("offsetY", 0);
+    hueShiftParam = addParameter("hueShift", 0);
+    fadeParam = addParameter("fade", 0.1);
 }
 
 FeedbackEffect::~FeedbackEffect() {
@@ -19,108 +21,90 @@ FeedbackEffect::~FeedbackEffect() {
 void FeedbackEffect::setup(int width, int height) {
     Effect::setup(width, height);
     
-    // Initialize FBOs
-    bufferFbo.allocate(width, height, GL_RGBA);
-    tempFbo.allocate(width, height, GL_RGBA);
-    
-    // Clear FBOs
-    bufferFbo.begin();
-    ofClear(0, 0, 0, 0);
-    bufferFbo.end();
-    
-    tempFbo.begin();
-    ofClear(0, 0, 0, 0);
-    tempFbo.end();
+    // Initialize history FBOs
+    for (int i = 0; i < 2; i++) {
+        historyFbos[i].allocate(width, height, GL_RGBA);
+    }
+    clearHistory();
     
-    // Load feedback shader if needed
-    // In a real implementation, this would load actual shader files
-    // For this example, we'll use built-in OpenGL functionality
-    /*
+    // Load feedback shader
     if (!feedbackShader.isLoaded()) {
-        feedbackShader.load("shaders/feedback");
+        bool loaded = feedbackShader.load("shaders/feedback");
+        if (!loaded) {
+            ofLogError("FeedbackEffect") << "Failed to load feedback shader";
+        } else {
+            ofLogNotice("FeedbackEffect") << "Feedback shader loaded successfully";
+        }
+    }
+}
+
+void FeedbackEffect::clearHistory() {
+    for (int i = 0; i < 2; i++) {
+        historyFbos[i].begin();
+        ofClear(0, 0, 0, 0);
+        historyFbos[i].end();
     }
-    */
+    historyIndex = 0;
 }
 
-void FeedbackEffect::update(float phase, float* audioData, int numBands, map<string, float>& globalParams) {
+void FeedbackEffect::update(const AudioFrame& audio, map<string, float>& globalParams) {
     // Apply global parameter scaling
-    if (globalParams.find("feedback") != globalParams.end()) {
+    auto global = globalParams.find("feedback");
+    if (global != globalParams.end()) {
         // Scale feedback amount by global parameter
-        float feedbackMultiplier = globalParams["feedback"];
-        params["amount"] = params["amount"] * feedbackMultiplier;
+        float feedbackMultiplier = global->second;
+        param(amountParam) = param(amountParam) * feedbackMultiplier;
     }
     
-    // Apply audio reactivity
-    if (audioData != nullptr && numBands > 0) {
-        // Get bass energy for feedback amount
-        float bassEnergy = getAudioEnergy(audioData, numBands, "bass");
-        params["amount"] = ofLerp(params["amount"], bassEnergy * 0.8, 0.1);
-        
-        // Get mid energy for rotation
-        float midEnergy = getAudioEnergy(audioData, numBands, "mid");
-        params["rotate"] += (midEnergy - 0.5) * 0.001;
-        
-        // Ensure rotation stays in reasonable range
-        params["rotate"] = ofClamp(params["rotate"], -0.1, 0.1);
-    }
+    // Apply audio reactivity: bass energy drives feedback amount
+    float bassEnergy = getAudioEnergy(audio, AUDIO_BAND_BASS);
+    param(amountParam) = ofLerp(param(amountParam), bassEnergy * 0.8, 0.1);
+    
+    // Get mid energy for rotation
+    float midEnergy = getAudioEnergy(audio, AUDIO_BAND_MID);
+    param(rotateParam) += (midEnergy - 0.5) * 0.001;
+    
+    // Ensure rotation stays in reasonable range
+    param(rotateParam) = ofClamp(param(rotateParam), -0.1, 0.1);
 }
 
 void FeedbackEffect::apply(ofFbo& inputFbo) {
-    // Skip if amount is zero
-    if (params["amount"] <= 0 || intensity <= 0) {
-        inputFbo.draw(0, 0);
-        return;
-    }
-    
-    // Save current frame to temp buffer
-    tempFbo.begin();
-    ofClear(0, 0, 0, 0);
+    // Only reached without the shader
+    ofSetColor(255);
     inputFbo.draw(0, 0);
-    tempFbo.end();
-    
-    // Apply feedback
-    float effectiveAmount = params["amount"] * intensity;
-    
-    // Draw feedback buffer with transform
-    ofPushMatrix();
-    ofPushStyle();
-    
-    // Apply blend mode
-    ofEnableBlendMode(OF_BLENDMODE_ALPHA);
-    
-    // Apply feedback opacity
-    ofSetColor(255, 255, 255, 255 * effectiveAmount);
-    
-    // Apply feedback transform
-    ofTranslate(width / 2, height / 2);
-    ofRotateZDeg(params["rotate"] * 360.0);
-    ofScale(params["zoom"], params["zoom"]);
-    ofTranslate(-width / 2 + params["offsetX"], -height / 2 + params["offsetY"]);
-    
-    // Apply color shift if enabled
-    if (params["hueShift"] != 0) {
-        // In a real implementation, this would use the shader
-        // For this example, we'll just simulate color shifting
-        ofSetColor(255, 255, 255, 255 * effectiveAmount);
+}
+
+ofFbo* FeedbackEffect::applyToOwnFbo(ofFbo& inputFbo) {
+    if (!feedbackShader.isLoaded()) {
+        return nullptr;
     }
     
-    // Draw buffer content
-    bufferFbo.draw(0, 0);
+    ofFbo& previous = historyFbos[historyIndex];
+    ofFbo& next = historyFbos[1 - historyIndex];
     
-    ofPopStyle();
-    ofPopMatrix();
-    
-    // Draw original content on top
-    ofSetColor(255, 255, 255, 255);
-    inputFbo.draw(0, 0);
-    
-    // Update buffer for next frame
-    bufferFbo.begin();
+    next.begin();
     ofClear(0, 0, 0, 0);
+    ofPushStyle();
+    ofDisableAlphaBlending();
+    ofSetColor(255);
+    
+    // Transform, hue shift, fade and mix in one pass
+    feedbackShader.begin();
+    feedbackShader.setUniformTexture("feedbackTex", previous.getTexture(), 1);
+    feedbackShader.setUniform2f("resolution", width, height);
+    feedbackShader.setUniform1f("zoom", std::max(0.01f, param(zoomParam)));
+    feedbackShader.setUniform1f("rotate", param(rotateParam));
+    feedbackShader.setUniform2f("offset", param(offsetXParam), param(offsetYParam));
+    feedbackShader.setUniform1f("colorShift", param(hueShiftParam));
+    feedbackShader.setUniform1f("fade", ofClamp(param(fadeParam), 0, 1));
+    feedbackShader.setUniform1f("amount", ofClamp(param(amountParam) * intensity, 0, 1));
+    inputFbo.draw(0, 0);
+    feedbackShader.end();
     
-    // Fade out buffer for next frame
-    ofSetColor(255, 255, 255, 255 * (1.0 - params["fade"]));
-    tempFbo.draw(0, 0);
+    ofPopStyle();
+    next.end();
     
-    bufferFbo.end();
-}
\ No newline at end of file
+    // The result is both this frame's output and next frame's history
+    historyIndex = 1 - historyIndex;
+    return &next;
+}
@@ -12,16 +12,26 @@ public:
     void setup(int width, int height) override;
     
     // Update the effect
-    void update(float phase, float* audioData, int numBands, map<string, float>& globalParams) override;
+    void update(const AudioFrame& audio, map<string, float>& globalParams) override;
     
-    // Apply the effect to an input FBO
+    // Without the shader the input is passed through
     void apply(ofFbo& inputFbo) override;
     
+    // One shader pass into the next history FBO, which is also the result
+    ofFbo* applyToOwnFbo(ofFbo& inputFbo) override;
+    
+    // Forget the accumulated history
+    void clearHistory();
+    
 private:
-    // Feedback buffers
-    ofFbo bufferFbo;
-    ofFbo tempFbo;
+    // Ping-pong history: the last result is read while the next is written
+    ofFbo historyFbos[2];
+    int historyIndex;
     
     // Shader for feedback effects
     ofShader feedbackShader;
-};
\ No newline at end of file
+    
+    // Parameter handles
+    int amountParam, zoomParam, rotateParam;
+    int offsetXParam, offsetYParam, hueShiftParam, fadeParam;
+};
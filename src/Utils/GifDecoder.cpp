@@ -0,0 +1,369 @@
+// File: src/Utils/GifDecoder.cpp
+#include "GifDecoder.h"
+
+// Block introducers
+static const int GIF_EXTENSION = 0x21;
+static const int GIF_IMAGE = 0x2C;
+static const int GIF_TRAILER = 0x3B;
+static const int GIF_GRAPHIC_CONTROL = 0xF9;
+
+// Disposal methods
+static const int DISPOSE_BACKGROUND = 2;
+static const int DISPOSE_PREVIOUS = 3;
+
+// LZW codes are at most 12 bits
+static const int LZW_MAX_CODES = 4096;
+
+// Delays of 0 or 1 hundredths are played at 100ms, as browsers do
+static const float DEFAULT_FRAME_DURATION = 0.1;
+
+// Little-endian reader; GIF data is always little-endian
+static int readUInt16(const unsigned char* data) {
+    return data[0] | (data[1] << 8);
+}
+
+GifDecoder::GifDecoder() {
+    width = 0;
+    height = 0;
+    globalPaletteSize = 0;
+    disposal = 0;
+    transparentIndex = -1;
+    frameDuration = DEFAULT_FRAME_DURATION;
+    frameCount = 0;
+    pendingDisposal = 0;
+    pendingLeft = pendingTop = pendingWidth = pendingHeight = 0;
+    blockSize = 0;
+    blockPos = 0;
+    blocksEnded = true;
+}
+
+void GifDecoder::close() {
+    if (file.is_open()) {
+        file.close();
+    }
+    file.clear();
+}
+
+bool GifDecoder::open(const string& path) {
+    close();
+    this->path = path;
+    width = 0;
+    height = 0;
+    globalPaletteSize = 0;
+    frameCount = 0;
+    pendingDisposal = 0;
+
+    file.open(ofToDataPath(path), std::ios::binary);
+    if (!file) {
+        ofLogError("GifDecoder") << "Could not open " << path;
+        return false;
+    }
+
+    // Signature and logical screen descriptor
+    unsigned char header[13];
+    if (!file.read((char*)header, 13) || memcmp(header, "GIF8", 4) != 0) {
+        ofLogError("GifDecoder") << path << " is not a GIF file";
+        close();
+        return false;
+    }
+
+    width = readUInt16(header + 6);
+    height = readUInt16(header + 8);
+    int packed = header[10];
+    if (width == 0 || height == 0) {
+        ofLogError("GifDecoder") << path << " has an empty logical screen";
+        close();
+        return false;
+    }
+
+    if (packed & 0x80) {
+        globalPaletteSize = 2 << (packed & 7);
+        if (!file.read((char*)globalPalette, globalPaletteSize * 3)) {
+            ofLogError("GifDecoder") << path << " has a truncated global palette";
+            close();
+            return false;
+        }
+    }
+
+    // Frames composite onto a transparent canvas
+    canvas.allocate(width, height, OF_PIXELS_RGBA);
+    canvas.set(0);
+    return true;
+}
+
+bool GifDecoder::nextFrame() {
+    return readFrame(true);
+}
+
+bool GifDecoder::skipFrame() {
+    return readFrame(false);
+}
+
+bool GifDecoder::readFrame(bool decode) {
+    if (!file.is_open()) return false;
+
+    // Timing applies to the next image only
+    disposal = 0;
+    transparentIndex = -1;
+    frameDuration = DEFAULT_FRAME_DURATION;
+
+    // Walk extensions until the next image descriptor
+    while (true) {
+        int introducer = file.get();
+
+        if (introducer == GIF_EXTENSION) {
+            int label = file.get();
+            bool ok = label == GIF_GRAPHIC_CONTROL ? readGraphicControl() : skipSubBlocks();
+            if (!ok) break;
+        } else if (introducer == GIF_IMAGE) {
+            unsigned char descriptor[9];
+            if (!file.read((char*)descriptor, 9)) break;
+
+            int left = readUInt16(descriptor);
+            int top = readUInt16(descriptor + 2);
+            int frameWidth = readUInt16(descriptor + 4);
+            int frameHeight = readUInt16(descriptor + 6);
+            int packed = descriptor[8];
+
+            // Local palette replaces the global one for this image
+            const unsigned char* palette = globalPalette;
+            int paletteSize = globalPaletteSize;
+            if (packed & 0x80) {
+                paletteSize = 2 << (packed & 7);
+                if (!file.read((char*)localPalette, paletteSize * 3)) break;
+                palette = localPalette;
+            }
+
+            if (decode) {
+                applyPendingDisposal();
+
+                // Keep what this image covers, to restore it afterwards
+                if (disposal == DISPOSE_PREVIOUS) {
+                    if (!previousCanvas.isAllocated()) {
+                        previousCanvas.allocate(width, height, OF_PIXELS_RGBA);
+                    }
+                    memcpy(previousCanvas.getData(), canvas.getData(), (size_t)width * height * 4);
+                }
+
+                if (!decodeImage(left, top, frameWidth, frameHeight, (packed & 0x40) != 0, palette, paletteSize)) break;
+
+                pendingDisposal = disposal;
+                pendingLeft = left;
+                pendingTop = top;
+                pendingWidth = frameWidth;
+                pendingHeight = frameHeight;
+            } else {
+                // LZW minimum code size, then the data sub-blocks
+                if (file.get() == EOF || !skipSubBlocks()) break;
+            }
+
+            frameCount++;
+            return true;
+        } else if (introducer == GIF_TRAILER || introducer == EOF) {
+            // Some encoders omit the trailer
+            close();
+            return false;
+        } else {
+            ofLogWarning("GifDecoder") << path << ": unexpected block " << introducer;
+            break;
+        }
+    }
+
+    ofLogWarning("GifDecoder") << path << " is truncated or malformed after " << frameCount << " frames";
+    close();
+    return false;
+}
+
+bool GifDecoder::readGraphicControl() {
+    int size = file.get();
+    if (size < 4) {
+        return size != EOF && file.ignore(size) && skipSubBlocks();
+    }
+
+    unsigned char data[4];
+    if (!file.read((char*)data, 4)) return false;
+    file.ignore(size - 4);
+
+    disposal = (data[0] >> 2) & 7;
+    transparentIndex = (data[0] & 1) ? data[3] : -1;
+
+    int delay = readUInt16(data + 1);
+    frameDuration = delay > 1 ? delay / 100.0 : DEFAULT_FRAME_DURATION;
+
+    return skipSubBlocks();
+}
+
+bool GifDecoder::skipSubBlocks() {
+    while (true) {
+        int size = file.get();
+        if (size == EOF) return false;
+        if (size == 0) return true;
+        file.ignore(size);
+    }
+}
+
+int GifDecoder::readDataByte() {
+    if (blockPos == blockSize) {
+        if (blocksEnded) return -1;
+
+        // Next sub-block; a zero length ends the image data
+        int size = file.get();
+        if (size <= 0 || !file.read((char*)block, size)) {
+            blocksEnded = true;
+            return -1;
+        }
+        blockSize = size;
+        blockPos = 0;
+    }
+    return block[blockPos++];
+}
+
+void GifDecoder::applyPendingDisposal() {
+    if (pendingDisposal != DISPOSE_BACKGROUND && pendingDisposal != DISPOSE_PREVIOUS) {
+        pendingDisposal = 0;
+        return;
+    }
+
+    // Clip the previous image's rectangle to the canvas
+    int x0 = std::min(pendingLeft, width);
+    int y0 = std::min(pendingTop, height);
+    int x1 = std::min(pendingLeft + pendingWidth, width);
+    int y1 = std::min(pendingTop + pendingHeight, height);
+
+    unsigned char* pixels = canvas.getData();
+    for (int y = y0; y < y1; y++) {
+        size_t offset = ((size_t)y * width + x0) * 4;
+        size_t bytes = (size_t)(x1 - x0) * 4;
+        if (pendingDisposal == DISPOSE_BACKGROUND) {
+            // Background is drawn transparent, as browsers do
+            memset(pixels + offset, 0, bytes);
+        } else {
+            memcpy(pixels + offset, previousCanvas.getData() + offset, bytes);
+        }
+    }
+
+    pendingDisposal = 0;
+}
+
+bool GifDecoder::decodeImage(int left, int top, int frameWidth, int frameHeight, bool interlaced,
+                             const unsigned char* palette, int paletteSize) {
+    int minCodeSize = file.get();
+    if (minCodeSize < 1 || minCodeSize > 11) return false;
+
+    blockSize = 0;
+    blockPos = 0;
+    blocksEnded = false;
+
+    int clearCode = 1 << minCodeSize;
+    int endCode = clearCode + 1;
+    int codeSize = minCodeSize + 1;
+    int nextCode = clearCode + 2;
+    int oldCode = -1;
+    int first = 0;
+
+    for (int i = 0; i < clearCode; i++) {
+        prefix[i] = 0;
+        suffix[i] = (unsigned char)i;
+    }
+
+    // Interlaced rows come in four passes
+    static const int passStart[4] = { 0, 4, 2, 1 };
+    static const int passStep[4] = { 8, 8, 4, 2 };
+    int pass = 0;
+    int x = 0;
+    int row = 0;
+
+    uint32_t bits = 0;
+    int bitCount = 0;
+    int64_t remaining = (int64_t)frameWidth * frameHeight;
+    unsigned char* pixels = canvas.getData();
+
+    while (remaining > 0) {
+        // Next code, least significant bits first
+        while (bitCount < codeSize) {
+            int byte = readDataByte();
+            if (byte < 0) break;
+            bits |= (uint32_t)byte << bitCount;
+            bitCount += 8;
+        }
+        if (bitCount < codeSize) break;
+
+        int code = bits & ((1 << codeSize) - 1);
+        bits >>= codeSize;
+        bitCount -= codeSize;
+
+        if (code == clearCode) {
+            codeSize = minCodeSize + 1;
+            nextCode = clearCode + 2;
+            oldCode = -1;
+            continue;
+        }
+        if (code == endCode) break;
+
+        // Expand the code onto the stack, last byte first
+        int depth = 0;
+        int inCode = code;
+        if (oldCode < 0) {
+            if (code >= clearCode) break;
+            first = code;
+            stack[depth++] = (unsigned char)code;
+        } else {
+            if (code > nextCode) break;
+            if (code == nextCode) {
+                // The code being defined: previous string plus its first byte
+                stack[depth++] = (unsigned char)first;
+                code = oldCode;
+            }
+            while (code >= clearCode) {
+                stack[depth++] = suffix[code];
+                code = prefix[code];
+            }
+            first = code;
+            stack[depth++] = (unsigned char)code;
+
+            if (nextCode < LZW_MAX_CODES) {
+                prefix[nextCode] = (uint16_t)oldCode;
+                suffix[nextCode] = (unsigned char)first;
+                nextCode++;
+                if (nextCode == (1 << codeSize) && codeSize < 12) {
+                    codeSize++;
+                }
+            }
+        }
+        oldCode = inCode;
+
+        // Write the string straight onto the canvas
+        while (depth > 0 && remaining > 0) {
+            int index = stack[--depth];
+            int canvasX = left + x;
+            int canvasY = top + row;
+
+            if (index != transparentIndex && index < paletteSize && canvasX < width && canvasY < height) {
+                unsigned char* pixel = pixels + ((size_t)canvasY * width + canvasX) * 4;
+                const unsigned char* color = palette + index * 3;
+                pixel[0] = color[0];
+                pixel[1] = color[1];
+                pixel[2] = color[2];
+                pixel[3] = 255;
+            }
+            remaining--;
+
+            if (++x == frameWidth) {
+                x = 0;
+                if (interlaced) {
+                    row += passStep[pass];
+                    while (row >= frameHeight && pass < 3) {
+                        pass++;
+                        row = passStart[pass];
+                    }
+                } else {
+                    row++;
+                }
+            }
+        }
+    }
+
+    // Skip whatever follows the end code
+    if (!blocksEnded && !skipSubBlocks()) return false;
+    return true;
+}
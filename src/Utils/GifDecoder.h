@@ -0,0 +1,82 @@
+// File: src/Utils/GifDecoder.h
+#pragma once
+
+#include "ofMain.h"
+#include <fstream>
+
+// Streaming GIF87a/GIF89a decoder. Frames are read from the file one at a
+// time and LZW-decoded straight onto a single RGBA canvas, applying each
+// frame's disposal method and transparent colour, so memory use does not
+// grow with the file or the frame count.
+class GifDecoder {
+public:
+    GifDecoder();
+
+    // Read the header and global palette; frames follow with nextFrame()
+    bool open(const string& path);
+
+    // Release the file; the size and last canvas stay readable. Called
+    // automatically after the last frame
+    void close();
+
+    // Decode the next frame onto the canvas. False after the last frame,
+    // or if the file is malformed
+    bool nextFrame();
+
+    // Step over the next frame, reading only its timing
+    bool skipFrame();
+
+    // Canvas as of the last nextFrame(), RGBA at the logical screen size
+    const ofPixels& getCanvas() const { return canvas; }
+
+    // Display time of the last frame read, in seconds
+    float getFrameDuration() const { return frameDuration; }
+
+    // Frames read so far
+    int getFrameCount() const { return frameCount; }
+
+    int getWidth() const { return width; }
+    int getHeight() const { return height; }
+
+private:
+    std::ifstream file;
+    string path;
+    int width;
+    int height;
+
+    unsigned char globalPalette[256 * 3];
+    int globalPaletteSize;
+    unsigned char localPalette[256 * 3];
+
+    ofPixels canvas;
+    ofPixels previousCanvas; // for disposal "restore to previous"
+
+    // Graphic control of the next image
+    int disposal;
+    int transparentIndex;
+    float frameDuration;
+    int frameCount;
+
+    // Disposal still owed by the last drawn frame
+    int pendingDisposal;
+    int pendingLeft, pendingTop, pendingWidth, pendingHeight;
+
+    // LZW string table: each code is a prefix code plus one byte
+    uint16_t prefix[4096];
+    unsigned char suffix[4096];
+    unsigned char stack[4096];
+
+    // Image data sub-block reader
+    unsigned char block[255];
+    int blockSize;
+    int blockPos;
+    bool blocksEnded;
+
+    bool readFrame(bool decode);
+    bool readGraphicControl();
+    bool skipSubBlocks();
+    bool decodeImage(int left, int top, int frameWidth, int frameHeight, bool interlaced,
+                     const unsigned char* palette, int paletteSize);
+    int readDataByte();
+    void applyPendingDisposal();
+};
@@ -0,0 +1,123 @@
+// File: src/Utils/GlitchEffect.cpp
+#include "GlitchEffect.h"
+
+GlitchEffect::GlitchEffect() : Effect("glitch") {
+    time = 0;
+    currentAmount = 0;
+    
+    // Initialize parameters with defaults
+    amountParam = addParameter("amount", 0.5);
+    colorShiftParam = addParameter("colorShift", 1.0); // Boolean as float (1.0 = true)
+    scanlinesParam = addParameter("scanlines", 1.0); // Boolean as float (1.0 = true)
+    noiseAmountParam = addParameter("noiseAmount", 0.2);
+    audioReactivityParam = addParameter("audioReactivity", 0.5);
+}
+
+GlitchEffect::~GlitchEffect() {
+    // Clean up resources
+}
+
+void GlitchEffect::setup(int width, int height) {
+    Effect::setup(width, height);
+    
+    // Load glitch shader
+    if (!glitchShader.isLoaded()) {
+        bool loaded = glitchShader.load("shaders/glitch");
+        if (!loaded) {
+            ofLogError("GlitchEffect") << "Failed to load glitch shader";
+        } else {
+            ofLogNotice("GlitchEffect") << "Glitch shader loaded successfully";
+        }
+    }
+}
+
+void GlitchEffect::update(const AudioFrame& audio, map<string, float>& globalParams) {
+    time = ofGetElapsedTimef();
+    
+    // High frequencies push the glitch amount up
+    float energy = getAudioEnergy(audio, AUDIO_BAND_HIGH);
+    float boost = energy * param(audioReactivityParam);
+    currentAmount = ofClamp(param(amountParam) + boost * (1.0 - param(amountParam)), 0, 1);
+}
+
+void GlitchEffect::apply(ofFbo& inputFbo) {
+    // Without the shader pass the input through untouched
+    if (!glitchShader.isLoaded()) {
+        ofSetColor(255);
+        inputFbo.draw(0, 0);
+        return;
+    }
+    
+    glitchShader.begin();
+    
+    // Set shader parameters
+    glitchShader.setUniform1f("amount", currentAmount * intensity);
+    glitchShader.setUniform1f("time", time);
+    glitchShader.setUniform2f("resolution", width, height);
+    glitchShader.setUniform1i("colorShift", param(colorShiftParam) > 0.5 ? 1 : 0);
+    glitchShader.setUniform1i("scanlines", param(scanlinesParam) > 0.5 ? 1 : 0);
+    glitchShader.setUniform1f("noiseAmount", param(noiseAmountParam));
+    
+    // Draw input using shader
+    ofSetColor(255);
+    inputFbo.draw(0, 0);
+    
+    glitchShader.end();
+}
+
+string GlitchEffect::getStageSource() {
+    // Same math as glitch.frag without the RGB split
+    return R"(
+uniform float $amount;
+uniform float $time;
+uniform vec2 $resolution;
+uniform bool $scanlines;
+uniform float $noiseAmount;
+
+float $random(vec2 co) {
+    return fract(sin(dot(co.xy, vec2(12.9898, 78.233))) * 43758.5453);
+}
+
+vec2 $uv(vec2 uv) {
+    float glitchLine = floor(uv.y * 20.0) / 20.0;
+    float randomValue = $random(vec2(glitchLine, floor($time * 10.0)));
+    
+    if (randomValue < $amount * 0.5) {
+        uv.x += ($random(vec2(glitchLine, $time)) - 0.5) * 0.1 * $amount;
+    }
+    if (randomValue > 0.8 && randomValue < 0.83) {
+        uv.y = fract(uv.y + $random(vec2(floor($time * 20.0))));
+    }
+    return uv;
+}
+
+vec4 $color(vec4 color, vec2 uv) {
+    if ($scanlines) {
+        float scanlineY = fract(uv.y * $resolution.y * 0.5);
+        float scanlineIntensity = 0.1 + 0.05 * sin($time * 10.0);
+        if (scanlineY < 0.5) {
+            color.rgb *= (1.0 - scanlineIntensity);
+        }
+    }
+    
+    if ($noiseAmount > 0.0) {
+        float noise = $random(uv * $time);
+        if (noise > (1.0 - $noiseAmount * $amount)) {
+            vec3 noiseColor = vec3($random(uv + vec2(0.1, $time)),
+                                   $random(uv + vec2(0.2, $time)),
+                                   $random(uv + vec2(0.3, $time)));
+            color.rgb = mix(color.rgb, noiseColor, $noiseAmount * $amount);
+        }
+    }
+    return color;
+}
+)";
+}
+
+void GlitchEffect::setStageUniforms(ofShader& shader, const string& prefix) {
+    shader.setUniform1f(prefix + "amount", currentAmount * intensity);
+    shader.setUniform1f(prefix + "time", time);
+    shader.setUniform2f(prefix + "resolution", width, height);
+    shader.setUniform1i(prefix + "scanlines", param(scanlinesParam) > 0.5 ? 1 : 0);
+    shader.setUniform1f(prefix + "noiseAmount", param(noiseAmountParam));
+}
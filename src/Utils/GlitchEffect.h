@@ -0,0 +1,38 @@
+// File: src/Utils/GlitchEffect.h
+#pragma once
+
+#include "Effect.h"
+
+class GlitchEffect : public Effect {
+public:
+    GlitchEffect();
+    virtual ~GlitchEffect();
+    
+    // Setup the effect
+    void setup(int width, int height) override;
+    
+    // Update the effect
+    void update(const AudioFrame& audio, map<string, float>& globalParams) override;
+    
+    // Apply the effect to an input FBO
+    void apply(ofFbo& inputFbo) override;
+    
+    // Fusable stage: line offsets, scanlines and noise. The RGB split reads
+    // the input three more times, so it needs its own pass
+    bool isFusable() override { return param(colorShiftParam) <= 0.5; }
+    string getStageSource() override;
+    void setStageUniforms(ofShader& shader, const string& prefix) override;
+    
+private:
+    // Shader for glitching
+    ofShader glitchShader;
+    
+    // Shader time in seconds
+    float time;
+    
+    // Amount after audio modulation
+    float currentAmount;
+    
+    // Parameter handles
+    int amountParam, colorShiftParam, scanlinesParam, noiseAmountParam, audioReactivityParam;
+};
@@ -0,0 +1,197 @@
+// File: src/Utils/GpuParticles.cpp
+#include "GpuParticles.h"
+
+// Segments in the particle disc
+static const int DISC_SEGMENTS = 16;
+
+// State textures per ping-pong FBO, and the update shader outputs that
+// write them, in attachment order
+static const int STATE_TEXTURES = 3;
+static const char* STATE_OUTPUTS[STATE_TEXTURES] = { "outputPosition", "outputVelocity", "outputAttributes" };
+
+void GpuParticleTexels::pack(const vector<SpriteState>& states, const vector<ofFloatColor>& colors) {
+    int count = (int)states.size();
+    
+    // Roughly square state textures
+    columns = std::max(1, (int)ceil(sqrt((float)count)));
+    rows = std::max(1, (count + columns - 1) / columns);
+    
+    // Pack the states, padding the last row with idle particles
+    size_t texels = (size_t)columns * rows;
+    stateA.assign(texels * 4, 0.0f);
+    stateB.assign(texels * 4, 0.0f);
+    stateC.assign(texels * 4, 0.0f);
+    motion.assign(texels * 4, 0.0f);
+    wave.assign(texels * 4, 0.0f);
+    base.assign(texels * 4, 0.0f);
+    color.assign(texels * 4, 0.0f);
+    
+    for (int i = 0; i < count; i++) {
+        const SpriteState& s = states[i];
+        float* a = &stateA[i * 4];
+        float* b = &stateB[i * 4];
+        float* c = &stateC[i * 4];
+        float* m = &motion[i * 4];
+        float* w = &wave[i * 4];
+        float* p = &base[i * 4];
+        float* k = &color[i * 4];
+        
+        a[0] = s.x; a[1] = s.y; a[2] = s.rotation; a[3] = s.scale;
+        b[0] = s.velocityX; b[1] = s.velocityY; b[2] = s.rotationSpeed; b[3] = s.circlePhase;
+        c[0] = s.wavePhaseX; c[1] = s.wavePhaseY;
+        m[0] = s.motionType; m[1] = s.motionAmount; m[2] = s.circleRadius; m[3] = s.audioReactivity;
+        w[0] = s.waveAmplitudeX; w[1] = s.waveAmplitudeY; w[2] = s.waveFrequencyX; w[3] = s.waveFrequencyY;
+        p[0] = s.baseX; p[1] = s.baseY;
+        p[2] = (s.reactsTo >= 0 && s.reactsTo < AUDIO_BAND_COUNT) ? s.reactsTo : AUDIO_BAND_COUNT;
+        
+        ofFloatColor particleColor = i < (int)colors.size() ? colors[i] : ofFloatColor(1, 1, 1, 1);
+        k[0] = particleColor.r; k[1] = particleColor.g; k[2] = particleColor.b;
+        k[3] = particleColor.a * s.opacity;
+    }
+}
+
+GpuParticles::GpuParticles() {
+    ready = false;
+    count = 0;
+    columns = 0;
+    rows = 0;
+    radius = 20;
+    current = 0;
+    discVertexCount = 0;
+}
+
+GpuParticles::~GpuParticles() {
+    // Clean up resources
+}
+
+void GpuParticles::allocateFloatTexture(ofTexture& texture, const vector<float>& data) {
+    texture.allocate(columns, rows, GL_RGBA32F);
+    texture.setTextureMinMagFilter(GL_NEAREST, GL_NEAREST);
+    texture.loadData(data.data(), columns, rows, GL_RGBA);
+}
+
+bool GpuParticles::loadUpdateShader() {
+    if (!updateShader.setupShaderFromFile(GL_VERTEX_SHADER, "shaders/particles_update.vert") ||
+        !updateShader.setupShaderFromFile(GL_FRAGMENT_SHADER, "shaders/particles_update.frag")) {
+        return false;
+    }
+    
+    // Bind each output to its attachment before linking, so one pass
+    // writes every state texture
+    updateShader.bindDefaults();
+    for (int i = 0; i < STATE_TEXTURES; i++) {
+        glBindFragDataLocation(updateShader.getProgram(), i, STATE_OUTPUTS[i]);
+    }
+    return updateShader.linkProgram();
+}
+
+bool GpuParticles::setup(const vector<SpriteState>& particleStates, const vector<ofFloatColor>& colors) {
+    ready = false;
+    
+    // Load shaders once
+    if (!updateShader.isLoaded() && !loadUpdateShader()) {
+        ofLogError("GpuParticles") << "Failed to load particle update shader";
+        return false;
+    }
+    if (!drawShader.isLoaded() && !drawShader.load("shaders/particles_draw")) {
+        ofLogError("GpuParticles") << "Failed to load particle draw shader";
+        return false;
+    }
+    
+    count = (int)particleStates.size();
+    if (count == 0) return false;
+    
+    GpuParticleTexels texels;
+    texels.pack(particleStates, colors);
+    columns = texels.columns;
+    rows = texels.rows;
+    
+    // State FBOs: three float attachments, sampled exactly
+    ofFboSettings settings;
+    settings.width = columns;
+    settings.height = rows;
+    settings.numColorbuffers = STATE_TEXTURES;
+    settings.internalformat = GL_RGBA32F;
+    settings.textureTarget = GL_TEXTURE_2D;
+    settings.minFilter = GL_NEAREST;
+    settings.maxFilter = GL_NEAREST;
+    for (int i = 0; i < 2; i++) {
+        states[i].allocate(settings);
+    }
+    
+    current = 0;
+    states[current].getTexture(0).loadData(texels.stateA.data(), columns, rows, GL_RGBA);
+    states[current].getTexture(1).loadData(texels.stateB.data(), columns, rows, GL_RGBA);
+    states[current].getTexture(2).loadData(texels.stateC.data(), columns, rows, GL_RGBA);
+    
+    allocateFloatTexture(motionParams, texels.motion);
+    allocateFloatTexture(waveParams, texels.wave);
+    allocateFloatTexture(baseParams, texels.base);
+    allocateFloatTexture(colorTexture, texels.color);
+    
+    // Unit disc as a fan around the centre
+    vector<ofVec3f> discVertices;
+    discVertices.push_back(ofVec3f(0, 0, 0));
+    for (int i = 0; i <= DISC_SEGMENTS; i++) {
+        float angle = TWO_PI * i / DISC_SEGMENTS;
+        discVertices.push_back(ofVec3f(cos(angle), sin(angle), 0));
+    }
+    discVbo.setVertexData(discVertices.data(), (int)discVertices.size(), GL_STATIC_DRAW);
+    discVertexCount = (int)discVertices.size();
+    
+    ready = true;
+    return true;
+}
+
+void GpuParticles::update(float deltaTime, const AudioFrame& audio) {
+    if (!ready) return;
+    
+    // Band energies, plus the all-band average
+    float energies[AUDIO_BAND_COUNT + 1];
+    float sum = 0.0;
+    for (int b = 0; b < AUDIO_BAND_COUNT; b++) {
+        energies[b] = audio.bandLevels[b];
+        sum += audio.bandLevels[b];
+    }
+    energies[AUDIO_BAND_COUNT] = sum / AUDIO_BAND_COUNT;
+    
+    ofFbo& previous = states[current];
+    ofFbo& next = states[1 - current];
+    
+    ofPushStyle();
+    ofDisableAlphaBlending(); // alpha carries state, never blend it
+    
+    next.begin();
+    updateShader.begin();
+    updateShader.setUniformTexture("stateA", previous.getTexture(0), 1);
+    updateShader.setUniformTexture("stateB", previous.getTexture(1), 2);
+    updateShader.setUniformTexture("stateC", previous.getTexture(2), 3);
+    updateShader.setUniformTexture("motionParams", motionParams, 4);
+    updateShader.setUniformTexture("waveParams", waveParams, 5);
+    updateShader.setUniformTexture("baseParams", baseParams, 6);
+    updateShader.setUniform1f("deltaTime", deltaTime);
+    updateShader.setUniform1fv("bandEnergies", energies, AUDIO_BAND_COUNT + 1);
+    
+    // Every texel of all three state textures in a single pass
+    next.activateAllDrawBuffers();
+    ofDrawRectangle(0, 0, columns, rows);
+    
+    updateShader.end();
+    next.end();
+    
+    ofPopStyle();
+    current = 1 - current;
+}
+
+void GpuParticles::draw(int canvasWidth, int canvasHeight) {
+    if (!ready) return;
+    
+    drawShader.begin();
+    drawShader.setUniformTexture("stateA", states[current].getTexture(0), 1);
+    drawShader.setUniformTexture("colors", colorTexture, 2);
+    drawShader.setUniform1i("columns", columns);
+    drawShader.setUniform2f("resolution", canvasWidth, canvasHeight);
+    drawShader.setUniform1f("radius", radius);
+    discVbo.drawInstanced(GL_TRIANGLE_FAN, 0, discVertexCount, count);
+    drawShader.end();
+}
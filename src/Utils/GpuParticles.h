@@ -0,0 +1,87 @@
+// File: src/Utils/GpuParticles.h
+#pragma once
+
+#include "ofMain.h"
+#include "AudioFrame.h"
+#include "SpriteSystem.h"
+
+// Particle states and constants packed as RGBA float texels, one per
+// particle in a roughly square grid, in the layout particles_update.frag
+// and particles_draw read. Texels past the last particle are idle zeros
+struct GpuParticleTexels {
+    GpuParticleTexels() {
+        columns = 0;
+        rows = 0;
+    }
+    
+    // Missing colours default to opaque white
+    void pack(const vector<SpriteState>& states, const vector<ofFloatColor>& colors);
+    
+    int columns;
+    int rows;
+    
+    // Ping-pong state: position, velocity and phases
+    vector<float> stateA;
+    vector<float> stateB;
+    vector<float> stateC;
+    
+    // Per-particle constants
+    vector<float> motion;
+    vector<float> wave;
+    vector<float> base;
+    vector<float> color;
+};
+
+// Sprites simulated and drawn entirely on the GPU. State lives in float
+// textures, one texel per particle, and each frame particles_update.frag
+// advances it with the same rules as SpriteSystem. Particles are drawn as
+// instanced discs that read their state in the vertex shader, so there is
+// no per-particle CPU work after setup. Trails are not supported.
+class GpuParticles {
+public:
+    GpuParticles();
+    ~GpuParticles();
+    
+    // Upload initial states and colours (rgb plus opacity). Returns false
+    // if the shaders are missing, leaving the particles unusable
+    bool setup(const vector<SpriteState>& states, const vector<ofFloatColor>& colors);
+    
+    // Advance every particle one step
+    void update(float deltaTime, const AudioFrame& audio);
+    
+    // Draw into the bound target, canvasWidth x canvasHeight
+    void draw(int canvasWidth, int canvasHeight);
+    
+    bool isReady() { return ready; }
+    int getCount() { return count; }
+    
+    // Disc radius in pixels before each particle's scale
+    void setRadius(float radius) { this->radius = radius; }
+    
+private:
+    bool ready;
+    int count;
+    int columns;
+    int rows;
+    float radius;
+    
+    // Ping-pong state: three attachments each, see particles_update.frag
+    ofFbo states[2];
+    int current;
+    
+    // Per-particle constants
+    ofTexture motionParams;
+    ofTexture waveParams;
+    ofTexture baseParams;
+    ofTexture colorTexture;
+    
+    ofShader updateShader;
+    ofShader drawShader;
+    
+    // Unit disc drawn once per particle
+    ofVbo discVbo;
+    int discVertexCount;
+    
+    void allocateFloatTexture(ofTexture& texture, const vector<float>& data);
+    bool loadUpdateShader();
+};
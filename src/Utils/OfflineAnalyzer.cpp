@@ -0,0 +1,133 @@
+// File: src/Utils/OfflineAnalyzer.cpp
+#include "OfflineAnalyzer.h"
+#include "AudioAnalyzer.h"
+#include "FFT.h"
+
+OfflineAnalyzer::OfflineAnalyzer() {
+    bufferSize = 1024;
+    minDecibels = -70.0;
+    numThreads = 0;
+}
+
+bool OfflineAnalyzer::analyze(const vector<float>& samples, int sampleRate, FeatureTrack& track) {
+    int hopSize = bufferSize / 2;
+    int numBins = bufferSize / 2;
+    int numFrames = samples.size() / hopSize;
+
+    if (sampleRate <= 0 || numFrames == 0) {
+        ofLogError("OfflineAnalyzer") << "Nothing to analyze";
+        return false;
+    }
+
+    // Every frame is one FFT of exactly bufferSize samples
+    if (!FFT::isPowerOfTwo(bufferSize)) {
+        ofLogError("OfflineAnalyzer") << "Buffer size " << bufferSize << " is not a power of two";
+        return false;
+    }
+
+    uint64_t startTime = ofGetElapsedTimeMillis();
+
+    // Parallel pass: spectrum levels and raw band flux per frame
+    vector<float> levels((size_t)numFrames * numBins);
+    vector<float> bandFlux((size_t)numFrames * BeatDetector::fluxBandCount);
+
+    int threads = numThreads > 0 ? numThreads : (int)std::thread::hardware_concurrency();
+    threads = std::max(1, std::min(threads, numFrames));
+
+    vector<std::thread> workers;
+    for (int i = 0; i < threads; i++) {
+        int begin = (int)((int64_t)numFrames * i / threads);
+        int end = (int)((int64_t)numFrames * (i + 1) / threads);
+        workers.push_back(std::thread(&OfflineAnalyzer::analyzeRange, this, std::cref(samples), sampleRate,
+                                      begin, end, std::ref(levels), std::ref(bandFlux)));
+    }
+    for (auto& worker : workers) {
+        worker.join();
+    }
+
+    // Sequential pass: the same smoothing and beat tracking as live mode
+    track.setup(sampleRate, hopSize, bufferSize, numBins, numFrames, samples.size());
+
+    BeatDetector beatDetector;
+    beatDetector.setup(hopSize, sampleRate, numBins);
+
+    vector<float> spectrum(numBins, 0);
+    float keep = AudioAnalyzer::spectrumSmoothing(hopSize, sampleRate);
+    uint32_t lastBeatCount = 0;
+    uint32_t lastOnsetCount = 0;
+
+    for (int frame = 0; frame < numFrames; frame++) {
+        // Smooth and quantize the spectrum
+        const float* frameLevels = levels.data() + (size_t)frame * numBins;
+        uint8_t* quantized = track.getSpectrum(frame);
+        for (int i = 0; i < numBins; i++) {
+            spectrum[i] = spectrum[i] * keep + frameLevels[i] * (1.0f - keep);
+            quantized[i] = (uint8_t)(ofClamp(spectrum[i], 0, 1) * 255.0f + 0.5f);
+        }
+
+        // Track beats
+        float flux = beatDetector.combineBandFlux(bandFlux.data() + (size_t)frame * BeatDetector::fluxBandCount);
+        beatDetector.processFlux(flux);
+
+        track.bpm(frame) = beatDetector.getBPM();
+        track.phase(frame) = beatDetector.getPhase();
+        track.confidence(frame) = beatDetector.getConfidence();
+
+        uint8_t flags = 0;
+        if (beatDetector.getBeatCount() != lastBeatCount) flags |= FEATURE_BEAT;
+        if (beatDetector.getOnsetCount() != lastOnsetCount) flags |= FEATURE_ONSET;
+        track.flags(frame) = flags;
+
+        lastBeatCount = beatDetector.getBeatCount();
+        lastOnsetCount = beatDetector.getOnsetCount();
+    }
+
+    uint64_t elapsed = std::max<uint64_t>(1, ofGetElapsedTimeMillis() - startTime);
+    float duration = (float)samples.size() / sampleRate;
+    ofLogNotice("OfflineAnalyzer") << "Analyzed " << duration << "s of audio in " << elapsed << "ms on "
+                                   << threads << " threads (" << duration * 1000.0f / elapsed << "x real time)";
+
+    return true;
+}
+
+void OfflineAnalyzer::analyzeRange(const vector<float>& samples, int sampleRate, int begin, int end,
+                                   vector<float>& levels, vector<float>& bandFlux) {
+    int hopSize = bufferSize / 2;
+    int numBins = bufferSize / 2;
+
+    // Each worker owns its FFT and flux state
+    FFT fft;
+    fft.setup(bufferSize);
+
+    BeatDetector fluxDetector;
+    fluxDetector.setup(hopSize, sampleRate, numBins);
+
+    vector<float> window(bufferSize);
+    vector<float> magnitudes(numBins);
+    float discardedFlux[BeatDetector::fluxBandCount];
+
+    // Start one frame early so the first flux compares against the right hop
+    for (int frame = std::max(0, begin - 1); frame < end; frame++) {
+        // Frame i ends after (i + 1) hops; the live window starts out zeroed
+        int64_t windowEnd = (int64_t)(frame + 1) * hopSize;
+        int64_t windowStart = windowEnd - bufferSize;
+        for (int i = 0; i < bufferSize; i++) {
+            int64_t index = windowStart + i;
+            window[i] = index >= 0 ? samples[index] : 0;
+        }
+
+        fft.process(window.data(), magnitudes.data());
+
+        if (frame < begin) {
+            fluxDetector.computeBandFlux(magnitudes.data(), numBins, discardedFlux);
+            continue;
+        }
+
+        float* frameLevels = levels.data() + (size_t)frame * numBins;
+        for (int i = 0; i < numBins; i++) {
+            frameLevels[i] = AudioAnalyzer::magnitudeToLevel(magnitudes[i], minDecibels);
+        }
+
+        fluxDetector.computeBandFlux(magnitudes.data(), numBins, bandFlux.data() + (size_t)frame * BeatDetector::fluxBandCount);
+    }
+}
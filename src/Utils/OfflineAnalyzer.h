@@ -0,0 +1,34 @@
+// File: src/Utils/OfflineAnalyzer.h
+#pragma once
+
+#include "ofMain.h"
+#include "FeatureTrack.h"
+
+// Runs the AudioAnalyzer pipeline over a whole decoded file and records
+// the result as a FeatureTrack.
+// The FFT and raw onset flux of every hop are independent, so they are
+// computed in parallel chunks across all cores. Smoothing, flux whitening
+// and beat tracking depend on history and run in a second, sequential
+// pass. The output does not depend on the number of threads.
+class OfflineAnalyzer {
+public:
+    OfflineAnalyzer();
+
+    // Must match the live analyzer so replay looks the same; a power of two
+    void setBufferSize(int size) { bufferSize = size; }
+    void setMinDecibels(float decibels) { minDecibels = decibels; }
+
+    // 0 uses every hardware thread
+    void setNumThreads(int threads) { numThreads = threads; }
+
+    bool analyze(const vector<float>& samples, int sampleRate, FeatureTrack& track);
+
+private:
+    int bufferSize;
+    float minDecibels;
+    int numThreads;
+
+    // Spectrum levels and raw band flux for frames [begin, end)
+    void analyzeRange(const vector<float>& samples, int sampleRate, int begin, int end,
+                      vector<float>& levels, vector<float>& bandFlux);
+};
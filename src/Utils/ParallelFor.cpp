@@ -0,0 +1,120 @@
+// File: src/Utils/ParallelFor.cpp
+#include "ParallelFor.h"
+#include <condition_variable>
+
+namespace {
+
+class WorkerPool {
+public:
+    WorkerPool() {
+        numThreads = std::max(1, (int)std::thread::hardware_concurrency());
+        job = nullptr;
+        jobCount = 0;
+        generation = 0;
+        pending = 0;
+        quit = false;
+
+        // The caller of run() acts as thread 0
+        for (int i = 1; i < numThreads; i++) {
+            workers.push_back(std::thread(&WorkerPool::workerLoop, this, i));
+        }
+    }
+
+    ~WorkerPool() {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            quit = true;
+        }
+        wake.notify_all();
+        for (auto& worker : workers) {
+            worker.join();
+        }
+    }
+
+    void run(int count, const std::function<void(int, int)>& body) {
+        if (numThreads == 1 || count <= 1) {
+            body(0, count);
+            return;
+        }
+
+        // One job at a time
+        std::lock_guard<std::mutex> runLock(runMutex);
+
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            job = &body;
+            jobCount = count;
+            pending = numThreads - 1;
+            generation++;
+        }
+        wake.notify_all();
+
+        execute(0, count, body);
+
+        std::unique_lock<std::mutex> lock(mutex);
+        done.wait(lock, [this] { return pending == 0; });
+        job = nullptr;
+    }
+
+    int getNumThreads() { return numThreads; }
+
+private:
+    int numThreads;
+    vector<std::thread> workers;
+
+    std::mutex runMutex;
+    std::mutex mutex;
+    std::condition_variable wake;
+    std::condition_variable done;
+
+    const std::function<void(int, int)>* job;
+    int jobCount;
+    uint64_t generation;
+    int pending;
+    bool quit;
+
+    void execute(int index, int count, const std::function<void(int, int)>& body) {
+        int begin = (int)((int64_t)count * index / numThreads);
+        int end = (int)((int64_t)count * (index + 1) / numThreads);
+        if (begin < end) {
+            body(begin, end);
+        }
+    }
+
+    void workerLoop(int index) {
+        uint64_t seenGeneration = 0;
+        std::unique_lock<std::mutex> lock(mutex);
+
+        while (true) {
+            wake.wait(lock, [&] { return quit || generation != seenGeneration; });
+            if (quit) return;
+            seenGeneration = generation;
+
+            const std::function<void(int, int)>* body = job;
+            int count = jobCount;
+
+            lock.unlock();
+            execute(index, count, *body);
+            lock.lock();
+
+            if (--pending == 0) {
+                done.notify_one();
+            }
+        }
+    }
+};
+
+WorkerPool& getPool() {
+    static WorkerPool pool;
+    return pool;
+}
+
+}
+
+void ParallelFor::run(int count, const std::function<void(int begin, int end)>& body) {
+    getPool().run(count, body);
+}
+
+int ParallelFor::getNumThreads() {
+    return getPool().getNumThreads();
+}
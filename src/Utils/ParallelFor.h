@@ -0,0 +1,17 @@
+// File: src/Utils/ParallelFor.h
+#pragma once
+
+#include "ofMain.h"
+#include <functional>
+
+// Runs a loop body across a persistent pool of worker threads.
+// [0, count) is split into one contiguous range per thread; the calling
+// thread takes the first range and run() returns once every range is done.
+// Not reentrant: the body must not call run() itself.
+class ParallelFor {
+public:
+    static void run(int count, const std::function<void(int begin, int end)>& body);
+
+    // Threads taking part in run(), including the caller
+    static int getNumThreads();
+};
@@ -1,12 +1,13 @@
 // File: src/Utils/PixelateEffect.cpp
 #include "PixelateEffect.h"
+#include "ParallelFor.h"
 
 PixelateEffect::PixelateEffect() : Effect("pixelate") {
     // Initialize parameters with defaults
-    ensureParameter("sizeX", 16);
-    ensureParameter("sizeY", 16);
-    ensureParameter("dynamicSize", 1.0); // Boolean as float (1.0 = true)
-    ensureParameter("threshold", 0.5);
+    sizeXParam = addParameter("sizeX", 16);
+    sizeYParam = addParameter("sizeY", 16);
+    dynamicSizeParam = addParameter("dynamicSize", 1.0); // Boolean as float (1.0 = true)
+    thresholdParam = addParameter("threshold", 0.5);
 }
 
 PixelateEffect::~PixelateEffect() {
@@ -16,14 +17,6 @@ PixelateEffect::~PixelateEffect() {
 void PixelateEffect::setup(int width, int height) {
     Effect::setup(width, height);
     
-    // Initialize buffer FBO
-    bufferFbo.allocate(width, height, GL_RGBA);
-    
-    // Clear buffer
-    bufferFbo.begin();
-    ofClear(0, 0, 0, 0);
-    bufferFbo.end();
-    
     // Load pixelate shader
     if (!pixelateShader.isLoaded()) {
         bool loaded = pixelateShader.load("shaders/pixelate");
@@ -35,34 +28,27 @@ void PixelateEffect::setup(int width, int height) {
     }
 }
 
-void PixelateEffect::update(float phase, float* audioData, int numBands, map<string, float>& globalParams) {
+void PixelateEffect::update(const AudioFrame& audio, map<string, float>& globalParams) {
     // Apply global parameter scaling
-    if (globalParams.find("pixelate") != globalParams.end()) {
+    auto global = globalParams.find("pixelate");
+    if (global != globalParams.end()) {
         // Scale pixelate parameters by global parameter
-        float pixelateMultiplier = globalParams["pixelate"];
+        float pixelateMultiplier = global->second;
         if (pixelateMultiplier < 1.0) {
             // Scale down for higher resolution
-            params["sizeX"] *= pixelateMultiplier;
-            params["sizeY"] *= pixelateMultiplier;
+            param(sizeXParam) *= pixelateMultiplier;
+            param(sizeYParam) *= pixelateMultiplier;
         } else {
             // Scale up for lower resolution
-            params["sizeX"] *= pixelateMultiplier;
-            params["sizeY"] *= pixelateMultiplier;
+            param(sizeXParam) *= pixelateMultiplier;
+            param(sizeYParam) *= pixelateMultiplier;
         }
     }
     
     // Apply audio reactivity if dynamic size is enabled
-    if (params["dynamicSize"] > 0.5 && audioData != nullptr && numBands > 0) {
-        // Calculate energy in mid-high frequency range
-        float sum = 0.0f;
-        int startBand = numBands / 5;
-        int endBand = numBands / 2;
-        
-        for (int i = startBand; i < endBand && i < numBands; i++) {
-            sum += audioData[i];
-        }
-        
-        float energy = sum / (endBand - startBand);
+    if (param(dynamicSizeParam) > 0.5) {
+        // Use energy in the mid frequency range
+        float energy = getAudioEnergy(audio, AUDIO_BAND_MID);
         
         // Modulate pixel size with audio energy
         float minSize = 2.0;
@@ -70,13 +56,13 @@ void PixelateEffect::update(float phase, float* audioData, int numBands, map<str
         float newSize = minSize + (maxSize - minSize) * energy;
         
         // Smooth parameter changes
-        params["sizeX"] = params["sizeX"] * 0.8 + newSize * 0.2;
-        params["sizeY"] = params["sizeY"] * 0.8 + newSize * 0.2;
+        param(sizeXParam) = param(sizeXParam) * 0.8 + newSize * 0.2;
+        param(sizeYParam) = param(sizeYParam) * 0.8 + newSize * 0.2;
     }
     
     // Ensure minimum pixel size
-    params["sizeX"] = std::max(1.0f, params["sizeX"]);
-    params["sizeY"] = std::max(1.0f, params["sizeY"]);
+    param(sizeXParam) = std::max(1.0f, param(sizeXParam));
+    param(sizeYParam) = std::max(1.0f, param(sizeYParam));
 }
 
 void PixelateEffect::apply(ofFbo& inputFbo) {
@@ -85,19 +71,15 @@ void PixelateEffect::apply(ofFbo& inputFbo) {
         return;
     }
     
-    // Apply pixelation effect
-    bufferFbo.begin();
-    ofClear(0, 0, 0, 0);
-    
     // Use shader if available
     if (pixelateShader.isLoaded()) {
         // Apply pixelate shader
         pixelateShader.begin();
         
         // Set shader parameters
-        pixelateShader.setUniform1f("sizeX", params["sizeX"] * intensity);
-        pixelateShader.setUniform1f("sizeY", params["sizeY"] * intensity);
-        pixelateShader.setUniform1f("threshold", params["threshold"]);
+        pixelateShader.setUniform1f("sizeX", param(sizeXParam) * intensity);
+        pixelateShader.setUniform1f("sizeY", param(sizeYParam) * intensity);
+        pixelateShader.setUniform1f("threshold", param(thresholdParam));
         pixelateShader.setUniform2f("resolution", width, height);
         
         // Draw input using shader
@@ -105,56 +87,169 @@ void PixelateEffect::apply(ofFbo& inputFbo) {
         
         pixelateShader.end();
     } else {
-        // Fallback to CPU-based pixelation if shader not available
-        // This is less efficient but ensures the effect still works
-        
-        // Get pixels from input FBO
-        ofPixels inputPixels;
-        inputFbo.readToPixels(inputPixels);
-        
-        // Calculate pixel blocks
-        int pixelSizeX = std::max(1, (int)(params["sizeX"] * intensity));
-        int pixelSizeY = std::max(1, (int)(params["sizeY"] * intensity));
-        
-        // Draw pixelated version
-        ofSetColor(255);
+        // No shader: downsample and upsample on the GPU instead
+        applyReduced(inputFbo);
+    }
+}
+
+void PixelateEffect::applyReduced(ofFbo& inputFbo) {
+    // Full size, so changing block sizes never reallocate
+    if (!reducedFbo.isAllocated()) {
+        reducedFbo.allocate(width, height, GL_RGBA);
+        reducedFbo.getTexture().setTextureMinMagFilter(GL_NEAREST, GL_NEAREST);
+    }
+    
+    float sizeX = std::max(1.0f, param(sizeXParam) * intensity);
+    float sizeY = std::max(1.0f, param(sizeYParam) * intensity);
+    int blocksX = (int)ceil(width / sizeX);
+    int blocksY = (int)ceil(height / sizeY);
+    
+    ofPushStyle();
+    ofDisableAlphaBlending();
+    ofSetColor(255);
+    
+    // Downsample: one nearest texel per block
+    ofTexture& inputTexture = inputFbo.getTexture();
+    inputTexture.setTextureMinMagFilter(GL_NEAREST, GL_NEAREST);
+    reducedFbo.begin();
+    ofClear(0, 0, 0, 0);
+    inputTexture.draw(0, 0, width / sizeX, height / sizeY);
+    reducedFbo.end();
+    inputTexture.setTextureMinMagFilter(GL_LINEAR, GL_LINEAR);
+    
+    // Upsample: each texel back to a whole block
+    reducedFbo.getTexture().drawSubsection(0, 0, blocksX * sizeX, blocksY * sizeY, 0, 0, blocksX, blocksY);
+    
+    ofPopStyle();
+}
+
+void PixelateEffect::pixelatePixels(const ofPixels& src, ofPixels& dst, int sizeX, int sizeY, float threshold) {
+    int w = (int)src.getWidth();
+    int h = (int)src.getHeight();
+    int channels = (int)src.getNumChannels();
+    if (w == 0 || h == 0 || channels < 1 || channels > 4) {
+        ofLogError("PixelateEffect") << "Unsupported pixels for pixelation";
+        return;
+    }
+    
+    if (dst.getWidth() != src.getWidth() || dst.getHeight() != src.getHeight() || dst.getNumChannels() != src.getNumChannels()) {
+        dst.allocate(w, h, channels);
+    }
+    
+    sizeX = std::max(1, std::min(sizeX, w));
+    sizeY = std::max(1, std::min(sizeY, h));
+    int blocksX = (w + sizeX - 1) / sizeX;
+    int blocksY = (h + sizeY - 1) / sizeY;
+    int stride = w * channels;
+    
+    // Brightness test in integers: sum of rgb < threshold * 3 * 255, with
+    // the product in double so it is exact for any float threshold
+    int thresholdSum = threshold < 1.0 ? (int)ceil(threshold * 3.0 * 255.0) : 0;
+    bool useThreshold = threshold < 1.0 && channels >= 3;
+    
+    const unsigned char* srcData = src.getData();
+    unsigned char* dstData = dst.getData();
+    
+    // One task per row of blocks
+    ParallelFor::run(blocksY, [&](int begin, int end) {
+        // Per-block channel sums for one row of blocks, then one output row
+        vector<uint32_t> sums(blocksX * 4);
+        vector<unsigned char> row(stride);
         
-        for (int y = 0; y < height; y += pixelSizeY) {
-            for (int x = 0; x < width; x += pixelSizeX) {
-                // Get color from center of block
-                int sampleX = x + pixelSizeX / 2;
-                int sampleY = y + pixelSizeY / 2;
-                
-                // Ensure within bounds
-                sampleX = std::min(sampleX, width - 1);
-                sampleY = std::min(sampleY, height - 1);
+        for (int by = begin; by < end; by++) {
+            int y0 = by * sizeY;
+            int y1 = std::min(y0 + sizeY, h);
+            std::fill(sums.begin(), sums.end(), 0);
+            
+            // Accumulate: contiguous runs of one block's bytes, so the
+            // inner loop is a plain strided reduction
+            for (int y = y0; y < y1; y++) {
+                const unsigned char* line = srcData + (size_t)y * stride;
+                for (int bx = 0; bx < blocksX; bx++) {
+                    int x0 = bx * sizeX;
+                    int x1 = std::min(x0 + sizeX, w);
+                    uint32_t acc[4] = { 0, 0, 0, 0 };
+                    const unsigned char* p = line + x0 * channels;
+                    const unsigned char* pEnd = line + x1 * channels;
+                    if (channels == 4) {
+                        for (; p < pEnd; p += 4) {
+                            acc[0] += p[0];
+                            acc[1] += p[1];
+                            acc[2] += p[2];
+                            acc[3] += p[3];
+                        }
+                    } else {
+                        for (; p < pEnd; p += channels) {
+                            for (int c = 0; c < channels; c++) {
+                                acc[c] += p[c];
+                            }
+                        }
+                    }
+                    uint32_t* sum = &sums[bx * 4];
+                    sum[0] += acc[0];
+                    sum[1] += acc[1];
+                    sum[2] += acc[2];
+                    sum[3] += acc[3];
+                }
+            }
+            
+            // Average each block and write it across one output row
+            for (int bx = 0; bx < blocksX; bx++) {
+                int x0 = bx * sizeX;
+                int x1 = std::min(x0 + sizeX, w);
+                uint32_t count = (uint32_t)((x1 - x0) * (y1 - y0));
+                uint32_t* sum = &sums[bx * 4];
                 
-                ofColor color = inputPixels.getColor(sampleX, sampleY);
+                unsigned char average[4];
+                for (int c = 0; c < channels; c++) {
+                    average[c] = (unsigned char)((sum[c] + count / 2) / count);
+                }
+                if (useThreshold && average[0] + average[1] + average[2] < thresholdSum) {
+                    average[0] = average[1] = average[2] = 0;
+                }
                 
-                // Apply threshold if enabled
-                if (params["threshold"] < 1.0) {
-                    float brightness = color.getBrightness() / 255.0f;
-                    if (brightness < params["threshold"]) {
-                        color = ofColor(0, 0, 0, color.a);
+                unsigned char* out = &row[x0 * channels];
+                for (int x = x0; x < x1; x++) {
+                    for (int c = 0; c < channels; c++) {
+                        *out++ = average[c];
                     }
                 }
-                
-                ofSetColor(color);
-                ofDrawRectangle(x, y, pixelSizeX, pixelSizeY);
             }
+            
+            // Every line of the block is the same
+            for (int y = y0; y < y1; y++) {
+                memcpy(dstData + (size_t)y * stride, row.data(), stride);
+            }
+        }
+    });
+}
+
+string PixelateEffect::getStageSource() {
+    // Same math as pixelate.frag
+    return R"(
+uniform vec2 $pixelSize;
+uniform float $threshold;
+
+vec2 $uv(vec2 uv) {
+    return floor(uv / $pixelSize) * $pixelSize + ($pixelSize * 0.5);
+}
+
+vec4 $color(vec4 color, vec2 uv) {
+    if ($threshold < 1.0) {
+        float brightness = (color.r + color.g + color.b) / 3.0;
+        if (brightness < $threshold) {
+            color = vec4(0.0, 0.0, 0.0, color.a);
         }
     }
-    
-    bufferFbo.end();
-    
-    // Draw result to input FBO
-    ofPushStyle();
-    ofSetColor(255, 255, 255, 255);
-    ofEnableAlphaBlending();
-    
-    inputFbo.begin();
-    bufferFbo.draw(0, 0);
-    inputFbo.end();
-    
-    ofPopStyle();
-}
\ No newline at end of file
+    return color;
+}
+)";
+}
+
+void PixelateEffect::setStageUniforms(ofShader& shader, const string& prefix) {
+    // Block size in texture coordinates
+    float sizeX = std::max(1.0f, param(sizeXParam) * intensity);
+    float sizeY = std::max(1.0f, param(sizeYParam) * intensity);
+    shader.setUniform2f(prefix + "pixelSize", sizeX / width, sizeY / height);
+    shader.setUniform1f(prefix + "threshold", param(thresholdParam));
+}
@@ -12,15 +12,32 @@ public:
     void setup(int width, int height) override;
     
     // Update the effect
-    void update(float phase, float* audioData, int numBands, map<string, float>& globalParams) override;
+    void update(const AudioFrame& audio, map<string, float>& globalParams) override;
     
     // Apply the effect to an input FBO
     void apply(ofFbo& inputFbo) override;
     
+    // Fusable stage: quantized uv plus the brightness threshold
+    bool isFusable() override { return true; }
+    string getStageSource() override;
+    void setStageUniforms(ofShader& shader, const string& prefix) override;
+    
+    // CPU pixelation for headless use: each sizeX x sizeY block becomes its
+    // average color, and blocks darker than threshold turn black (threshold
+    // 1 disables it; single channel pixels are never thresholded). dst is
+    // allocated to match src
+    static void pixelatePixels(const ofPixels& src, ofPixels& dst, int sizeX, int sizeY, float threshold);
+    
 private:
     // Shader for pixelation
     ofShader pixelateShader;
     
-    // Buffer for processing
-    ofFbo bufferFbo;
+    // Shader-free fallback: the input is drawn shrunk into the corner of
+    // this FBO, one texel per block, then stretched back with nearest
+    // filtering
+    ofFbo reducedFbo;
+    void applyReduced(ofFbo& inputFbo);
+    
+    // Parameter handles
+    int sizeXParam, sizeYParam, dynamicSizeParam, thresholdParam;
 };
\ No newline at end of file
@@ -0,0 +1,81 @@
+// File: src/Utils/RingBuffer.h
+#pragma once
+
+#include "ofMain.h"
+#include <atomic>
+
+// Lock-free single-producer/single-consumer ring buffer.
+// One thread may call write(), one other thread may call read()/available().
+// Indices grow monotonically and are masked into a power-of-two buffer.
+template<typename T>
+class RingBuffer {
+public:
+    RingBuffer() : mask(0), writeIndex(0), readIndex(0) {}
+
+    // Allocate storage; only call while no other thread is using the buffer
+    void setup(size_t capacity) {
+        size_t powerOfTwo = 1;
+        while (powerOfTwo < capacity) {
+            powerOfTwo <<= 1;
+        }
+        buffer.assign(powerOfTwo, T());
+        mask = powerOfTwo - 1;
+        reset();
+    }
+
+    // Drop all contents; only call while no other thread is using the buffer
+    void reset() {
+        writeIndex.store(0, std::memory_order_relaxed);
+        readIndex.store(0, std::memory_order_relaxed);
+    }
+
+    // Producer: append up to count items, returns how many fit
+    size_t write(const T* data, size_t count) {
+        size_t w = writeIndex.load(std::memory_order_relaxed);
+        size_t r = readIndex.load(std::memory_order_acquire);
+        size_t space = buffer.size() - (w - r);
+        if (count > space) count = space;
+
+        for (size_t i = 0; i < count; i++) {
+            buffer[(w + i) & mask] = data[i];
+        }
+
+        writeIndex.store(w + count, std::memory_order_release);
+        return count;
+    }
+
+    // Consumer: remove up to count items, returns how many were read
+    size_t read(T* data, size_t count) {
+        size_t r = readIndex.load(std::memory_order_relaxed);
+        size_t w = writeIndex.load(std::memory_order_acquire);
+        size_t filled = w - r;
+        if (count > filled) count = filled;
+
+        for (size_t i = 0; i < count; i++) {
+            data[i] = buffer[(r + i) & mask];
+        }
+
+        readIndex.store(r + count, std::memory_order_release);
+        return count;
+    }
+
+    // Consumer: number of items ready to read
+    size_t available() const {
+        return writeIndex.load(std::memory_order_acquire) - readIndex.load(std::memory_order_relaxed);
+    }
+
+    size_t getCapacity() const { return buffer.size(); }
+
+private:
+    vector<T> buffer;
+    size_t mask;
+
+    // Keep the indices on separate cache lines so the two threads don't
+    // contend. Padding rather than alignas(64), so new needs no
+    // over-aligned allocation
+    char paddingBefore[64];
+    std::atomic<size_t> writeIndex;
+    char paddingBetween[64 - sizeof(std::atomic<size_t>)];
+    std::atomic<size_t> readIndex;
+    char paddingAfter[64 - sizeof(std::atomic<size_t>)];
+};
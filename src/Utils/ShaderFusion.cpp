@@ -0,0 +1,144 @@
+// File: src/Utils/ShaderFusion.cpp
+#include "ShaderFusion.h"
+
+namespace {
+
+// Standard vertex shader, as in pixelate.vert
+const string fusedVertexSource = R"(#version 150
+
+uniform mat4 modelViewProjectionMatrix;
+
+in vec4 position;
+in vec2 texcoord;
+
+out vec2 texCoordVarying;
+
+void main() {
+    texCoordVarying = texcoord;
+    gl_Position = modelViewProjectionMatrix * position;
+}
+)";
+
+}
+
+ShaderFusion::ShaderFusion() {
+    activeShader = nullptr;
+}
+
+ShaderFusion::~ShaderFusion() {
+    clear();
+}
+
+void ShaderFusion::clear() {
+    for (auto& entry : cache) {
+        delete entry.second;
+    }
+    cache.clear();
+    activeShader = nullptr;
+}
+
+string ShaderFusion::getStagePrefix(int index) {
+    return "s" + ofToString(index) + "_";
+}
+
+string ShaderFusion::getSignature(const vector<Effect*>& stages) {
+    string signature;
+    for (auto stage : stages) {
+        signature += stage->getName() + "|";
+    }
+    return signature;
+}
+
+ofShader* ShaderFusion::getShader(const vector<Effect*>& stages) {
+    if (stages.empty()) return nullptr;
+    
+    string signature = getSignature(stages);
+    auto it = cache.find(signature);
+    if (it != cache.end()) {
+        return it->second;
+    }
+    
+    // Compile once per signature, failures included
+    ofShader* shader = compile(stages);
+    cache[signature] = shader;
+    return shader;
+}
+
+bool ShaderFusion::begin(const vector<Effect*>& stages) {
+    ofShader* shader = getShader(stages);
+    if (shader == nullptr) return false;
+    
+    shader->begin();
+    for (int i = 0; i < (int)stages.size(); i++) {
+        stages[i]->setStageUniforms(*shader, getStagePrefix(i));
+    }
+    activeShader = shader;
+    return true;
+}
+
+void ShaderFusion::end() {
+    if (activeShader != nullptr) {
+        activeShader->end();
+        activeShader = nullptr;
+    }
+}
+
+string ShaderFusion::buildFragmentSource(const vector<Effect*>& stages) {
+    int count = (int)stages.size();
+    
+    string source = "#version 150\n\n";
+    source += "uniform sampler2D tex0;\n\n";
+    source += "in vec2 texCoordVarying;\n";
+    source += "out vec4 outputColor;\n";
+    
+    // Stage sources with their placeholder replaced by a unique prefix
+    for (int i = 0; i < count; i++) {
+        source += "\n// Stage " + ofToString(i) + ": " + stages[i]->getName() + "\n";
+        string stageSource = stages[i]->getStageSource();
+        ofStringReplace(stageSource, "$", getStagePrefix(i));
+        source += stageSource;
+    }
+    
+    source += "\nvoid main() {\n";
+    
+    // Coordinates run backwards: the last stage decides where the one
+    // before it is read, down to the single texture fetch of stage 0.
+    // uv_i is where stage i samples its input
+    string next = "texCoordVarying";
+    for (int i = count - 1; i >= 0; i--) {
+        string uv = "uv" + ofToString(i);
+        source += "    vec2 " + uv + " = clamp(" + getStagePrefix(i) + "uv(" + next + "), 0.0, 1.0);\n";
+        next = uv;
+    }
+    source += "    vec4 color = texture(tex0, uv0);\n";
+    
+    // Colors run forwards, each stage working on the previous result
+    for (int i = 0; i < count; i++) {
+        source += "    color = " + getStagePrefix(i) + "color(color, uv" + ofToString(i) + ");\n";
+    }
+    
+    source += "    outputColor = color;\n";
+    source += "}\n";
+    return source;
+}
+
+ofShader* ShaderFusion::compile(const vector<Effect*>& stages) {
+    string fragmentSource = buildFragmentSource(stages);
+    
+    ofShader* shader = new ofShader();
+    bool ok = shader->setupShaderFromSource(GL_VERTEX_SHADER, fusedVertexSource);
+    ok = ok && shader->setupShaderFromSource(GL_FRAGMENT_SHADER, fragmentSource);
+    if (ok) {
+        shader->bindDefaults();
+        ok = shader->linkProgram();
+    }
+    
+    if (!ok) {
+        ofLogError("ShaderFusion") << "Failed to build fused shader for " << getSignature(stages);
+        delete shader;
+        return nullptr;
+    }
+    
+    ofLogNotice("ShaderFusion") << "Fused " << stages.size() << " stages: " << getSignature(stages);
+    return shader;
+}
@@ -0,0 +1,39 @@
+// File: src/Utils/ShaderFusion.h
+#pragma once
+
+#include "ofMain.h"
+#include "Effect.h"
+
+// Generates one fragment shader from a run of consecutive fusable effects
+// so the run costs a single full-screen pass. Programs are cached by the
+// chain signature (the stage names in order); a signature that fails to
+// compile is remembered so the caller can fall back to separate passes.
+class ShaderFusion {
+public:
+    ShaderFusion();
+    ~ShaderFusion();
+    
+    // Fused program for the stages, or nullptr if it could not be built
+    ofShader* getShader(const vector<Effect*>& stages);
+    
+    // Bind the fused program for the stages and set every stage's uniforms.
+    // Returns false, with nothing bound, if the stages cannot be fused
+    bool begin(const vector<Effect*>& stages);
+    void end();
+    
+    // Uniform and function prefix of the stage at an index
+    static string getStagePrefix(int index);
+    
+    // Drop every cached program
+    void clear();
+    
+private:
+    // Signature -> program, nullptr for signatures that failed
+    map<string, ofShader*> cache;
+    
+    ofShader* activeShader;
+    
+    string getSignature(const vector<Effect*>& stages);
+    string buildFragmentSource(const vector<Effect*>& stages);
+    ofShader* compile(const vector<Effect*>& stages);
+};
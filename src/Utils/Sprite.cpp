@@ -1,236 +1,126 @@
 // File: src/Utils/Sprite.cpp
 #include "Sprite.h"
+#include "GifDecoder.h"
 
 //--------------------------------------------------------------
 // Base Sprite Implementation
 //--------------------------------------------------------------
 
 Sprite::Sprite() {
-    // Default properties
+    // Default properties live in SpriteState until attached
     id = "";
-    x = 0.5;
-    y = 0.5;
-    scale = 1.0;
-    rotation = 0.0;
-    
-    motionSpeed = ofVec2f(0, 0);
-    rotationSpeed = 0.0;
-    motionType = MOTION_NONE;
-    opacity = 1.0;
-    motionAmount = 1.0;
+    system = nullptr;
+    handle = -1;
     
     maxTrailLength = 0;
-    
-    // Motion parameters
-    circleRadius = 0.1;
-    circlePhase = 0.0;
-    waveAmplitudeX = 0.1;
-    waveAmplitudeY = 0.1;
-    waveFrequencyX = 1.0;
-    waveFrequencyY = 1.0;
-    wavePhaseX = 0.0;
-    wavePhaseY = PI / 2.0; // 90 degrees offset
-    basePosition = ofVec2f(0.5, 0.5);
-    
-    // Audio reactivity
-    audioReactivity = 0.5;
-    reactsTo = "all";
 }
 
 Sprite::~Sprite() {
-    // Clean up resources
+    // Release the slot in the system
+    if (system != nullptr) {
+        system->remove(handle);
+    }
 }
 
 void Sprite::setup(float x, float y, float scale, float rotation) {
-    this->x = x;
-    this->y = y;
-    this->scale = scale;
-    this->rotation = rotation;
+    setX(x);
+    setY(y);
+    setScale(scale);
+    setRotation(rotation);
     
     // Save base position for motion patterns
-    basePosition = ofVec2f(x, y);
+    value(&SpriteSystem::baseX, state.baseX) = x;
+    value(&SpriteSystem::baseY, state.baseY) = y;
 }
 
-void Sprite::update(float deltaTime, float* audioData, int numBands) {
-    // Store previous position for trail
-    if (maxTrailLength > 0) {
-        TrailPoint point;
-        point.x = x;
-        point.y = y;
-        point.scale = scale;
-        point.rotation = rotation;
-        point.opacity = opacity;
-        
-        trail.insert(trail.begin(), point);
-        
-        // Trim trail to max length
-        if (trail.size() > maxTrailLength) {
-            trail.resize(maxTrailLength);
-        }
-    }
+void Sprite::attach(SpriteSystem* system) {
+    if (this->system == system) return;
+    detach();
     
-    // Apply audio reactivity if available
-    if (audioData != nullptr && numBands > 0) {
-        applyAudioReactivity(audioData, numBands);
+    if (system != nullptr) {
+        handle = system->add(state);
+        this->system = system;
     }
-    
-    // Apply motion based on type
-    applyMotion(deltaTime);
-    
-    // Update rotation
-    rotation += rotationSpeed * deltaTime;
-    
-    // Keep rotation in range [0, TWO_PI]
-    rotation = fmodf(rotation, TWO_PI);
 }
 
-void Sprite::draw(int canvasWidth, int canvasHeight) {
-    // Draw trail if enabled
-    if (maxTrailLength > 0 && trail.size() > 0) {
-        drawTrail(canvasWidth, canvasHeight);
-    }
+void Sprite::detach() {
+    if (system == nullptr) return;
     
-    // Base class doesn't draw anything else
+    state = system->get(handle);
+    system->remove(handle);
+    system = nullptr;
+    handle = -1;
 }
 
-float Sprite::getAudioEnergy(float* audioData, int numBands, string range) {
-    if (audioData == nullptr || numBands <= 0) {
-        return 0.0;
-    }
-    
-    int startBin = 0;
-    int endBin = numBands - 1;
-    
-    // Map frequency ranges to different parts of the spectrum
-    if (range == "bass") {
-        endBin = numBands / 4;
-    } else if (range == "mid") {
-        startBin = numBands / 4;
-        endBin = numBands * 3 / 4;
-    } else if (range == "high") {
-        startBin = numBands * 3 / 4;
-    }
-    
-    // Calculate energy in the selected range
-    float sum = 0.0;
-    for (int i = startBin; i <= endBin; i++) {
-        sum += audioData[i];
-    }
-    
-    // Normalize by number of bands
-    return sum / (endBin - startBin + 1);
+void Sprite::setMotionSpeed(float amount) {
+    float& motionAmount = value(&SpriteSystem::motionAmount, state.motionAmount);
+    ofVec2f speed = getMotionSpeed();
+    setMotionSpeed(ofVec2f(speed.x * amount / motionAmount, speed.y * amount / motionAmount));
+    motionAmount = amount;
 }
 
-void Sprite::applyAudioReactivity(float* audioData, int numBands) {
-    if (audioReactivity <= 0.0) return;
-    
-    // Get energy in the frequency range this sprite reacts to
-    float energy = getAudioEnergy(audioData, numBands, reactsTo);
-    
-    // Apply energy to sprite properties based on reactivity
-    float impact = energy * audioReactivity;
-    
-    // Scale up temporarily with audio energy
-    scale = scale * 0.9 + (scale * (1.0 + impact)) * 0.1;
-    
-    // Increase rotation speed with audio
-    rotationSpeed += impact * 0.1;
-    
-    // Optionally modify other properties based on audio
-    // opacity = 0.5 + impact * 0.5;
+MotionType Sprite::getMotionType() {
+    if (system != nullptr) {
+        return system->get(handle).motionType;
+    }
+    return state.motionType;
 }
 
-void Sprite::applyMotion(float deltaTime) {
-    // Apply different motion types
-    switch (motionType) {
-        case MOTION_LINEAR:
-            // Linear motion - update position based on speed
-            x += motionSpeed.x * deltaTime;
-            y += motionSpeed.y * deltaTime;
-            
-            // Wrap around edges
-            if (x < 0) x = 1;
-            if (x > 1) x = 0;
-            if (y < 0) y = 1;
-            if (y > 1) y = 0;
-            break;
-            
-        case MOTION_CIRCULAR:
-            applyCircularMotion(deltaTime);
-            break;
-            
-        case MOTION_BOUNCE:
-            applyBounceMotion(deltaTime);
-            break;
-            
-        case MOTION_WAVE:
-            applyWaveMotion(deltaTime);
-            break;
-            
-        case MOTION_FOLLOW:
-            // Follow motion would require a target
-            // Not implemented in base class
-            break;
-            
-        case MOTION_NONE:
-        default:
-            // No motion
-            break;
+void Sprite::setMotionType(MotionType type) {
+    if (system != nullptr) {
+        system->setMotionType(handle, type);
+    } else {
+        state.motionType = type;
     }
 }
 
-void Sprite::applyCircularMotion(float deltaTime) {
-    // Update circle phase
-    circlePhase += deltaTime * motionAmount;
-    
-    // Calculate new position on circle
-    x = basePosition.x + cos(circlePhase) * circleRadius;
-    y = basePosition.y + sin(circlePhase) * circleRadius;
-    
-    // Optional: rotate to face movement direction
-    rotation = circlePhase + PI/2;
+void Sprite::setReactsTo(int band) {
+    if (system != nullptr) {
+        SpriteState current = system->get(handle);
+        current.reactsTo = band;
+        system->set(handle, current);
+    } else {
+        state.reactsTo = band;
+    }
 }
 
-void Sprite::applyBounceMotion(float deltaTime) {
-    // Move according to current speed
-    x += motionSpeed.x * deltaTime * motionAmount;
-    y += motionSpeed.y * deltaTime * motionAmount;
-    
-    // Check for bounce on edges
-    if (x <= 0 || x >= 1) {
-        motionSpeed.x = -motionSpeed.x;
+void Sprite::update(float deltaTime, const AudioFrame& audio) {
+    // Store previous position for trail; the system moves the sprite after this
+    if (maxTrailLength > 0) {
+        TrailPoint point;
+        point.x = getX();
+        point.y = getY();
+        point.scale = getScale();
+        point.rotation = getRotation();
+        point.opacity = getOpacity();
         
-        // Ensure we're not stuck at the edge
-        if (x <= 0) x = 0.01;
-        if (x >= 1) x = 0.99;
+        // Overwrites the oldest point once full
+        trail.push(point);
     }
-    
-    if (y <= 0 || y >= 1) {
-        motionSpeed.y = -motionSpeed.y;
-        
-        // Ensure we're not stuck at the edge
-        if (y <= 0) y = 0.01;
-        if (y >= 1) y = 0.99;
+}
+
+void Sprite::setMaxTrailLength(int length) {
+    length = std::max(0, length);
+    if (length == maxTrailLength) return;
+    
+    // Reallocate once, keeping the newest points that still fit
+    CircularBuffer<TrailPoint> resized;
+    resized.setup(length);
+    int keep = std::min((int)trail.size(), length);
+    for (int i = keep - 1; i >= 0; i--) {
+        resized.push(getTrailPoint(i));
     }
+    trail = resized;
+    maxTrailLength = length;
 }
 
-void Sprite::applyWaveMotion(float deltaTime) {
-    // Update wave phases
-    wavePhaseX += deltaTime * waveFrequencyX * motionAmount;
-    wavePhaseY += deltaTime * waveFrequencyY * motionAmount;
-    
-    // Calculate wave movement
-    float waveX = cos(wavePhaseX) * waveAmplitudeX;
-    float waveY = sin(wavePhaseY) * waveAmplitudeY;
-    
-    // Apply to base position
-    x = basePosition.x + waveX;
-    y = basePosition.y + waveY;
-    
-    // Optional: rotate to follow wave direction
-    float dx = -sin(wavePhaseX) * waveAmplitudeX * waveFrequencyX;
-    float dy = cos(wavePhaseY) * waveAmplitudeY * waveFrequencyY;
-    rotation = atan2(dy, dx);
+void Sprite::draw(int canvasWidth, int canvasHeight) {
+    // Draw trail if enabled
+    if (maxTrailLength > 0 && trail.size() > 0) {
+        drawTrail(canvasWidth, canvasHeight);
+    }
+    
+    // Base class doesn't draw anything else
 }
 
 void Sprite::drawTrail(int canvasWidth, int canvasHeight) {
@@ -258,18 +148,18 @@ void BasicSprite::setup(float x, float y, float scale, float rotation, ofColor c
     this->color = color;
     
     // Set default motion parameters
-    motionSpeed = ofVec2f((ofRandom(0, 1) - 0.5) * 0.1, (ofRandom(0, 1) - 0.5) * 0.1);
-    rotationSpeed = ofRandom(-0.5, 0.5);
-    motionType = MOTION_LINEAR;
+    setMotionSpeed(ofVec2f((ofRandom(0, 1) - 0.5) * 0.1, (ofRandom(0, 1) - 0.5) * 0.1));
+    setRotationSpeed(ofRandom(-0.5, 0.5));
+    setMotionType(MOTION_LINEAR);
     
     // Random audio reactivity
     float reactType = ofRandom(0, 3);
     if (reactType < 1) {
-        reactsTo = "bass";
+        setReactsTo(AUDIO_BAND_BASS);
     } else if (reactType < 2) {
-        reactsTo = "mid";
+        setReactsTo(AUDIO_BAND_MID);
     } else {
-        reactsTo = "high";
+        setReactsTo(AUDIO_BAND_HIGH);
     }
 }
 
@@ -281,16 +171,17 @@ void BasicSprite::draw(int canvasWidth, int canvasHeight) {
     ofPushStyle();
     
     // Convert normalized coordinates to pixels
-    float pixelX = x * canvasWidth;
-    float pixelY = y * canvasHeight;
+    float pixelX = getX() * canvasWidth;
+    float pixelY = getY() * canvasHeight;
+    float scale = getScale();
     
     // Apply transformations
     ofTranslate(pixelX, pixelY);
-    ofRotateZDeg(ofRadToDeg(rotation));
+    ofRotateZDeg(ofRadToDeg(getRotation()));
     ofScale(scale, scale);
     
     // Set color and opacity
-    ofSetColor(color, opacity * 255);
+    ofSetColor(color, getOpacity() * 255);
     
     // Draw a simple shape
     ofDrawCircle(0, 0, 20);
@@ -303,19 +194,20 @@ void BasicSprite::drawTrail(int canvasWidth, int canvasHeight) {
     ofPushStyle();
     
     // Draw trail with decreasing opacity
-    for (int i = 0; i < trail.size(); i++) {
-        float trailOpacity = trail[i].opacity * (1.0 - (float)i / trail.size());
+    for (int i = 0; i < (int)trail.size(); i++) {
+        const TrailPoint& point = getTrailPoint(i);
+        float trailOpacity = point.opacity * (1.0 - (float)i / trail.size());
         
         // Convert normalized coordinates to pixels
-        float pixelX = trail[i].x * canvasWidth;
-        float pixelY = trail[i].y * canvasHeight;
+        float pixelX = point.x * canvasWidth;
+        float pixelY = point.y * canvasHeight;
         
         ofPushMatrix();
         
         // Apply transformations
         ofTranslate(pixelX, pixelY);
-        ofRotateZDeg(ofRadToDeg(trail[i].rotation));
-        ofScale(trail[i].scale, trail[i].scale);
+        ofRotateZDeg(ofRadToDeg(point.rotation));
+        ofScale(point.scale, point.scale);
         
         // Set color with trail opacity
         ofSetColor(color, trailOpacity * 128);
@@ -329,6 +221,18 @@ void BasicSprite::drawTrail(int canvasWidth, int canvasHeight) {
     ofPopStyle();
 }
 
+void BasicSprite::addToBatch(SpriteBatch& batch, int canvasWidth, int canvasHeight) {
+    // Trail first, smaller and at half opacity, as in drawTrail
+    for (int i = 0; i < (int)trail.size(); i++) {
+        const TrailPoint& point = getTrailPoint(i);
+        float trailOpacity = point.opacity * (1.0 - (float)i / trail.size());
+        batch.addCircle(point.x * canvasWidth, point.y * canvasHeight, point.rotation,
+                        point.scale, 15, color, trailOpacity * 0.5);
+    }
+    
+    batch.addCircle(getX() * canvasWidth, getY() * canvasHeight, getRotation(), getScale(), 20, color, getOpacity());
+}
+
 //--------------------------------------------------------------
 // GIF Sprite Implementation
 //--------------------------------------------------------------
@@ -343,7 +247,6 @@ GifSprite::GifSprite() : Sprite() {
 
 GifSprite::~GifSprite() {
     // Clean up resources
-    frames.clear();
 }
 
 void GifSprite::setup(string path, float x, float y, float scale, float rotation) {
@@ -353,45 +256,57 @@ void GifSprite::setup(string path, float x, float y, float scale, float rotation
     // Set path and load GIF
     this->path = path;
     
+    // Sprites of the same file share one atlas
+    atlas = SpriteBatch::findAtlas(path);
+    
     // Try to load as animated GIF
     if (!loadGif(path)) {
         // Fall back to single image
-        image.load(path);
         isAnimated = false;
+        frameDurations.clear();
+        
+        ofPixels pixels;
+        if (!atlas && ofLoadImage(pixels, path)) {
+            atlas = SpriteBatch::createAtlas(pixels.getWidth(), pixels.getHeight(), pixels.getNumChannels(), 1);
+            if (atlas) {
+                SpriteBatch::setAtlasFrame(*atlas, 0, pixels);
+                SpriteBatch::finishAtlas(path, atlas);
+            }
+        }
     }
     
     // Set default motion parameters
-    motionSpeed = ofVec2f((ofRandom(0, 1) - 0.5) * 0.1, (ofRandom(0, 1) - 0.5) * 0.1);
-    rotationSpeed = ofRandom(-0.2, 0.2);
-    motionType = MOTION_LINEAR;
+    setMotionSpeed(ofVec2f((ofRandom(0, 1) - 0.5) * 0.1, (ofRandom(0, 1) - 0.5) * 0.1));
+    setRotationSpeed(ofRandom(-0.2, 0.2));
+    setMotionType(MOTION_LINEAR);
     
     // Random audio reactivity
     float reactType = ofRandom(0, 3);
     if (reactType < 1) {
-        reactsTo = "bass";
+        setReactsTo(AUDIO_BAND_BASS);
     } else if (reactType < 2) {
-        reactsTo = "mid";
+        setReactsTo(AUDIO_BAND_MID);
     } else {
-        reactsTo = "high";
+        setReactsTo(AUDIO_BAND_HIGH);
     }
 }
 
-void GifSprite::update(float deltaTime, float* audioData, int numBands) {
+void GifSprite::update(float deltaTime, const AudioFrame& audio) {
     // Call base update
-    Sprite::update(deltaTime, audioData, numBands);
+    Sprite::update(deltaTime, audio);
     
     // Update animation if animated
-    if (isAnimated && isPlaying && frames.size() > 0) {
+    if (isAnimated && isPlaying && frameDurations.size() > 0) {
         frameTime += deltaTime;
         
         // Check if it's time to advance to next frame
-        float frameDuration = (currentFrame < frameDurations.size()) ? 
-                             frameDurations[currentFrame] : 0.1; // Default 100ms
+        float frameDuration = frameDurations[currentFrame];
         
         if (frameTime >= frameDuration) {
-            // Advance to next frame
-            currentFrame = (currentFrame + 1) % frames.size();
-            frameTime = 0;
+            // Advance to next frame, carrying the overshoot (at most one
+            // frame's worth after a stall) so per-frame delays keep time
+            currentFrame = (currentFrame + 1) % frameDurations.size();
+            frameTime = min(frameTime - frameDuration, frameDuration);
         }
     }
 }
@@ -404,25 +319,21 @@ void GifSprite::draw(int canvasWidth, int canvasHeight) {
     ofPushStyle();
     
     // Convert normalized coordinates to pixels
-    float pixelX = x * canvasWidth;
-    float pixelY = y * canvasHeight;
+    float pixelX = getX() * canvasWidth;
+    float pixelY = getY() * canvasHeight;
+    float scale = getScale();
     
     // Apply transformations
     ofTranslate(pixelX, pixelY);
-    ofRotateZDeg(ofRadToDeg(rotation));
+    ofRotateZDeg(ofRadToDeg(getRotation()));
     ofScale(scale, scale);
     
     // Set opacity
-    ofSetColor(255, 255, 255, opacity * 255);
+    ofSetColor(255, 255, 255, getOpacity() * 255);
     
     // Draw current frame
-    if (isAnimated && frames.size() > 0) {
-        // Draw current animation frame
-        ofImage& frame = frames[currentFrame];
-        frame.draw(-frame.getWidth() / 2, -frame.getHeight() / 2);
-    } else if (image.isAllocated()) {
-        // Draw static image
-        image.draw(-image.getWidth() / 2, -image.getHeight() / 2);
+    if (atlas) {
+        SpriteBatch::drawAtlasFrame(*atlas, isAnimated ? currentFrame : 0);
     }
     
     ofPopStyle();
@@ -433,30 +344,27 @@ void GifSprite::drawTrail(int canvasWidth, int canvasHeight) {
     ofPushStyle();
     
     // Draw trail with decreasing opacity
-    for (int i = 0; i < trail.size(); i++) {
-        float trailOpacity = trail[i].opacity * (1.0 - (float)i / trail.size());
+    for (int i = 0; i < (int)trail.size(); i++) {
+        const TrailPoint& point = getTrailPoint(i);
+        float trailOpacity = point.opacity * (1.0 - (float)i / trail.size());
         
         // Convert normalized coordinates to pixels
-        float pixelX = trail[i].x * canvasWidth;
-        float pixelY = trail[i].y * canvasHeight;
+        float pixelX = point.x * canvasWidth;
+        float pixelY = point.y * canvasHeight;
         
         ofPushMatrix();
         
         // Apply transformations
         ofTranslate(pixelX, pixelY);
-        ofRotateZDeg(ofRadToDeg(trail[i].rotation));
-        ofScale(trail[i].scale * 0.8, trail[i].scale * 0.8); // Slightly smaller for trail
+        ofRotateZDeg(ofRadToDeg(point.rotation));
+        ofScale(point.scale * 0.8, point.scale * 0.8); // Slightly smaller for trail
         
         // Set opacity for trail
         ofSetColor(255, 255, 255, trailOpacity * 128);
         
-        // Draw the image for the trail
-        if (isAnimated && frames.size() > 0) {
-            // Use a consistent frame for the trail (e.g., frame 0)
-            ofImage& frame = frames[0];
-            frame.draw(-frame.getWidth() / 2, -frame.getHeight() / 2);
-        } else if (image.isAllocated()) {
-            image.draw(-image.getWidth() / 2, -image.getHeight() / 2);
+        // Use a consistent frame for the trail (frame 0)
+        if (atlas) {
+            SpriteBatch::drawAtlasFrame(*atlas, 0);
         }
         
         ofPopMatrix();
@@ -465,9 +373,26 @@ void GifSprite::drawTrail(int canvasWidth, int canvasHeight) {
     ofPopStyle();
 }
 
+void GifSprite::addToBatch(SpriteBatch& batch, int canvasWidth, int canvasHeight) {
+    if (!atlas) return;
+    
+    // Trail uses the first frame, slightly smaller, as in drawTrail
+    for (int i = 0; i < (int)trail.size(); i++) {
+        const TrailPoint& point = getTrailPoint(i);
+        float trailOpacity = point.opacity * (1.0 - (float)i / trail.size());
+        batch.addImage(atlas.get(), 0, point.x * canvasWidth, point.y * canvasHeight,
+                       point.rotation, point.scale * 0.8, trailOpacity * 0.5);
+    }
+    
+    int frame = isAnimated ? currentFrame : 0;
+    batch.addImage(atlas.get(), frame, getX() * canvasWidth, getY() * canvasHeight, getRotation(), getScale(), getOpacity());
+}
+
 bool GifSprite::loadGif(string path) {
-    // In a real implementation, this would use ofxGif or similar addon
-    // Since we don't have that in this example, we'll simulate it
+    // Other formats load as a single image
+    if (ofToLower(ofFilePath::getFileExt(path)) != "gif") {
+        return false;
+    }
     
     // Check if file exists
     if (!ofFile::doesFileExist(path)) {
@@ -475,26 +400,34 @@ bool GifSprite::loadGif(string path) {
         return false;
     }
     
-    // For this example, we'll just load a single image
-    // and pretend we have multiple frames for demo purposes
-    
-    ofImage tempImage;
-    bool loaded = tempImage.load(path);
-    
-    if (!loaded) {
-        ofLogError("GifSprite") << "Failed to load image: " << path;
+    GifDecoder decoder;
+    if (!decoder.open(path)) {
         return false;
     }
     
-    // Simulate multiple frames
-    isAnimated = true;
-    frames.clear();
+    // Walk the frames for their timing without decoding any pixels
     frameDurations.clear();
+    while (decoder.skipFrame()) {
+        frameDurations.push_back(decoder.getFrameDuration());
+    }
     
-    // Create 4 frames (in a real implementation, these would be actual GIF frames)
-    for (int i = 0; i < 4; i++) {
-        frames.push_back(tempImage);
-        frameDurations.push_back(0.1); // 100ms per frame
+    if (frameDurations.empty()) {
+        ofLogError("GifSprite") << "No frames in " << path;
+        return false;
+    }
+    
+    // A single frame is just a still image
+    isAnimated = frameDurations.size() > 1;
+    
+    // Decode again, compositing each frame straight into its atlas cell
+    if (!atlas && decoder.open(path)) {
+        atlas = SpriteBatch::createAtlas(decoder.getWidth(), decoder.getHeight(), 4, (int)frameDurations.size());
+        if (atlas) {
+            for (int frame = 0; frame < atlas->frameCount && decoder.nextFrame(); frame++) {
+                SpriteBatch::setAtlasFrame(*atlas, frame, decoder.getCanvas());
+            }
+            SpriteBatch::finishAtlas(path, atlas);
+        }
     }
     
     currentFrame = 0;
@@ -504,7 +437,7 @@ bool GifSprite::loadGif(string path) {
 }
 
 void GifSprite::setFrame(int frame) {
-    if (isAnimated && frame >= 0 && frame < frames.size()) {
+    if (isAnimated && frame >= 0 && frame < (int)frameDurations.size()) {
         currentFrame = frame;
         frameTime = 0;
     }
@@ -2,16 +2,14 @@
 #pragma once
 
 #include "ofMain.h"
+#include "AudioFrame.h"
+#include "SpriteBatch.h"
+#include "SpriteSystem.h"
+#include "CircularBuffer.h"
 
-enum MotionType {
-    MOTION_NONE,
-    MOTION_LINEAR,
-    MOTION_CIRCULAR,
-    MOTION_BOUNCE,
-    MOTION_WAVE,
-    MOTION_FOLLOW
-};
-
+// A sprite is a handle into a SpriteSystem, which owns and simulates its
+// position, motion and audio state. Until attached, the state is held
+// locally so sprites can be set up before joining a layer.
 class Sprite {
 public:
     Sprite();
@@ -20,66 +18,84 @@ public:
     // Setup the sprite
     virtual void setup(float x, float y, float scale, float rotation);
     
-    // Update the sprite
-    virtual void update(float deltaTime, float* audioData, int numBands);
+    // Per-sprite work SpriteSystem does not cover: the trail and, in
+    // subclasses, animation. Call before SpriteSystem::update
+    virtual void update(float deltaTime, const AudioFrame& audio);
     
     // Draw the sprite
     virtual void draw(int canvasWidth, int canvasHeight);
     
+    // Add the sprite and its trail to a batch instead of drawing it
+    virtual void addToBatch(SpriteBatch& batch, int canvasWidth, int canvasHeight) {}
+    
     // Get sprite type
     virtual string getType() = 0;
     
+    // Move the state into a system, or back out of it
+    void attach(SpriteSystem* system);
+    void detach();
+    bool isAttached() { return system != nullptr; }
+    
+    // Copy of the whole simulation state
+    SpriteState getState() { return system != nullptr ? system->get(handle) : state; }
+    
     // Getters and setters
     string getId() { return id; }
     void setId(string id) { this->id = id; }
     
-    float getX() { return x; }
-    void setX(float x) { this->x = x; }
+    float getX() { return value(&SpriteSystem::x, state.x); }
+    void setX(float x) { value(&SpriteSystem::x, state.x) = x; }
     
-    float getY() { return y; }
-    void setY(float y) { this->y = y; }
+    float getY() { return value(&SpriteSystem::y, state.y); }
+    void setY(float y) { value(&SpriteSystem::y, state.y) = y; }
     
-    float getScale() { return scale; }
-    void setScale(float scale) { this->scale = scale; }
+    float getScale() { return value(&SpriteSystem::scale, state.scale); }
+    void setScale(float scale) { value(&SpriteSystem::scale, state.scale) = scale; }
     
-    float getRotation() { return rotation; }
-    void setRotation(float rotation) { this->rotation = rotation; }
+    float getRotation() { return value(&SpriteSystem::rotation, state.rotation); }
+    void setRotation(float rotation) { value(&SpriteSystem::rotation, state.rotation) = rotation; }
     
-    ofVec2f getMotionSpeed() { return motionSpeed; }
-    void setMotionSpeed(ofVec2f speed) { this->motionSpeed = speed; }
-    void setMotionSpeed(float amount) { 
-        this->motionSpeed.x *= amount / motionAmount; 
-        this->motionSpeed.y *= amount / motionAmount;
-        this->motionAmount = amount;
+    ofVec2f getMotionSpeed() {
+        return ofVec2f(value(&SpriteSystem::velocityX, state.velocityX), value(&SpriteSystem::velocityY, state.velocityY));
+    }
+    void setMotionSpeed(ofVec2f speed) {
+        value(&SpriteSystem::velocityX, state.velocityX) = speed.x;
+        value(&SpriteSystem::velocityY, state.velocityY) = speed.y;
     }
+    void setMotionSpeed(float amount);
     
-    float getRotationSpeed() { return rotationSpeed; }
-    void setRotationSpeed(float speed) { this->rotationSpeed = speed; }
+    float getRotationSpeed() { return value(&SpriteSystem::rotationSpeed, state.rotationSpeed); }
+    void setRotationSpeed(float speed) { value(&SpriteSystem::rotationSpeed, state.rotationSpeed) = speed; }
     
-    MotionType getMotionType() { return motionType; }
-    void setMotionType(MotionType type) { this->motionType = type; }
+    MotionType getMotionType();
+    void setMotionType(MotionType type);
     
-    float getOpacity() { return opacity; }
-    void setOpacity(float opacity) { this->opacity = opacity; }
+    float getOpacity() { return value(&SpriteSystem::opacity, state.opacity); }
+    void setOpacity(float opacity) { value(&SpriteSystem::opacity, state.opacity) = opacity; }
     
     int getMaxTrailLength() { return maxTrailLength; }
-    void setMaxTrailLength(int length) { this->maxTrailLength = length; }
+    void setMaxTrailLength(int length);
     
-    float getAudioReactivity() { return audioReactivity; }
-    void setAudioReactivity(float reactivity) { this->audioReactivity = reactivity; }
+    float getAudioReactivity() { return value(&SpriteSystem::audioReactivity, state.audioReactivity); }
+    void setAudioReactivity(float reactivity) { value(&SpriteSystem::audioReactivity, state.audioReactivity) = reactivity; }
+    
+    // AudioBand index, or -1 for all bands
+    void setReactsTo(int band);
     
 protected:
-    // Sprite properties
     string id;
-    float x;
-    float y;
-    float scale;
-    float rotation;
-    ofVec2f motionSpeed;
-    float rotationSpeed;
-    MotionType motionType;
-    float opacity;
-    float motionAmount;
+    
+    // State while detached
+    SpriteState state;
+    
+    // Owning system and handle while attached
+    SpriteSystem* system;
+    int handle;
+    
+    // A state field, wherever it currently lives
+    float& value(vector<float> SpriteSystem::* array, float& detached) {
+        return system != nullptr ? (system->*array)[system->getIndex(handle)] : detached;
+    }
     
     // Trail properties
     struct TrailPoint {
@@ -89,35 +105,11 @@ protected:
         float rotation;
         float opacity;
     };
-    vector<TrailPoint> trail;
+    CircularBuffer<TrailPoint> trail;
     int maxTrailLength;
     
-    // Motion parameters for different types
-    float circleRadius;
-    float circlePhase;
-    float waveAmplitudeX;
-    float waveAmplitudeY;
-    float waveFrequencyX;
-    float waveFrequencyY;
-    float wavePhaseX;
-    float wavePhaseY;
-    ofVec2f basePosition;
-    
-    // Audio reactivity
-    float audioReactivity;
-    string reactsTo; // "bass", "mid", "high", "all"
-    
-    // Utility to get audio energy in a frequency range
-    float getAudioEnergy(float* audioData, int numBands, string range);
-    
-    // Apply audio reactivity
-    virtual void applyAudioReactivity(float* audioData, int numBands);
-    
-    // Apply different motion types
-    void applyMotion(float deltaTime);
-    void applyCircularMotion(float deltaTime);
-    void applyBounceMotion(float deltaTime);
-    void applyWaveMotion(float deltaTime);
+    // Trail point by age, 0 being the most recent
+    const TrailPoint& getTrailPoint(int age) { return trail[trail.size() - 1 - age]; }
     
     // Draw trail
     virtual void drawTrail(int canvasWidth, int canvasHeight);
@@ -136,6 +128,7 @@ public:
     
     // Draw implementation
     void draw(int canvasWidth, int canvasHeight) override;
+    void addToBatch(SpriteBatch& batch, int canvasWidth, int canvasHeight) override;
     
     // Get sprite type
     string getType() override { return "basic"; }
@@ -163,10 +156,11 @@ public:
     void setup(string path, float x, float y, float scale, float rotation);
     
     // Update with animation
-    void update(float deltaTime, float* audioData, int numBands) override;
+    void update(float deltaTime, const AudioFrame& audio) override;
     
     // Draw implementation
     void draw(int canvasWidth, int canvasHeight) override;
+    void addToBatch(SpriteBatch& batch, int canvasWidth, int canvasHeight) override;
     
     // Get sprite type
     string getType() override { return "gif"; }
@@ -176,20 +170,23 @@ public:
     
 protected:
     string path;
-    ofImage image;
     
-    // Animation properties
+    // Animation properties, one duration per frame
     bool isAnimated;
-    vector<ofImage> frames;
     vector<float> frameDurations;
     int currentFrame;
     float frameTime;
     bool isPlaying;
     
+    // Frames packed into one texture, shared with sprites of the same path.
+    // Every draw goes through it; decoded frames are not kept
+    shared_ptr<SpriteAtlas> atlas;
+    
     // Draw trail implementation
     void drawTrail(int canvasWidth, int canvasHeight) override;
     
-    // Load GIF frames
+    // Read the GIF's frame timing, decoding its frames into the atlas
+    // unless another sprite already built it
     bool loadGif(string path);
     
     // Play/pause animation
@@ -0,0 +1,325 @@
+// File: src/Utils/SpriteBatch.cpp
+#include "SpriteBatch.h"
+
+// Segments in the unit disc used for circles
+static const int DISC_SEGMENTS = 32;
+
+map<string, weak_ptr<SpriteAtlas>> SpriteBatch::atlasCache;
+
+SpriteBatch::SpriteBatch() {
+    transformLocation = -1;
+    shapeLocation = -1;
+    colorLocation = -1;
+    discVertexCount = 0;
+    instanceCapacity = 0;
+}
+
+SpriteBatch::~SpriteBatch() {
+    // Clean up resources
+}
+
+void SpriteBatch::setup() {
+    // Unit quad, texture coordinates top-left to bottom-right
+    vector<ofVec3f> quadVertices = {
+        ofVec3f(-1, -1, 0), ofVec3f(1, -1, 0), ofVec3f(1, 1, 0), ofVec3f(-1, 1, 0)
+    };
+    vector<ofVec2f> quadTexCoords = {
+        ofVec2f(0, 0), ofVec2f(1, 0), ofVec2f(1, 1), ofVec2f(0, 1)
+    };
+    quadVbo.setVertexData(quadVertices.data(), (int)quadVertices.size(), GL_STATIC_DRAW);
+    quadVbo.setTexCoordData(quadTexCoords.data(), (int)quadTexCoords.size(), GL_STATIC_DRAW);
+    
+    // Unit disc as a fan around the centre
+    vector<ofVec3f> discVertices;
+    vector<ofVec2f> discTexCoords;
+    discVertices.push_back(ofVec3f(0, 0, 0));
+    for (int i = 0; i <= DISC_SEGMENTS; i++) {
+        float angle = TWO_PI * i / DISC_SEGMENTS;
+        discVertices.push_back(ofVec3f(cos(angle), sin(angle), 0));
+    }
+    discTexCoords.resize(discVertices.size(), ofVec2f(0.5, 0.5));
+    discVbo.setVertexData(discVertices.data(), (int)discVertices.size(), GL_STATIC_DRAW);
+    discVbo.setTexCoordData(discTexCoords.data(), (int)discTexCoords.size(), GL_STATIC_DRAW);
+    discVertexCount = (int)discVertices.size();
+    
+    // Load the sprites shader; without it sprites are drawn one by one
+    if (!shader.load("shaders/sprites")) {
+        ofLogWarning("SpriteBatch") << "Failed to load sprites shader, drawing sprites one by one";
+        return;
+    }
+    transformLocation = shader.getAttributeLocation("instanceTransform");
+    shapeLocation = shader.getAttributeLocation("instanceShape");
+    colorLocation = shader.getAttributeLocation("instanceColor");
+}
+
+void SpriteBatch::begin() {
+    circles.clear();
+    images.clear();
+    imageAtlases.clear();
+}
+
+void SpriteBatch::addCircle(float x, float y, float rotation, float scale, float radius, const ofColor& color, float alpha) {
+    SpriteInstance instance;
+    instance.x = x;
+    instance.y = y;
+    instance.rotation = rotation;
+    instance.scale = scale;
+    instance.halfWidth = radius;
+    instance.halfHeight = radius;
+    instance.frame = 0;
+    instance.unused = 0;
+    instance.r = color.r / 255.0f;
+    instance.g = color.g / 255.0f;
+    instance.b = color.b / 255.0f;
+    instance.a = alpha;
+    circles.push_back(instance);
+}
+
+void SpriteBatch::addImage(const SpriteAtlas* atlas, int frame, float x, float y, float rotation, float scale, float alpha) {
+    if (atlas == nullptr || atlas->frameCount == 0) return;
+    
+    SpriteInstance instance;
+    instance.x = x;
+    instance.y = y;
+    instance.rotation = rotation;
+    instance.scale = scale;
+    instance.halfWidth = atlas->frameWidth * 0.5f;
+    instance.halfHeight = atlas->frameHeight * 0.5f;
+    instance.frame = ofClamp(frame, 0, atlas->frameCount - 1);
+    instance.unused = 0;
+    instance.r = 1;
+    instance.g = 1;
+    instance.b = 1;
+    instance.a = alpha;
+    images.push_back(instance);
+    imageAtlases.push_back(atlas);
+}
+
+void SpriteBatch::bindInstances(ofVbo& vbo, int first) {
+    // Point the per-instance attributes at a range of the shared buffer
+    int stride = sizeof(SpriteInstance);
+    int offset = first * stride;
+    vbo.setAttributeBuffer(transformLocation, instanceBuffer, 4, stride, offset + offsetof(SpriteInstance, x));
+    vbo.setAttributeBuffer(shapeLocation, instanceBuffer, 4, stride, offset + offsetof(SpriteInstance, halfWidth));
+    vbo.setAttributeBuffer(colorLocation, instanceBuffer, 4, stride, offset + offsetof(SpriteInstance, r));
+    vbo.setAttributeDivisor(transformLocation, 1);
+    vbo.setAttributeDivisor(shapeLocation, 1);
+    vbo.setAttributeDivisor(colorLocation, 1);
+}
+
+void SpriteBatch::draw() {
+    if (circles.empty() && images.empty()) return;
+    
+    if (!shader.isLoaded() || transformLocation < 0 || shapeLocation < 0 || colorLocation < 0) {
+        drawImmediate();
+        return;
+    }
+    
+    // Group images by atlas, keeping submission order within each group
+    order.resize(images.size());
+    for (int i = 0; i < (int)order.size(); i++) {
+        order[i] = i;
+    }
+    std::stable_sort(order.begin(), order.end(), [this](int a, int b) {
+        return imageAtlases[a] < imageAtlases[b];
+    });
+    
+    // Circles first, then the grouped images, in one upload
+    sorted.clear();
+    sorted.insert(sorted.end(), circles.begin(), circles.end());
+    for (int index : order) {
+        sorted.push_back(images[index]);
+    }
+    
+    size_t bytes = sorted.size() * sizeof(SpriteInstance);
+    if (sorted.size() > instanceCapacity) {
+        instanceCapacity = std::max(sorted.size(), instanceCapacity * 2);
+        instanceBuffer.allocate(instanceCapacity * sizeof(SpriteInstance), GL_STREAM_DRAW);
+    }
+    instanceBuffer.updateData(0, bytes, sorted.data());
+    
+    shader.begin();
+    
+    // All circles in one call
+    if (!circles.empty()) {
+        shader.setUniform1i("textured", 0);
+        shader.setUniform2f("atlasGrid", 1, 1);
+        bindInstances(discVbo, 0);
+        discVbo.drawInstanced(GL_TRIANGLE_FAN, 0, discVertexCount, (int)circles.size());
+    }
+    
+    // One call per atlas
+    int first = (int)circles.size();
+    int count = (int)order.size();
+    int i = 0;
+    while (i < count) {
+        const SpriteAtlas* atlas = imageAtlases[order[i]];
+        int end = i + 1;
+        while (end < count && imageAtlases[order[end]] == atlas) {
+            end++;
+        }
+        
+        shader.setUniform1i("textured", 1);
+        shader.setUniform2f("atlasGrid", atlas->columns, atlas->rows);
+        shader.setUniformTexture("atlas", atlas->texture, 0);
+        bindInstances(quadVbo, first + i);
+        quadVbo.drawInstanced(GL_TRIANGLE_FAN, 0, 4, end - i);
+        
+        i = end;
+    }
+    
+    shader.end();
+}
+
+void SpriteBatch::drawImmediate() {
+    ofPushStyle();
+    
+    for (auto& instance : circles) {
+        ofPushMatrix();
+        ofTranslate(instance.x, instance.y);
+        ofRotateZDeg(ofRadToDeg(instance.rotation));
+        ofScale(instance.scale, instance.scale);
+        ofSetColor(instance.r * 255, instance.g * 255, instance.b * 255, instance.a * 255);
+        ofDrawCircle(0, 0, instance.halfWidth);
+        ofPopMatrix();
+    }
+    
+    for (int i = 0; i < (int)images.size(); i++) {
+        const SpriteInstance& instance = images[i];
+        
+        ofPushMatrix();
+        ofTranslate(instance.x, instance.y);
+        ofRotateZDeg(ofRadToDeg(instance.rotation));
+        ofScale(instance.scale, instance.scale);
+        ofSetColor(255, 255, 255, instance.a * 255);
+        drawAtlasFrame(*imageAtlases[i], (int)instance.frame);
+        ofPopMatrix();
+    }
+    
+    ofPopStyle();
+}
+
+void SpriteBatch::drawAtlasFrame(const SpriteAtlas& atlas, int frame) {
+    float sx = (frame % atlas.columns) * atlas.cellWidth;
+    float sy = (frame / atlas.columns) * atlas.cellHeight;
+    atlas.texture.drawSubsection(-atlas.frameWidth * 0.5f, -atlas.frameHeight * 0.5f, atlas.frameWidth, atlas.frameHeight,
+                                 sx, sy, atlas.cellWidth, atlas.cellHeight);
+}
+
+int SpriteBatch::getMaxTextureSize() {
+    static GLint maxSize = 0;
+    if (maxSize <= 0) {
+        glGetIntegerv(GL_MAX_TEXTURE_SIZE, &maxSize);
+    }
+    
+    // Before a context exists, assume the smallest limit GL 3 allows
+    return maxSize > 0 ? maxSize : 1024;
+}
+
+shared_ptr<SpriteAtlas> SpriteBatch::findAtlas(const string& path) {
+    // Reuse the atlas while any sprite still holds it
+    auto it = atlasCache.find(path);
+    if (it != atlasCache.end()) {
+        return it->second.lock();
+    }
+    return nullptr;
+}
+
+shared_ptr<SpriteAtlas> SpriteBatch::createAtlas(int frameWidth, int frameHeight, int channels, int frameCount) {
+    if (frameWidth <= 0 || frameHeight <= 0 || frameCount <= 0) {
+        return nullptr;
+    }
+    
+    // Grid that makes the texture roughly square
+    int columns = (int)ceil(sqrt((float)frameCount * frameHeight / frameWidth));
+    columns = std::max(1, std::min(columns, frameCount));
+    int rows = (frameCount + columns - 1) / columns;
+    
+    // Scale the cells down if the texture would exceed the GL limit
+    int maxSize = getMaxTextureSize();
+    int cellWidth = frameWidth;
+    int cellHeight = frameHeight;
+    if (columns * cellWidth > maxSize || rows * cellHeight > maxSize) {
+        float scale = std::min((float)maxSize / (columns * frameWidth), (float)maxSize / (rows * frameHeight));
+        cellWidth = std::max(1, (int)(frameWidth * scale));
+        cellHeight = std::max(1, (int)(frameHeight * scale));
+        ofLogWarning("SpriteBatch") << frameCount << " frames of " << frameWidth << "x" << frameHeight
+                                    << " exceed the " << maxSize << " pixel texture limit, stored at "
+                                    << cellWidth << "x" << cellHeight;
+    }
+    
+    shared_ptr<SpriteAtlas> atlas = make_shared<SpriteAtlas>();
+    atlas->pixels.allocate(columns * cellWidth, rows * cellHeight, channels);
+    atlas->pixels.set(0);
+    atlas->frameWidth = frameWidth;
+    atlas->frameHeight = frameHeight;
+    atlas->cellWidth = cellWidth;
+    atlas->cellHeight = cellHeight;
+    atlas->columns = columns;
+    atlas->rows = rows;
+    atlas->frameCount = frameCount;
+    return atlas;
+}
+
+void SpriteBatch::setAtlasFrame(SpriteAtlas& atlas, int frame, const ofPixels& source) {
+    int channels = (int)atlas.pixels.getNumChannels();
+    if (frame < 0 || frame >= atlas.frameCount || !atlas.pixels.isAllocated()) return;
+    if ((int)source.getWidth() != atlas.frameWidth || (int)source.getHeight() != atlas.frameHeight ||
+        (int)source.getNumChannels() != channels) {
+        ofLogWarning("SpriteBatch") << "Frame " << frame << " does not match the atlas, left blank";
+        return;
+    }
+    
+    size_t frameStride = (size_t)atlas.frameWidth * channels;
+    size_t cellStride = (size_t)atlas.cellWidth * channels;
+    size_t atlasStride = (size_t)atlas.columns * cellStride;
+    int column = frame % atlas.columns;
+    int row = frame / atlas.columns;
+    unsigned char* cell = atlas.pixels.getData() + (size_t)row * atlas.cellHeight * atlasStride + column * cellStride;
+    const unsigned char* data = source.getData();
+    
+    // Full size: copy the frame into its cell, row by row
+    if (atlas.cellWidth == atlas.frameWidth && atlas.cellHeight == atlas.frameHeight) {
+        for (int y = 0; y < atlas.frameHeight; y++) {
+            memcpy(cell + y * atlasStride, data + y * frameStride, frameStride);
+        }
+        return;
+    }
+    
+    // Scaled down: each cell pixel averages the block of frame pixels it covers
+    for (int y = 0; y < atlas.cellHeight; y++) {
+        int y0 = y * atlas.frameHeight / atlas.cellHeight;
+        int y1 = std::max(y0 + 1, (y + 1) * atlas.frameHeight / atlas.cellHeight);
+        unsigned char* out = cell + y * atlasStride;
+        
+        for (int x = 0; x < atlas.cellWidth; x++) {
+            int x0 = x * atlas.frameWidth / atlas.cellWidth;
+            int x1 = std::max(x0 + 1, (x + 1) * atlas.frameWidth / atlas.cellWidth);
+            uint32_t sum[4] = { 0, 0, 0, 0 };
+            for (int sy = y0; sy < y1; sy++) {
+                const unsigned char* p = data + sy * frameStride + x0 * channels;
+                for (int sx = x0; sx < x1; sx++) {
+                    for (int c = 0; c < channels; c++) {
+                        sum[c] += *p++;
+                    }
+                }
+            }
+            uint32_t count = (uint32_t)((x1 - x0) * (y1 - y0));
+            for (int c = 0; c < channels; c++) {
+                *out++ = (unsigned char)((sum[c] + count / 2) / count);
+            }
+        }
+    }
+}
+
+void SpriteBatch::finishAtlas(const string& path, const shared_ptr<SpriteAtlas>& atlas) {
+    atlas->texture.allocate(atlas->pixels);
+    atlas->texture.loadData(atlas->pixels);
+    if (!atlas->texture.isAllocated()) {
+        ofLogError("SpriteBatch") << "Could not allocate a " << atlas->pixels.getWidth() << "x"
+                                  << atlas->pixels.getHeight() << " atlas for " << path;
+    }
+    atlas->pixels.clear();
+    
+    atlasCache[path] = atlas;
+}
@@ -0,0 +1,108 @@
+// File: src/Utils/SpriteBatch.h
+#pragma once
+
+#include "ofMain.h"
+
+// Frames of one image or GIF packed into a grid on a single texture.
+// Shared by every sprite showing the same file
+struct SpriteAtlas {
+    ofTexture texture;
+    
+    // Staging copy while frames are added, released by finishAtlas()
+    ofPixels pixels;
+    
+    // Frame size as drawn, and as stored in a cell. Cells are smaller only
+    // when the frames had to be scaled down to fit GL_MAX_TEXTURE_SIZE
+    int frameWidth;
+    int frameHeight;
+    int cellWidth;
+    int cellHeight;
+    int columns;
+    int rows;
+    int frameCount;
+};
+
+// One sprite or trail point, laid out for the instance buffer
+struct SpriteInstance {
+    // Centre in pixels, rotation in radians, scale
+    float x, y, rotation, scale;
+    
+    // Half size in pixels before scaling, atlas frame, padding
+    float halfWidth, halfHeight, frame, unused;
+    
+    // Colour and opacity, 0-1
+    float r, g, b, a;
+};
+
+// Collects sprite instances for a frame and draws them with one instanced
+// call for all circles and one per atlas. Without the shader the instances
+// are drawn one by one.
+class SpriteBatch {
+public:
+    SpriteBatch();
+    ~SpriteBatch();
+    
+    void setup();
+    
+    // Start collecting a new frame
+    void begin();
+    
+    // Solid disc of the given radius
+    void addCircle(float x, float y, float rotation, float scale, float radius, const ofColor& color, float alpha);
+    
+    // Atlas frame centred on x, y at its pixel size
+    void addImage(const SpriteAtlas* atlas, int frame, float x, float y, float rotation, float scale, float alpha);
+    
+    // Draw everything collected since begin(), with the current blend mode
+    void draw();
+    
+    // Instances in the last frame
+    int getInstanceCount() { return (int)(circles.size() + images.size()); }
+    
+    // Atlas for an image or GIF while any sprite still holds it, or
+    // nullptr if it has to be built
+    static shared_ptr<SpriteAtlas> findAtlas(const string& path);
+    
+    // Build an atlas one frame at a time, so only the atlas pixels and the
+    // frame being decoded are in memory: createAtlas() lays out the grid,
+    // setAtlasFrame() copies a frame into its cell, and finishAtlas()
+    // uploads the texture and shares it under path
+    static shared_ptr<SpriteAtlas> createAtlas(int frameWidth, int frameHeight, int channels, int frameCount);
+    static void setAtlasFrame(SpriteAtlas& atlas, int frame, const ofPixels& pixels);
+    static void finishAtlas(const string& path, const shared_ptr<SpriteAtlas>& atlas);
+    
+    // GL_MAX_TEXTURE_SIZE, queried once a context exists
+    static int getMaxTextureSize();
+    
+    // Draw one atlas frame centred on the origin at its pixel size
+    static void drawAtlasFrame(const SpriteAtlas& atlas, int frame);
+    
+private:
+    ofShader shader;
+    int transformLocation;
+    int shapeLocation;
+    int colorLocation;
+    
+    // Unit geometry
+    ofVbo quadVbo;
+    ofVbo discVbo;
+    int discVertexCount;
+    
+    // Instances for this frame. Images are grouped by atlas before drawing
+    vector<SpriteInstance> circles;
+    vector<SpriteInstance> images;
+    vector<const SpriteAtlas*> imageAtlases;
+    
+    // Per-atlas order of images, reused between frames
+    vector<int> order;
+    vector<SpriteInstance> sorted;
+    
+    // GPU copy of circles followed by the sorted images
+    ofBufferObject instanceBuffer;
+    size_t instanceCapacity;
+    
+    void bindInstances(ofVbo& vbo, int first);
+    void drawImmediate();
+    
+    static map<string, weak_ptr<SpriteAtlas>> atlasCache;
+};
@@ -1,5 +1,6 @@
 // File: src/Utils/SpriteLibrary.cpp
 #include "SpriteLibrary.h"
+#include "GifDecoder.h"
 
 SpriteLibrary::SpriteLibrary() {
     // Set base directory for sprites
@@ -438,41 +439,35 @@ string SpriteLibrary::getFileExtension(string filename) {
 }
 
 bool SpriteLibrary::loadGifInfo(string path, SpriteInfo* info) {
-    // In a real implementation, this would use ofxGif or similar addon
-    // to load the GIF and extract frame information
-    
-    // For this example, we'll simulate some basic information
-    
     // Check if file exists
     if (!ofFile::doesFileExist(path)) {
         ofLogError("SpriteLibrary") << "File not found: " << path;
         return false;
     }
     
-    // Load the image to get dimensions
-    ofImage img;
-    bool loaded = img.load(path);
-    
-    if (loaded) {
-        // Set dimensions
-        info->width = img.getWidth();
-        info->height = img.getHeight();
-        
-        // Simulate frame detection for animated GIFs
-        // In a real implementation, this would extract actual frame information
-        info->frameCount = (ofRandom(0, 1) > 0.5) ? 1 : (int)ofRandom(2, 10);
-        
-        // Generate frame durations (100ms per frame typical for GIFs)
-        info->frameDurations.clear();
-        for (int i = 0; i < info->frameCount; i++) {
-            info->frameDurations.push_back(0.1);
-        }
-        
-        return true;
-    } else {
+    GifDecoder decoder;
+    if (!decoder.open(path)) {
         ofLogError("SpriteLibrary") << "Failed to load image: " << path;
         return false;
     }
+    
+    // Set dimensions
+    info->width = decoder.getWidth();
+    info->height = decoder.getHeight();
+    
+    // Walk the frames for their timing without decoding any pixels
+    info->frameDurations.clear();
+    while (decoder.skipFrame()) {
+        info->frameDurations.push_back(decoder.getFrameDuration());
+    }
+    info->frameCount = info->frameDurations.size();
+    
+    if (info->frameCount == 0) {
+        ofLogError("SpriteLibrary") << "No frames in " << path;
+        return false;
+    }
+    
+    return true;
 }
 
 string SpriteLibrary::createThumbnail(string sourcePath, string category, string filename) {
@@ -0,0 +1,449 @@
+// File: src/Utils/SpriteSystem.cpp
+#include "SpriteSystem.h"
+#include "ParallelFor.h"
+
+// Sprites per ParallelFor task, so small groups stay on one thread
+static const int SPRITES_PER_TASK = 8192;
+
+namespace {
+
+// Polynomial sin, cos and atan2 on plain floats. Unlike the libm calls
+// they inline into the update loops, which lets them vectorise; errors
+// are below 1e-5, far under a pixel
+inline float fastSin(float x) {
+    // Reduce to [-PI, PI], then fold into [-PI/2, PI/2]
+    x -= TWO_PI * floorf(x * (1.0f / TWO_PI) + 0.5f);
+    x = x > HALF_PI ? PI - x : x;
+    x = x < -HALF_PI ? -PI - x : x;
+    float x2 = x * x;
+    return x * (1.0f + x2 * (-1.0f / 6.0f + x2 * (1.0f / 120.0f + x2 * (-1.0f / 5040.0f + x2 * (1.0f / 362880.0f)))));
+}
+
+inline float fastCos(float x) {
+    return fastSin(x + HALF_PI);
+}
+
+inline float fastAtan2(float y, float x) {
+    float ax = fabsf(x);
+    float ay = fabsf(y);
+    float a = std::min(ax, ay) / (std::max(ax, ay) + 1e-30f);
+    float s = a * a;
+    float r = ((-0.0464964749f * s + 0.15931422f) * s - 0.327622764f) * s * a + a;
+    r = ay > ax ? HALF_PI - r : r;
+    r = x < 0 ? PI - r : r;
+    return y < 0 ? -r : r;
+}
+
+inline int clampType(int type) {
+    return std::max(0, std::min(type, MOTION_TYPE_COUNT - 1));
+}
+
+// Run a range update across threads when it is large enough
+template<typename Body>
+void runGroup(int begin, int end, Body body) {
+    int count = end - begin;
+    if (count <= 0) return;
+    int tasks = (count + SPRITES_PER_TASK - 1) / SPRITES_PER_TASK;
+    if (tasks == 1) {
+        body(begin, end);
+        return;
+    }
+    ParallelFor::run(tasks, [&](int first, int last) {
+        body(begin + first * SPRITES_PER_TASK, std::min(end, begin + last * SPRITES_PER_TASK));
+    });
+}
+
+}
+
+SpriteState::SpriteState() {
+    x = 0.5;
+    y = 0.5;
+    scale = 1.0;
+    rotation = 0.0;
+    
+    velocityX = 0;
+    velocityY = 0;
+    rotationSpeed = 0.0;
+    motionType = MOTION_NONE;
+    motionAmount = 1.0;
+    opacity = 1.0;
+    
+    // Motion parameters
+    circleRadius = 0.1;
+    circlePhase = 0.0;
+    waveAmplitudeX = 0.1;
+    waveAmplitudeY = 0.1;
+    waveFrequencyX = 1.0;
+    waveFrequencyY = 1.0;
+    wavePhaseX = 0.0;
+    wavePhaseY = PI / 2.0; // 90 degrees offset
+    baseX = 0.5;
+    baseY = 0.5;
+    
+    // Audio reactivity
+    audioReactivity = 0.5;
+    reactsTo = -1;
+}
+
+SpriteSystem::SpriteSystem() {
+    for (int i = 0; i <= MOTION_TYPE_COUNT; i++) {
+        groupStart[i] = 0;
+    }
+}
+
+int SpriteSystem::add(const SpriteState& state) {
+    // Reuse a free handle if there is one
+    int handle;
+    if (!freeHandles.empty()) {
+        handle = freeHandles.back();
+        freeHandles.pop_back();
+    } else {
+        handle = (int)handleToIndex.size();
+        handleToIndex.push_back(-1);
+    }
+    
+    // Append to the last group, then move into place
+    pushSlot(state, handle);
+    groupStart[MOTION_TYPE_COUNT]++;
+    moveToGroup(size() - 1, MOTION_TYPE_COUNT - 1, clampType(state.motionType));
+    return handle;
+}
+
+void SpriteSystem::remove(int handle) {
+    if (handle < 0 || handle >= (int)handleToIndex.size() || handleToIndex[handle] < 0) return;
+    
+    // Move to the end of the last group, then drop the slot
+    int index = moveToGroup(handleToIndex[handle], getGroupOf(handleToIndex[handle]), MOTION_TYPE_COUNT - 1);
+    swapSlots(index, size() - 1);
+    popSlot();
+    groupStart[MOTION_TYPE_COUNT]--;
+    
+    handleToIndex[handle] = -1;
+    freeHandles.push_back(handle);
+}
+
+void SpriteSystem::clear() {
+    int count = size();
+    for (int i = 0; i < count; i++) {
+        popSlot();
+    }
+    for (int i = 0; i <= MOTION_TYPE_COUNT; i++) {
+        groupStart[i] = 0;
+    }
+    handleToIndex.clear();
+    freeHandles.clear();
+}
+
+SpriteState SpriteSystem::get(int handle) {
+    int i = handleToIndex[handle];
+    SpriteState state;
+    state.x = x[i];
+    state.y = y[i];
+    state.scale = scale[i];
+    state.rotation = rotation[i];
+    state.velocityX = velocityX[i];
+    state.velocityY = velocityY[i];
+    state.rotationSpeed = rotationSpeed[i];
+    state.motionType = (MotionType)getGroupOf(i);
+    state.motionAmount = motionAmount[i];
+    state.opacity = opacity[i];
+    state.circleRadius = circleRadius[i];
+    state.circlePhase = circlePhase[i];
+    state.waveAmplitudeX = waveAmplitudeX[i];
+    state.waveAmplitudeY = waveAmplitudeY[i];
+    state.waveFrequencyX = waveFrequencyX[i];
+    state.waveFrequencyY = waveFrequencyY[i];
+    state.wavePhaseX = wavePhaseX[i];
+    state.wavePhaseY = wavePhaseY[i];
+    state.baseX = baseX[i];
+    state.baseY = baseY[i];
+    state.audioReactivity = audioReactivity[i];
+    state.reactsTo = bandIndex[i] == AUDIO_BAND_COUNT ? -1 : bandIndex[i];
+    return state;
+}
+
+void SpriteSystem::set(int handle, const SpriteState& state) {
+    writeSlot(handleToIndex[handle], state);
+    setMotionType(handle, state.motionType);
+}
+
+void SpriteSystem::setMotionType(int handle, MotionType type) {
+    int index = handleToIndex[handle];
+    moveToGroup(index, getGroupOf(index), clampType(type));
+}
+
+int SpriteSystem::getGroupOf(int index) {
+    int group = 0;
+    while (group < MOTION_TYPE_COUNT - 1 && index >= groupStart[group + 1]) {
+        group++;
+    }
+    return group;
+}
+
+int SpriteSystem::moveToGroup(int index, int from, int to) {
+    // Step across one group boundary at a time, swapping with the sprite
+    // at the edge of each group passed, and shifting that boundary
+    while (from < to) {
+        int last = groupStart[from + 1] - 1;
+        swapSlots(index, last);
+        groupStart[from + 1]--;
+        index = last;
+        from++;
+    }
+    while (from > to) {
+        int first = groupStart[from];
+        swapSlots(index, first);
+        groupStart[from]++;
+        index = first;
+        from--;
+    }
+    return index;
+}
+
+void SpriteSystem::swapSlots(int a, int b) {
+    if (a == b) return;
+    
+    std::swap(x[a], x[b]);
+    std::swap(y[a], y[b]);
+    std::swap(scale[a], scale[b]);
+    std::swap(rotation[a], rotation[b]);
+    std::swap(velocityX[a], velocityX[b]);
+    std::swap(velocityY[a], velocityY[b]);
+    std::swap(rotationSpeed[a], rotationSpeed[b]);
+    std::swap(motionAmount[a], motionAmount[b]);
+    std::swap(opacity[a], opacity[b]);
+    std::swap(circleRadius[a], circleRadius[b]);
+    std::swap(circlePhase[a], circlePhase[b]);
+    std::swap(waveAmplitudeX[a], waveAmplitudeX[b]);
+    std::swap(waveAmplitudeY[a], waveAmplitudeY[b]);
+    std::swap(waveFrequencyX[a], waveFrequencyX[b]);
+    std::swap(waveFrequencyY[a], waveFrequencyY[b]);
+    std::swap(wavePhaseX[a], wavePhaseX[b]);
+    std::swap(wavePhaseY[a], wavePhaseY[b]);
+    std::swap(baseX[a], baseX[b]);
+    std::swap(baseY[a], baseY[b]);
+    std::swap(audioReactivity[a], audioReactivity[b]);
+    std::swap(bandIndex[a], bandIndex[b]);
+    
+    std::swap(indexToHandle[a], indexToHandle[b]);
+    handleToIndex[indexToHandle[a]] = a;
+    handleToIndex[indexToHandle[b]] = b;
+}
+
+void SpriteSystem::pushSlot(const SpriteState& state, int handle) {
+    x.push_back(0);
+    y.push_back(0);
+    scale.push_back(0);
+    rotation.push_back(0);
+    velocityX.push_back(0);
+    velocityY.push_back(0);
+    rotationSpeed.push_back(0);
+    motionAmount.push_back(0);
+    opacity.push_back(0);
+    circleRadius.push_back(0);
+    circlePhase.push_back(0);
+    waveAmplitudeX.push_back(0);
+    waveAmplitudeY.push_back(0);
+    waveFrequencyX.push_back(0);
+    waveFrequencyY.push_back(0);
+    wavePhaseX.push_back(0);
+    wavePhaseY.push_back(0);
+    baseX.push_back(0);
+    baseY.push_back(0);
+    audioReactivity.push_back(0);
+    bandIndex.push_back(0);
+    
+    int index = size() - 1;
+    indexToHandle.push_back(handle);
+    handleToIndex[handle] = index;
+    writeSlot(index, state);
+}
+
+void SpriteSystem::popSlot() {
+    x.pop_back();
+    y.pop_back();
+    scale.pop_back();
+    rotation.pop_back();
+    velocityX.pop_back();
+    velocityY.pop_back();
+    rotationSpeed.pop_back();
+    motionAmount.pop_back();
+    opacity.pop_back();
+    circleRadius.pop_back();
+    circlePhase.pop_back();
+    waveAmplitudeX.pop_back();
+    waveAmplitudeY.pop_back();
+    waveFrequencyX.pop_back();
+    waveFrequencyY.pop_back();
+    wavePhaseX.pop_back();
+    wavePhaseY.pop_back();
+    baseX.pop_back();
+    baseY.pop_back();
+    audioReactivity.pop_back();
+    bandIndex.pop_back();
+    indexToHandle.pop_back();
+}
+
+void SpriteSystem::writeSlot(int i, const SpriteState& state) {
+    x[i] = state.x;
+    y[i] = state.y;
+    scale[i] = state.scale;
+    rotation[i] = state.rotation;
+    velocityX[i] = state.velocityX;
+    velocityY[i] = state.velocityY;
+    rotationSpeed[i] = state.rotationSpeed;
+    motionAmount[i] = state.motionAmount;
+    opacity[i] = state.opacity;
+    circleRadius[i] = state.circleRadius;
+    circlePhase[i] = state.circlePhase;
+    waveAmplitudeX[i] = state.waveAmplitudeX;
+    waveAmplitudeY[i] = state.waveAmplitudeY;
+    waveFrequencyX[i] = state.waveFrequencyX;
+    waveFrequencyY[i] = state.waveFrequencyY;
+    wavePhaseX[i] = state.wavePhaseX;
+    wavePhaseY[i] = state.wavePhaseY;
+    baseX[i] = state.baseX;
+    baseY[i] = state.baseY;
+    audioReactivity[i] = state.audioReactivity;
+    bandIndex[i] = (state.reactsTo >= 0 && state.reactsTo < AUDIO_BAND_COUNT) ? state.reactsTo : AUDIO_BAND_COUNT;
+}
+
+void SpriteSystem::update(float deltaTime, const AudioFrame& audio) {
+    int count = size();
+    if (count == 0) return;
+    
+    // Band energies, plus the all-band average at AUDIO_BAND_COUNT
+    float energies[AUDIO_BAND_COUNT + 1];
+    float sum = 0.0;
+    for (int b = 0; b < AUDIO_BAND_COUNT; b++) {
+        energies[b] = audio.bandLevels[b];
+        sum += audio.bandLevels[b];
+    }
+    energies[AUDIO_BAND_COUNT] = sum / AUDIO_BAND_COUNT;
+    
+    // Audio reactivity: grow slightly and spin faster with energy
+    runGroup(0, count, [&](int begin, int end) {
+        float* s = scale.data();
+        float* spin = rotationSpeed.data();
+        const float* reactivity = audioReactivity.data();
+        const int* band = bandIndex.data();
+        for (int i = begin; i < end; i++) {
+            float impact = reactivity[i] > 0.0f ? energies[band[i]] * reactivity[i] : 0.0f;
+            s[i] *= 1.0f + impact * 0.1f;
+            spin[i] += impact * 0.1f;
+        }
+    });
+    
+    // Motion, one loop per type
+    runGroup(groupStart[MOTION_LINEAR], groupStart[MOTION_LINEAR + 1], [&](int begin, int end) {
+        updateLinear(begin, end, deltaTime);
+    });
+    runGroup(groupStart[MOTION_CIRCULAR], groupStart[MOTION_CIRCULAR + 1], [&](int begin, int end) {
+        updateCircular(begin, end, deltaTime);
+    });
+    runGroup(groupStart[MOTION_BOUNCE], groupStart[MOTION_BOUNCE + 1], [&](int begin, int end) {
+        updateBounce(begin, end, deltaTime);
+    });
+    runGroup(groupStart[MOTION_WAVE], groupStart[MOTION_WAVE + 1], [&](int begin, int end) {
+        updateWave(begin, end, deltaTime);
+    });
+    
+    // Spin, keeping rotation within (-TWO_PI, TWO_PI) like fmodf
+    runGroup(0, count, [&](int begin, int end) {
+        float* r = rotation.data();
+        const float* spin = rotationSpeed.data();
+        for (int i = begin; i < end; i++) {
+            float value = r[i] + spin[i] * deltaTime;
+            r[i] = value - TWO_PI * truncf(value * (1.0f / TWO_PI));
+        }
+    });
+}
+
+void SpriteSystem::updateLinear(int begin, int end, float deltaTime) {
+    float* px = x.data();
+    float* py = y.data();
+    const float* vx = velocityX.data();
+    const float* vy = velocityY.data();
+    
+    // Move, wrapping around the edges
+    for (int i = begin; i < end; i++) {
+        float nx = px[i] + vx[i] * deltaTime;
+        float ny = py[i] + vy[i] * deltaTime;
+        nx = nx < 0.0f ? 1.0f : nx;
+        nx = nx > 1.0f ? 0.0f : nx;
+        ny = ny < 0.0f ? 1.0f : ny;
+        ny = ny > 1.0f ? 0.0f : ny;
+        px[i] = nx;
+        py[i] = ny;
+    }
+}
+
+void SpriteSystem::updateCircular(int begin, int end, float deltaTime) {
+    float* px = x.data();
+    float* py = y.data();
+    float* r = rotation.data();
+    float* phase = circlePhase.data();
+    const float* amount = motionAmount.data();
+    const float* radius = circleRadius.data();
+    const float* bx = baseX.data();
+    const float* by = baseY.data();
+    
+    // Orbit the base position, facing the direction of travel
+    for (int i = begin; i < end; i++) {
+        float p = phase[i] + deltaTime * amount[i];
+        phase[i] = p;
+        px[i] = bx[i] + fastCos(p) * radius[i];
+        py[i] = by[i] + fastSin(p) * radius[i];
+        r[i] = p + HALF_PI;
+    }
+}
+
+void SpriteSystem::updateBounce(int begin, int end, float deltaTime) {
+    float* px = x.data();
+    float* py = y.data();
+    float* vx = velocityX.data();
+    float* vy = velocityY.data();
+    const float* amount = motionAmount.data();
+    
+    // Move, reflecting off the edges and stepping back inside
+    for (int i = begin; i < end; i++) {
+        float nx = px[i] + vx[i] * deltaTime * amount[i];
+        float ny = py[i] + vy[i] * deltaTime * amount[i];
+        bool hitX = nx <= 0.0f || nx >= 1.0f;
+        bool hitY = ny <= 0.0f || ny >= 1.0f;
+        vx[i] = hitX ? -vx[i] : vx[i];
+        vy[i] = hitY ? -vy[i] : vy[i];
+        px[i] = hitX ? std::min(std::max(nx, 0.01f), 0.99f) : nx;
+        py[i] = hitY ? std::min(std::max(ny, 0.01f), 0.99f) : ny;
+    }
+}
+
+void SpriteSystem::updateWave(int begin, int end, float deltaTime) {
+    float* px = x.data();
+    float* py = y.data();
+    float* r = rotation.data();
+    float* phaseX = wavePhaseX.data();
+    float* phaseY = wavePhaseY.data();
+    const float* amount = motionAmount.data();
+    const float* amplitudeX = waveAmplitudeX.data();
+    const float* amplitudeY = waveAmplitudeY.data();
+    const float* frequencyX = waveFrequencyX.data();
+    const float* frequencyY = waveFrequencyY.data();
+    const float* bx = baseX.data();
+    const float* by = baseY.data();
+    
+    // Lissajous path around the base position, facing along it
+    for (int i = begin; i < end; i++) {
+        float ax = phaseX[i] + deltaTime * frequencyX[i] * amount[i];
+        float ay = phaseY[i] + deltaTime * frequencyY[i] * amount[i];
+        phaseX[i] = ax;
+        phaseY[i] = ay;
+        
+        px[i] = bx[i] + fastCos(ax) * amplitudeX[i];
+        py[i] = by[i] + fastSin(ay) * amplitudeY[i];
+        
+        float dx = -fastSin(ax) * amplitudeX[i] * frequencyX[i];
+        float dy = fastCos(ay) * amplitudeY[i] * frequencyY[i];
+        r[i] = fastAtan2(dy, dx);
+    }
+}
@@ -0,0 +1,109 @@
+// File: src/Utils/SpriteSystem.h
+#pragma once
+
+#include "ofMain.h"
+#include "AudioFrame.h"
+
+enum MotionType {
+    MOTION_NONE,
+    MOTION_LINEAR,
+    MOTION_CIRCULAR,
+    MOTION_BOUNCE,
+    MOTION_WAVE,
+    MOTION_FOLLOW,
+    MOTION_TYPE_COUNT
+};
+
+// Simulation state of one sprite, used to move it in and out of a system
+struct SpriteState {
+    float x, y, scale, rotation;
+    float velocityX, velocityY, rotationSpeed;
+    MotionType motionType;
+    float motionAmount;
+    float opacity;
+    
+    // Motion parameters for different types
+    float circleRadius, circlePhase;
+    float waveAmplitudeX, waveAmplitudeY;
+    float waveFrequencyX, waveFrequencyY;
+    float wavePhaseX, wavePhaseY;
+    float baseX, baseY;
+    
+    // Audio reactivity
+    float audioReactivity;
+    int reactsTo; // AudioBand index, or -1 for all bands
+    
+    SpriteState();
+};
+
+// Data-oriented sprite simulation. State lives in parallel arrays kept
+// partitioned by motion type, so update() runs one branch-free loop per
+// type. Sprites are addressed by handles that stay valid while the dense
+// slots behind them are swapped around.
+class SpriteSystem {
+public:
+    SpriteSystem();
+    
+    // Add a sprite and return its handle
+    int add(const SpriteState& state);
+    void remove(int handle);
+    void clear();
+    
+    // Copy a sprite's whole state out or in
+    SpriteState get(int handle);
+    void set(int handle, const SpriteState& state);
+    
+    // Moves the sprite to the group of its new type
+    void setMotionType(int handle, MotionType type);
+    
+    // Audio reactivity, motion and spin for every sprite
+    void update(float deltaTime, const AudioFrame& audio);
+    
+    int size() { return (int)x.size(); }
+    
+    // Dense slot of a handle; slots change when sprites are added, removed
+    // or change motion type
+    int getIndex(int handle) { return handleToIndex[handle]; }
+    
+    // Slots [begin, end) of one motion type
+    int getGroupBegin(MotionType type) { return groupStart[type]; }
+    int getGroupEnd(MotionType type) { return groupStart[type + 1]; }
+    
+    // State arrays, indexed by slot
+    vector<float> x, y, scale, rotation;
+    vector<float> velocityX, velocityY, rotationSpeed;
+    vector<float> motionAmount, opacity;
+    vector<float> circleRadius, circlePhase;
+    vector<float> waveAmplitudeX, waveAmplitudeY;
+    vector<float> waveFrequencyX, waveFrequencyY;
+    vector<float> wavePhaseX, wavePhaseY;
+    vector<float> baseX, baseY;
+    vector<float> audioReactivity;
+    
+    // Band lookup per slot: AUDIO_BAND_COUNT stands for the all-band average
+    vector<int> bandIndex;
+    
+private:
+    // First slot of each motion type; groupStart[MOTION_TYPE_COUNT] is the size
+    int groupStart[MOTION_TYPE_COUNT + 1];
+    
+    vector<int> handleToIndex;
+    vector<int> indexToHandle;
+    vector<int> freeHandles;
+    
+    void swapSlots(int a, int b);
+    void pushSlot(const SpriteState& state, int handle);
+    void popSlot();
+    void writeSlot(int index, const SpriteState& state);
+    
+    // Motion type of the group holding a slot
+    int getGroupOf(int index);
+    
+    // Move a slot from one group to another; returns its new slot
+    int moveToGroup(int index, int from, int to);
+    
+    void updateLinear(int begin, int end, float deltaTime);
+    void updateCircular(int begin, int end, float deltaTime);
+    void updateBounce(int begin, int end, float deltaTime);
+    void updateWave(int begin, int end, float deltaTime);
+};
@@ -0,0 +1,55 @@
+// File: src/Utils/TripleBuffer.h
+#pragma once
+
+#include "ofMain.h"
+#include <atomic>
+
+// Lock-free triple buffer for handing whole snapshots from one producer
+// thread to one consumer thread. The producer fills getWriteBuffer() and
+// publish()es it; the consumer acquire()s the newest published snapshot
+// and reads it through getReadBuffer() until its next acquire(). Neither
+// side ever waits or sees a snapshot that is being written.
+template<typename T>
+class TripleBuffer {
+public:
+    TripleBuffer() : writeIndex(0), middle(1), readIndex(2) {}
+
+    // Direct access for sizing the buffers; only call while no other thread is using them
+    T& getBuffer(int index) { return buffers[index]; }
+    static int size() { return 3; }
+
+    // Producer
+    T& getWriteBuffer() { return buffers[writeIndex]; }
+
+    void publish() {
+        int previous = middle.exchange(writeIndex | dirtyBit, std::memory_order_acq_rel);
+        writeIndex = previous & indexMask;
+    }
+
+    // Consumer: returns false if nothing new was published since the last call
+    bool acquire() {
+        if ((middle.load(std::memory_order_relaxed) & dirtyBit) == 0) {
+            return false;
+        }
+        int previous = middle.exchange(readIndex, std::memory_order_acq_rel);
+        readIndex = previous & indexMask;
+        return true;
+    }
+
+    const T& getReadBuffer() const { return buffers[readIndex]; }
+
+private:
+    static const int dirtyBit = 4;
+    static const int indexMask = 3;
+
+    T buffers[3];
+    // The producer's index, the shared slot and the consumer's index each
+    // get their own cache line; padded rather than alignas(64), so new
+    // needs no over-aligned allocation
+    int writeIndex;
+    char paddingBeforeMiddle[64 - sizeof(int)];
+    std::atomic<int> middle;
+    char paddingAfterMiddle[64 - sizeof(std::atomic<int>)];
+    int readIndex;
+    char paddingAfterRead[64 - sizeof(int)];
+};
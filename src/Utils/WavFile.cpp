@@ -0,0 +1,143 @@
+// File: src/Utils/WavFile.cpp
+#include "WavFile.h"
+#include <fstream>
+
+// Little-endian readers; WAV data is always little-endian
+static uint32_t readUInt32(const unsigned char* data) {
+    return data[0] | (data[1] << 8) | (data[2] << 16) | ((uint32_t)data[3] << 24);
+}
+
+static uint16_t readUInt16(const unsigned char* data) {
+    return data[0] | (data[1] << 8);
+}
+
+WavFile::WavFile() {
+    sampleRate = 0;
+}
+
+void WavFile::clear() {
+    samples.clear();
+    sampleRate = 0;
+}
+
+bool WavFile::load(const string& path) {
+    clear();
+
+    std::ifstream file(ofToDataPath(path), std::ios::binary);
+    if (!file) {
+        ofLogError("WavFile") << "Could not open " << path;
+        return false;
+    }
+
+    // RIFF header
+    unsigned char header[12];
+    if (!file.read((char*)header, 12) || memcmp(header, "RIFF", 4) != 0 || memcmp(header + 8, "WAVE", 4) != 0) {
+        ofLogError("WavFile") << path << " is not a RIFF/WAVE file";
+        return false;
+    }
+
+    // Walk the chunks until both fmt and data have been seen
+    int format = 0;
+    int numChannels = 0;
+    int bitsPerSample = 0;
+    bool haveFormat = false;
+
+    unsigned char chunkHeader[8];
+    while (file.read((char*)chunkHeader, 8)) {
+        uint32_t chunkSize = readUInt32(chunkHeader + 4);
+
+        if (memcmp(chunkHeader, "fmt ", 4) == 0) {
+            unsigned char fmt[40] = { 0 };
+            uint32_t readSize = std::min<uint32_t>(chunkSize, sizeof(fmt));
+            if (chunkSize < 16 || !file.read((char*)fmt, readSize)) {
+                ofLogError("WavFile") << path << " has a malformed fmt chunk";
+                return false;
+            }
+            file.seekg(chunkSize - readSize + (chunkSize & 1), std::ios::cur);
+
+            format = readUInt16(fmt);
+            numChannels = readUInt16(fmt + 2);
+            sampleRate = readUInt32(fmt + 4);
+            bitsPerSample = readUInt16(fmt + 14);
+
+            // WAVE_FORMAT_EXTENSIBLE keeps the real format in the sub-format GUID
+            if (format == 0xFFFE && chunkSize >= 26) {
+                format = readUInt16(fmt + 24);
+            }
+            haveFormat = true;
+        } else if (memcmp(chunkHeader, "data", 4) == 0) {
+            if (!haveFormat) {
+                ofLogError("WavFile") << path << " has no fmt chunk before its data";
+                return false;
+            }
+
+            bool isPcm = format == 1 && (bitsPerSample == 16 || bitsPerSample == 24 || bitsPerSample == 32);
+            bool isFloat = format == 3 && bitsPerSample == 32;
+            if ((!isPcm && !isFloat) || numChannels < 1) {
+                ofLogError("WavFile") << path << ": unsupported format " << format << " with " << bitsPerSample << " bits";
+                sampleRate = 0;
+                return false;
+            }
+
+            // Never trust the size further than the file goes: streaming
+            // recorders leave 0 or 0xFFFFFFFF as a placeholder, meaning
+            // "to the end of the file"
+            std::streamoff dataStart = file.tellg();
+            file.seekg(0, std::ios::end);
+            std::streamoff remaining = file.tellg() - dataStart;
+            file.seekg(dataStart);
+            uint64_t dataSize = (chunkSize == 0 || chunkSize == 0xFFFFFFFF) ?
+                                (uint64_t)remaining : std::min<uint64_t>(chunkSize, (uint64_t)remaining);
+
+            int bytesPerSample = bitsPerSample / 8;
+            size_t frameBytes = bytesPerSample * numChannels;
+            size_t numFrames = (size_t)(dataSize / frameBytes);
+            samples.resize(numFrames);
+
+            // Decode in fixed-size blocks, averaging the channels of each frame
+            const size_t blockFrames = 16384;
+            vector<unsigned char> block(blockFrames * frameBytes);
+            size_t frame = 0;
+            while (frame < numFrames) {
+                size_t count = std::min(blockFrames, numFrames - frame);
+                file.read((char*)block.data(), count * frameBytes);
+                count = (size_t)file.gcount() / frameBytes;
+                if (count == 0) break;
+
+                const unsigned char* p = block.data();
+                for (size_t i = 0; i < count; i++, frame++) {
+                    float sum = 0;
+
+                    for (int channel = 0; channel < numChannels; channel++, p += bytesPerSample) {
+                        if (isFloat) {
+                            float value;
+                            uint32_t bits = readUInt32(p);
+                            memcpy(&value, &bits, sizeof(float));
+                            sum += value;
+                        } else if (bitsPerSample == 16) {
+                            sum += (int16_t)readUInt16(p) / 32768.0f;
+                        } else if (bitsPerSample == 24) {
+                            // Shift into the top of an int32 so the sign extends
+                            int32_t value = (int32_t)(((uint32_t)p[0] << 8) | ((uint32_t)p[1] << 16) | ((uint32_t)p[2] << 24)) >> 8;
+                            sum += value / 8388608.0f;
+                        } else {
+                            sum += (int32_t)readUInt32(p) / 2147483648.0f;
+                        }
+                    }
+
+                    samples[frame] = sum / numChannels;
+                }
+            }
+            samples.resize(frame);
+
+            return true;
+        } else {
+            // Skip unknown chunks (padded to an even size)
+            file.seekg(chunkSize + (chunkSize & 1), std::ios::cur);
+        }
+    }
+
+    ofLogError("WavFile") << path << " has no data chunk";
+    sampleRate = 0;
+    return false;
+}
@@ -0,0 +1,24 @@
+// File: src/Utils/WavFile.h
+#pragma once
+
+#include "ofMain.h"
+
+// Minimal RIFF/WAVE decoder for offline analysis and track replay.
+// Supports 16/24/32-bit integer PCM and 32-bit float; channels are
+// averaged down to mono.
+class WavFile {
+public:
+    WavFile();
+
+    bool load(const string& path);
+    void clear();
+
+    const vector<float>& getSamples() const { return samples; }
+    int getSampleRate() const { return sampleRate; }
+    size_t getNumSamples() const { return samples.size(); }
+    float getDuration() const { return sampleRate > 0 ? (float)samples.size() / sampleRate : 0; }
+
+private:
+    vector<float> samples;
+    int sampleRate;
+};
@@ -0,0 +1,118 @@
+// File: src/Utils/WaveEffect.cpp
+#include "WaveEffect.h"
+
+WaveEffect::WaveEffect() : Effect("wave") {
+    time = 0;
+    currentAmplitude = 0;
+    
+    // Initialize parameters with defaults
+    amplitudeParam = addParameter("amplitude", 1.0);
+    frequencyParam = addParameter("frequency", 1.0);
+    speedParam = addParameter("speed", 2.0);
+    directionParam = addParameter("direction", DIRECTION_HORIZONTAL);
+    noiseAmountParam = addParameter("noiseAmount", 0.0);
+    audioReactivityParam = addParameter("audioReactivity", 0.5);
+}
+
+WaveEffect::~WaveEffect() {
+    // Clean up resources
+}
+
+void WaveEffect::setup(int width, int height) {
+    Effect::setup(width, height);
+    
+    // Load wave shader
+    if (!waveShader.isLoaded()) {
+        bool loaded = waveShader.load("shaders/wave");
+        if (!loaded) {
+            ofLogError("WaveEffect") << "Failed to load wave shader";
+        } else {
+            ofLogNotice("WaveEffect") << "Wave shader loaded successfully";
+        }
+    }
+}
+
+void WaveEffect::update(const AudioFrame& audio, map<string, float>& globalParams) {
+    time = ofGetElapsedTimef();
+    
+    // Bass swells the waves
+    float energy = getAudioEnergy(audio, AUDIO_BAND_BASS);
+    currentAmplitude = param(amplitudeParam) * (1.0 + energy * param(audioReactivityParam) * 2.0);
+}
+
+int WaveEffect::getDirection() {
+    return (int)ofClamp((int)(param(directionParam) + 0.5), DIRECTION_HORIZONTAL, DIRECTION_BOTH);
+}
+
+void WaveEffect::apply(ofFbo& inputFbo) {
+    // Without the shader pass the input through untouched
+    if (!waveShader.isLoaded()) {
+        ofSetColor(255);
+        inputFbo.draw(0, 0);
+        return;
+    }
+    
+    waveShader.begin();
+    
+    // Set shader parameters
+    waveShader.setUniform1f("time", time);
+    waveShader.setUniform1f("amplitude", currentAmplitude * intensity);
+    waveShader.setUniform1f("frequency", param(frequencyParam));
+    waveShader.setUniform1f("speed", param(speedParam));
+    waveShader.setUniform2f("resolution", width, height);
+    waveShader.setUniform1i("direction", getDirection());
+    waveShader.setUniform1f("noiseAmount", param(noiseAmountParam) * intensity);
+    
+    // Draw input using shader
+    ofSetColor(255);
+    inputFbo.draw(0, 0);
+    
+    waveShader.end();
+}
+
+string WaveEffect::getStageSource() {
+    // Same math as wave.frag
+    return R"(
+uniform float $time;
+uniform float $amplitude;
+uniform float $frequency;
+uniform float $speed;
+uniform int $direction;
+uniform float $noiseAmount;
+
+float $random(vec2 co) {
+    return fract(sin(dot(co.xy, vec2(12.9898, 78.233))) * 43758.5453);
+}
+
+vec2 $uv(vec2 uv) {
+    if ($direction != 1) {
+        float xWave = $amplitude * 0.01 * sin(uv.y * $frequency * 10.0 + $time * $speed);
+        if ($noiseAmount > 0.0) {
+            xWave += ($random(vec2(uv.y, $time)) - 0.5) * $noiseAmount * 0.02;
+        }
+        uv.x += xWave;
+    }
+    if ($direction != 0) {
+        float yWave = $amplitude * 0.01 * sin(uv.x * $frequency * 10.0 + $time * $speed);
+        if ($noiseAmount > 0.0) {
+            yWave += ($random(vec2(uv.x, $time)) - 0.5) * $noiseAmount * 0.02;
+        }
+        uv.y += yWave;
+    }
+    return uv;
+}
+
+vec4 $color(vec4 color, vec2 uv) {
+    return color;
+}
+)";
+}
+
+void WaveEffect::setStageUniforms(ofShader& shader, const string& prefix) {
+    shader.setUniform1f(prefix + "time", time);
+    shader.setUniform1f(prefix + "amplitude", currentAmplitude * intensity);
+    shader.setUniform1f(prefix + "frequency", param(frequencyParam));
+    shader.setUniform1f(prefix + "speed", param(speedParam));
+    shader.setUniform1i(prefix + "direction", getDirection());
+    shader.setUniform1f(prefix + "noiseAmount", param(noiseAmountParam) * intensity);
+}
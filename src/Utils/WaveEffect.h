@@ -0,0 +1,47 @@
+// File: src/Utils/WaveEffect.h
+#pragma once
+
+#include "Effect.h"
+
+class WaveEffect : public Effect {
+public:
+    // Values of the direction parameter
+    enum Direction {
+        DIRECTION_HORIZONTAL = 0,
+        DIRECTION_VERTICAL,
+        DIRECTION_BOTH
+    };
+    
+    WaveEffect();
+    virtual ~WaveEffect();
+    
+    // Setup the effect
+    void setup(int width, int height) override;
+    
+    // Update the effect
+    void update(const AudioFrame& audio, map<string, float>& globalParams) override;
+    
+    // Apply the effect to an input FBO
+    void apply(ofFbo& inputFbo) override;
+    
+    // Fusable stage: pure uv distortion
+    bool isFusable() override { return true; }
+    string getStageSource() override;
+    void setStageUniforms(ofShader& shader, const string& prefix) override;
+    
+private:
+    // Shader for the wave distortion
+    ofShader waveShader;
+    
+    // Shader time in seconds
+    float time;
+    
+    // Amplitude after audio modulation
+    float currentAmplitude;
+    
+    // Parameter handles
+    int amplitudeParam, frequencyParam, speedParam, directionParam;
+    int noiseAmountParam, audioReactivityParam;
+    
+    int getDirection();
+};
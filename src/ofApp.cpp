@@ -9,6 +9,9 @@ void ofApp::setup(){
     ofEnableAlphaBlending();
     ofBackground(20);
     
+    // Normalized texture coordinates, as the sampler2D shaders expect
+    ofDisableArbTex();
+    
     // Setup canvas dimensions
     canvasWidth = 1280;
     canvasHeight = 720;
@@ -57,24 +60,22 @@ void ofApp::update(){
     // Update audio analyzer
     audioAnalyzer.update();
     
-    // Get audio data
-    float* spectrum = audioAnalyzer.getSpectrum();
-    int numBands = audioAnalyzer.getNumBands();
-    float phase = audioAnalyzer.getBeatPhase();
+    // Take this frame's immutable audio snapshot
+    const AudioFrame& audio = audioAnalyzer.acquireFrame();
     
     // Only update if playing
     if (playing) {
         // Update layers
-        backgroundLayer.update(deltaTime, spectrum, numBands, phase);
-        spriteLayer.update(deltaTime, spectrum, numBands);
-        fxLayer.update(phase, spectrum, numBands);
-        cameraLayer.update(deltaTime, spectrum, numBands, phase);
+        backgroundLayer.update(deltaTime, audio);
+        spriteLayer.update(deltaTime, audio);
+        fxLayer.update(audio);
+        cameraLayer.update(deltaTime, audio);
         
-        // Set camera feedback if enabled
+        // Share the camera texture with the background feedback, no copy
         if (cameraLayer.isActive() && cameraLayer.isFeedbackEnabled()) {
-            // Get camera pixels and pass to background layer
-            // In a full implementation, this would pass actual camera pixels
-            // For now, we'll skip this part
+            backgroundLayer.setFeedbackSource(cameraLayer.getCameraTexture());
+        } else {
+            backgroundLayer.setFeedbackSource(nullptr);
         }
     }
     
@@ -84,15 +85,15 @@ void ofApp::update(){
 
 //--------------------------------------------------------------
 void ofApp::draw(){
-    // Draw background layer to main FBO
-    mainFbo.begin();
-    ofClear(0, 0, 0, 255);
+    // Render background and sprite layers into their own FBOs
     backgroundLayer.draw();
-    mainFbo.end();
+    spriteLayer.draw();
     
-    // Draw sprite layer on top
+    // Composite them into the main FBO
     mainFbo.begin();
-    spriteLayer.draw();
+    ofClear(0, 0, 0, 255);
+    backgroundLayer.getOutputFbo().draw(0, 0);
+    spriteLayer.getOutputFbo().draw(0, 0);
     mainFbo.end();
     
     // Process with FX layer
@@ -130,14 +131,18 @@ void ofApp::draw(){
     if (debugMode) {
         ofDrawBitmapStringHighlight("FPS: " + ofToString(ofGetFrameRate(), 1), 10, 20);
         ofDrawBitmapStringHighlight("Scene: " + ofToString(currentScene + 1), 10, 40);
-        ofDrawBitmapStringHighlight("BPM: " + ofToString(audioAnalyzer.getBPM(), 1), 10, 60);
-        ofDrawBitmapStringHighlight("Phase: " + ofToString(audioAnalyzer.getBeatPhase(), 2), 10, 80);
+        const AudioFrame& audio = audioAnalyzer.getFrame();
+        ofDrawBitmapStringHighlight("BPM: " + ofToString(audio.bpm, 1), 10, 60);
+        ofDrawBitmapStringHighlight("Phase: " + ofToString(audio.beatPhase, 2), 10, 80);
+        if (AllocationCounter::isEnabled()) {
+            ofDrawBitmapStringHighlight("Audio allocs/frame: " + ofToString(audioAnalyzer.getFrameAllocations()), 10, 100);
+        }
         
         // Draw waveform
         ofPushStyle();
         ofSetColor(0, 255, 0);
-        float* waveform = audioAnalyzer.getWaveform();
-        for (int i = 0; i < audioAnalyzer.getBufferSize() - 1; i++) {
+        const vector<float>& waveform = audio.waveform;
+        for (int i = 0; i < (int)waveform.size() - 1; i++) {
             ofDrawLine(10 + i * 0.5, 120 + waveform[i] * 50, 10 + (i + 1) * 0.5, 120 + waveform[i + 1] * 50);
         }
         ofPopStyle();
@@ -224,7 +229,14 @@ void ofApp::gotMessage(ofMessage msg){
 
 //--------------------------------------------------------------
 void ofApp::dragEvent(ofDragInfo dragInfo){ 
-
+    // Dropping a WAV file switches the analyzer to track replay
+    for (auto& file : dragInfo.files) {
+        if (ofToLower(ofFilePath::getFileExt(file)) == "wav") {
+            // Analysis runs in the background; playback starts when it is done
+            audioAnalyzer.loadTrack(file, true);
+            break;
+        }
+    }
 }
 
 //--------------------------------------------------------------
@@ -251,11 +263,11 @@ void ofApp::saveScene(int sceneIndex) {
     // Save FX layer
     ofXml fxXml;
     
-    // Save each effect
-    for (auto& effect : fxLayer.getEffects()) {
+    // Save each effect, in chain order
+    for (auto effect : fxLayer.getEffects()) {
         ofXml effectXml;
-        effect.second->savePreset(effectXml);
-        fxXml.appendChild(effect.first).appendChild(effectXml);
+        effect->savePreset(effectXml);
+        fxXml.appendChild(effect->getName()).appendChild(effectXml);
     }
     
     xml.appendChild("fxLayer").appendChild(fxXml);
@@ -306,12 +318,15 @@ void ofApp::loadScene(int sceneIndex) {
             ofXml fxXml = xml.getChild("fxLayer");
             auto effectNodes = fxXml.getChildren();
             
+            // Effects are saved in chain order
+            int chainIndex = 0;
             for (auto& effectNode : effectNodes) {
                 string effectName = effectNode.getName();
                 Effect* effect = fxLayer.getEffect(effectName);
                 
                 if (effect != nullptr) {
                     effect->loadPreset(effectNode);
+                    fxLayer.moveEffect(effectName, chainIndex++);
                 }
             }
         }
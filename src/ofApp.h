@@ -7,6 +7,7 @@
 #include "Layers/FXLayer.h"
 #include "Layers/CameraLayer.h"
 #include "Utils/AudioAnalyzer.h"
+#include "Utils/AllocationCounter.h"
 #include "UI/GUI.h"
 
 class ofApp : public ofBaseApp{
@@ -0,0 +1,156 @@
+// File: tests/CameraCaptureTest.cpp
+// Runs a PatternSource through CameraCapture and checks what reaches the
+// render side: frames arrive, their frame numbers and timestamps increase,
+// and every frame is its source frame converted to RGBA.
+#include "ofMain.h"
+#include "CameraCapture.h"
+#include "Check.h"
+#include <chrono>
+#include <map>
+#include <mutex>
+#include <thread>
+
+// A PatternSource reduced to 1, 3 or 4 channels, so every branch of the
+// RGBA conversion is covered. Keeps a copy of each frame it delivers, keyed
+// by the frame number CameraCapture will give it
+class RecordingSource : public CameraSource {
+public:
+    RecordingSource(int channels) {
+        this->channels = channels;
+        frameCount = 0;
+    }
+
+    bool setup(int width, int height, int frameRate) override {
+        if (!pattern.setup(width, height, frameRate)) return false;
+        pixels.allocate(width, height, channels);
+        return true;
+    }
+    void close() override { pattern.close(); }
+
+    void update() override {
+        pattern.update();
+        if (!pattern.isFrameNew()) return;
+
+        // Gray is the mean of r, g and b; alpha varies along each row
+        const unsigned char* in = pattern.getPixels().getData();
+        unsigned char* out = pixels.getData();
+        int width = pixels.getWidth();
+        int count = width * pixels.getHeight();
+        for (int i = 0; i < count; i++, in += 3, out += channels) {
+            if (channels == 1) {
+                out[0] = (in[0] + in[1] + in[2]) / 3;
+                continue;
+            }
+            out[0] = in[0];
+            out[1] = in[1];
+            out[2] = in[2];
+            if (channels == 4) out[3] = ((i % width) * 4) & 255;
+        }
+
+        const unsigned char* data = pixels.getData();
+        std::lock_guard<std::mutex> guard(recordedMutex);
+        recorded[++frameCount].assign(data, data + count * channels);
+    }
+
+    bool isFrameNew() override { return pattern.isFrameNew(); }
+    const ofPixels& getPixels() override { return pixels; }
+    int getWidth() override { return pattern.getWidth(); }
+    int getHeight() override { return pattern.getHeight(); }
+    string getName() override { return "Recording"; }
+
+    // Render thread: the source frame that became frame number n
+    bool getRecorded(uint64_t n, vector<unsigned char>& data) {
+        std::lock_guard<std::mutex> guard(recordedMutex);
+        auto found = recorded.find(n);
+        if (found == recorded.end()) return false;
+        data = found->second;
+        return true;
+    }
+
+private:
+    int channels;
+    PatternSource pattern;
+    ofPixels pixels;
+    uint64_t frameCount;
+    std::map<uint64_t, vector<unsigned char>> recorded;
+    std::mutex recordedMutex;
+};
+
+// Number of pixels whose RGBA differs from the expected conversion of src
+static int countMismatches(const ofPixels& rgba, const vector<unsigned char>& src, int channels) {
+    const unsigned char* data = rgba.getData();
+    int count = rgba.getWidth() * rgba.getHeight();
+    int mismatches = 0;
+    for (int i = 0; i < count; i++) {
+        const unsigned char* in = &src[i * channels];
+        unsigned char expected[4] = { in[0], in[0], in[0], 255 };
+        if (channels >= 3) {
+            expected[1] = in[1];
+            expected[2] = in[2];
+        }
+        if (channels == 4) expected[3] = in[3];
+        mismatches += memcmp(&data[i * 4], expected, 4) != 0;
+    }
+    return mismatches;
+}
+
+int main() {
+    const int width = 64;
+    const int height = 48;
+    const int framesWanted = 20;
+
+    for (int channels : { 1, 3, 4 }) {
+        RecordingSource* source = new RecordingSource(channels);
+        CameraCapture capture;
+        CHECK(capture.setup(source, width, height, 120), "%d channels: setup failed", channels);
+        if (!capture.isOpen()) continue;
+        CHECK(capture.getWidth() == width && capture.getHeight() == height,
+              "%d channels: capture is %gx%g, expected %dx%d",
+              channels, capture.getWidth(), capture.getHeight(), width, height);
+
+        // Poll like the render thread, at a rate that sometimes misses frames
+        int received = 0;
+        uint64_t lastNumber = 0;
+        uint64_t lastTimestamp = 0;
+        auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+        while (received < framesWanted && std::chrono::steady_clock::now() < deadline) {
+            if (!capture.acquire()) {
+                std::this_thread::sleep_for(std::chrono::milliseconds(3));
+                continue;
+            }
+            const CameraFrame& frame = capture.getFrame();
+            received++;
+
+            CHECK(frame.frameNumber > lastNumber, "%d channels: frame %llu after frame %llu",
+                  channels, (unsigned long long)frame.frameNumber, (unsigned long long)lastNumber);
+            CHECK(frame.timestamp > lastTimestamp, "%d channels: frame %llu timestamp %llu after %llu",
+                  channels, (unsigned long long)frame.frameNumber,
+                  (unsigned long long)frame.timestamp, (unsigned long long)lastTimestamp);
+            lastNumber = frame.frameNumber;
+            lastTimestamp = frame.timestamp;
+
+            CHECK(frame.pixels.getWidth() == (size_t)width && frame.pixels.getHeight() == (size_t)height &&
+                  frame.pixels.getNumChannels() == 4,
+                  "%d channels: frame %llu is not %dx%d RGBA", channels, (unsigned long long)frame.frameNumber,
+                  width, height);
+            if (frame.pixels.getNumChannels() != 4) continue;
+
+            vector<unsigned char> expected;
+            bool found = source->getRecorded(frame.frameNumber, expected);
+            CHECK(found, "%d channels: frame %llu was never produced", channels,
+                  (unsigned long long)frame.frameNumber);
+            if (!found) continue;
+
+            int mismatches = countMismatches(frame.pixels, expected, channels);
+            CHECK(mismatches == 0, "%d channels: frame %llu has %d pixels converted wrongly",
+                  channels, (unsigned long long)frame.frameNumber, mismatches);
+        }
+        CHECK(received == framesWanted, "%d channels: only %d of %d frames arrived",
+              channels, received, framesWanted);
+
+        capture.close();
+        CHECK(!capture.isOpen(), "%d channels: still open after close()", channels);
+    }
+
+    return checkResult("CameraCaptureTest");
+}
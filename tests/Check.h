@@ -0,0 +1,28 @@
+// File: tests/Check.h
+#pragma once
+
+#include <cstdio>
+
+// Minimal self-check support for the headless tests in this directory.
+// Each test is its own program: CHECK() reports failures as they happen
+// and checkResult() turns the count into the exit status for make test.
+static int checkFailures = 0;
+
+#define CHECK(condition, ...) \
+    do { \
+        if (!(condition)) { \
+            checkFailures++; \
+            printf("FAIL %s:%d: ", __FILE__, __LINE__); \
+            printf(__VA_ARGS__); \
+            printf("\n"); \
+        } \
+    } while (0)
+
+static inline int checkResult(const char* name) {
+    if (checkFailures == 0) {
+        printf("%s: ok\n", name);
+        return 0;
+    }
+    printf("%s: %d failures\n", name, checkFailures);
+    return 1;
+}
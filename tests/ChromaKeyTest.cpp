@@ -0,0 +1,188 @@
+// File: tests/ChromaKeyTest.cpp
+// Checks the table-driven, fixed-point ChromaKey against a float reference
+// of the per-pixel key in shaders/chromakey.frag.
+#include "ofMain.h"
+#include "ChromaKey.h"
+#include "Check.h"
+#include <random>
+
+struct KeySettings {
+    ofColor key;
+    float tolerance;
+    float softness;
+    float spill;
+};
+
+// Float reference, one pixel at a time. With softness 0 and spill 0 this is
+// the original hard key: pixels closer to the key than the tolerance turn
+// transparent and everything else is kept. A distance exactly at the
+// tolerance is keyed out, as smoothstep() is 0 at its lower edge
+static void referenceKey(const KeySettings& settings, const unsigned char* in, int channels, float* out) {
+    float color[3] = { in[0] / 255.0f, in[1] / 255.0f, in[2] / 255.0f };
+    float key[3] = { settings.key.r / 255.0f, settings.key.g / 255.0f, settings.key.b / 255.0f };
+    float alpha = channels == 4 ? in[3] / 255.0f : 1.0f;
+
+    // Distance to the key, normalized to 0-1
+    float distanceSquared = 0;
+    for (int c = 0; c < 3; c++) {
+        distanceSquared += (color[c] - key[c]) * (color[c] - key[c]);
+    }
+    float distance = sqrtf(distanceSquared) / sqrtf(3.0f);
+
+    float edge = std::max(settings.softness, 0.0001f);
+    float t = std::min(std::max((distance - settings.tolerance) / edge, 0.0f), 1.0f);
+    float mask = t * t * (3.0f - 2.0f * t);
+
+    // Chroma along the key's chroma direction
+    float keyMean = (key[0] + key[1] + key[2]) / 3.0f;
+    float colorMean = (color[0] + color[1] + color[2]) / 3.0f;
+    float direction[3];
+    float length = 0;
+    for (int c = 0; c < 3; c++) {
+        direction[c] = key[c] - keyMean;
+        length += direction[c] * direction[c];
+    }
+    length = sqrtf(length);
+    float amount = 0;
+    for (int c = 0; c < 3; c++) {
+        direction[c] = length > 0.0001f ? direction[c] / length : 0.0f;
+        amount += (color[c] - colorMean) * direction[c];
+    }
+    amount = std::max(amount, 0.0f);
+
+    for (int c = 0; c < 3; c++) {
+        float value = color[c] - direction[c] * amount * settings.spill;
+        out[c] = std::min(std::max(value, 0.0f), 1.0f) * 255.0f;
+    }
+    out[3] = alpha * mask * 255.0f;
+}
+
+// Key the pixels with ChromaKey and compare every channel to the reference
+static void compareToReference(const KeySettings& settings, const vector<unsigned char>& src, int channels,
+                               float maxError, const char* label) {
+    ChromaKey chromaKey;
+    chromaKey.setup(settings.key, settings.tolerance, settings.softness, settings.spill);
+
+    int numPixels = (int)(src.size() / channels);
+    vector<unsigned char> dst(numPixels * 4);
+    chromaKey.apply(src.data(), channels, dst.data(), numPixels);
+
+    float worst = 0;
+    int worstPixel = 0;
+    for (int i = 0; i < numPixels; i++) {
+        float expected[4];
+        referenceKey(settings, &src[i * channels], channels, expected);
+        for (int c = 0; c < 4; c++) {
+            float error = fabsf(dst[i * 4 + c] - expected[c]);
+            if (error > worst) {
+                worst = error;
+                worstPixel = i;
+            }
+        }
+    }
+    CHECK(worst <= maxError, "%s, %d channels: error %.2f at pixel %d", label, channels, worst, worstPixel);
+}
+
+// Random pixels plus the key color, grays and the RGB corners
+static vector<unsigned char> makePixels(int channels, const ofColor& key) {
+    std::mt19937 random(7);
+    vector<unsigned char> pixels;
+
+    auto add = [&](int r, int g, int b, int a) {
+        pixels.push_back(r);
+        pixels.push_back(g);
+        pixels.push_back(b);
+        if (channels == 4) pixels.push_back(a);
+    };
+
+    add(key.r, key.g, key.b, 255);
+    for (int v = 0; v < 256; v += 51) {
+        add(v, v, v, 255);
+    }
+    for (int corner = 0; corner < 8; corner++) {
+        add(corner & 1 ? 255 : 0, corner & 2 ? 255 : 0, corner & 4 ? 255 : 0, 128);
+    }
+    for (int i = 0; i < 20000; i++) {
+        add(random() & 255, random() & 255, random() & 255, random() & 255);
+    }
+    return pixels;
+}
+
+int main() {
+    // Rounding in the alpha table and the fixed-point spill: one step of 255
+    const float maxError = 1.0f;
+
+    const ofColor keys[] = { ofColor(0, 255, 0), ofColor(20, 40, 220), ofColor(128, 128, 128) };
+    const float softnesses[] = { 0.0f, 0.1f, 1.0f };
+    const float spills[] = { 0.0f, 0.5f, 1.0f };
+
+    for (const ofColor& key : keys) {
+        for (float softness : softnesses) {
+            for (float spill : spills) {
+                KeySettings settings = { key, 0.3f, softness, spill };
+                char label[128];
+                snprintf(label, sizeof(label), "key %d,%d,%d softness %.1f spill %.1f",
+                         key.r, key.g, key.b, softness, spill);
+                for (int channels = 3; channels <= 4; channels++) {
+                    compareToReference(settings, makePixels(channels, key), channels, maxError, label);
+                }
+            }
+        }
+    }
+
+    // Distance exactly at the tolerance: keyed out. Green key, pixel 100
+    // below it in green only, tolerance computed the way the table is
+    {
+        ChromaKey chromaKey;
+        float tolerance = sqrtf(100.0f * 100.0f / (3 * 255 * 255));
+        unsigned char onEdge[3] = { 0, 155, 0 };
+        unsigned char beyond[3] = { 0, 154, 0 };
+        unsigned char out[4];
+
+        chromaKey.setup(ofColor(0, 255, 0), tolerance, 0.0f, 0.0f);
+        chromaKey.apply(onEdge, 3, out, 1);
+        CHECK(out[3] == 0, "pixel at the tolerance should be keyed out, alpha %d", out[3]);
+
+        // One step further is past the 0.0001 hard edge and fully kept
+        chromaKey.apply(beyond, 3, out, 1);
+        CHECK(out[3] == 255, "pixel past a hard tolerance should be opaque, alpha %d", out[3]);
+
+        // With softness 1 the same pixel only starts to fade in
+        chromaKey.setup(ofColor(0, 255, 0), tolerance, 1.0f, 0.0f);
+        chromaKey.apply(beyond, 3, out, 1);
+        CHECK(out[3] <= 1, "pixel just past a soft tolerance should be nearly clear, alpha %d", out[3]);
+    }
+
+    // Spill 0 leaves colors untouched; 3 and 4 channels agree on color,
+    // and 4-channel input multiplies its own alpha in
+    {
+        ChromaKey chromaKey;
+        chromaKey.setup(ofColor(0, 255, 0), 0.2f, 0.1f, 0.0f);
+        vector<unsigned char> rgb = makePixels(3, ofColor(0, 255, 0));
+        vector<unsigned char> rgba = makePixels(4, ofColor(0, 255, 0));
+        int numPixels = (int)(rgb.size() / 3);
+        vector<unsigned char> fromRgb(numPixels * 4);
+        vector<unsigned char> fromRgba(numPixels * 4);
+        chromaKey.apply(rgb.data(), 3, fromRgb.data(), numPixels);
+        chromaKey.apply(rgba.data(), 4, fromRgba.data(), numPixels);
+
+        int colorMismatches = 0;
+        int alphaMismatches = 0;
+        for (int i = 0; i < numPixels; i++) {
+            for (int c = 0; c < 3; c++) {
+                colorMismatches += fromRgb[i * 4 + c] != rgb[i * 3 + c];
+                colorMismatches += fromRgba[i * 4 + c] != fromRgb[i * 4 + c];
+            }
+            int expectedAlpha = (rgba[i * 4 + 3] * fromRgb[i * 4 + 3] + 127) / 255;
+            alphaMismatches += fromRgba[i * 4 + 3] != expectedAlpha;
+        }
+        CHECK(colorMismatches == 0, "spill 0 changed %d color channels", colorMismatches);
+        CHECK(alphaMismatches == 0, "%d RGBA pixels did not scale their own alpha", alphaMismatches);
+
+        // Keying RGBA in place gives the same result
+        chromaKey.apply(rgba.data(), 4, rgba.data(), numPixels);
+        CHECK(rgba == fromRgba, "keying in place differs from keying into a separate buffer");
+    }
+
+    return checkResult("ChromaKeyTest");
+}
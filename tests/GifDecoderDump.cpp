@@ -0,0 +1,47 @@
+// File: tests/GifDecoderDump.cpp
+// Decodes a GIF with GifDecoder and writes every composited frame to a
+// file as raw RGBA, for tests/compare_gifs.py to check against Pillow.
+// Prints "width height", one frame duration in seconds per line, then
+// "skipped N" with the frame count skipFrame() finds.
+//
+// Usage: GifDecoderDump input.gif frames.raw
+#include "ofMain.h"
+#include "GifDecoder.h"
+#include <cstdio>
+
+int main(int argc, char** argv) {
+    if (argc != 3) {
+        printf("Usage: %s input.gif frames.raw\n", argv[0]);
+        return 2;
+    }
+
+    GifDecoder decoder;
+    if (!decoder.open(argv[1])) {
+        return 1;
+    }
+
+    FILE* out = fopen(argv[2], "wb");
+    if (out == nullptr) {
+        printf("Cannot write %s\n", argv[2]);
+        return 1;
+    }
+
+    printf("%d %d\n", decoder.getWidth(), decoder.getHeight());
+    size_t frameBytes = (size_t)decoder.getWidth() * decoder.getHeight() * 4;
+    while (decoder.nextFrame()) {
+        fwrite(decoder.getCanvas().getData(), 1, frameBytes, out);
+        printf("%g\n", decoder.getFrameDuration());
+    }
+    fclose(out);
+
+    // Skipping must find the same frames without decoding them
+    GifDecoder skipper;
+    int skipped = 0;
+    if (skipper.open(argv[1])) {
+        while (skipper.skipFrame()) {
+            skipped++;
+        }
+    }
+    printf("skipped %d\n", skipped);
+    return 0;
+}
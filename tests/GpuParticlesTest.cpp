@@ -0,0 +1,269 @@
+// File: tests/GpuParticlesTest.cpp
+// Runs particles_update.frag the way GpuParticles does, one pass writing
+// all three state textures, and compares the result with SpriteSystem.
+// Needs a GL 3.2 core context from EGL; on a machine without a display,
+// Mesa's surfaceless platform works: EGL_PLATFORM=surfaceless make test-gl
+// Without a context it exits 77, not 0, so a skip never passes.
+#include "GpuParticles.h"
+#include "Check.h"
+#include <EGL/egl.h>
+#include <fstream>
+#include <sstream>
+#include <random>
+
+static const int PARTICLES = 20000;
+static const int STEPS = 30;
+static const int STATE_TEXTURES = 3;
+
+// Exit status for a test that could not run
+static const int SKIPPED = 77;
+
+// Same output bindings as GpuParticles::loadUpdateShader()
+static const char* STATE_OUTPUTS[STATE_TEXTURES] = { "outputPosition", "outputVelocity", "outputAttributes" };
+
+static bool createContext() {
+    EGLDisplay display = eglGetDisplay(EGL_DEFAULT_DISPLAY);
+    if (display == EGL_NO_DISPLAY || !eglInitialize(display, nullptr, nullptr) || !eglBindAPI(EGL_OPENGL_API)) {
+        return false;
+    }
+
+    EGLint configAttributes[] = { EGL_RENDERABLE_TYPE, EGL_OPENGL_BIT, EGL_NONE };
+    EGLConfig config = nullptr;
+    EGLint numConfigs = 0;
+    eglChooseConfig(display, configAttributes, &config, 1, &numConfigs);
+
+    EGLint contextAttributes[] = {
+        EGL_CONTEXT_MAJOR_VERSION, 3,
+        EGL_CONTEXT_MINOR_VERSION, 2,
+        EGL_CONTEXT_OPENGL_PROFILE_MASK, EGL_CONTEXT_OPENGL_CORE_PROFILE_BIT,
+        EGL_NONE
+    };
+    EGLContext context = eglCreateContext(display, numConfigs > 0 ? config : nullptr, EGL_NO_CONTEXT, contextAttributes);
+    if (context == EGL_NO_CONTEXT || !eglMakeCurrent(display, EGL_NO_SURFACE, EGL_NO_SURFACE, context)) {
+        return false;
+    }
+
+    // openFrameworks loads GL entry points through GLEW
+    glewExperimental = GL_TRUE;
+    return glewInit() == GLEW_OK;
+}
+
+static GLuint compileShader(GLenum type, const string& path) {
+    std::ifstream file(path);
+    std::stringstream source;
+    source << file.rdbuf();
+    string text = source.str();
+    const char* data = text.c_str();
+
+    GLuint shader = glCreateShader(type);
+    glShaderSource(shader, 1, &data, nullptr);
+    glCompileShader(shader);
+
+    GLint compiled = 0;
+    glGetShaderiv(shader, GL_COMPILE_STATUS, &compiled);
+    if (!compiled) {
+        char log[4096];
+        glGetShaderInfoLog(shader, sizeof(log), nullptr, log);
+        printf("%s: %s\n", path.c_str(), log);
+    }
+    return shader;
+}
+
+static GLuint loadUpdateProgram() {
+    GLuint program = glCreateProgram();
+    glAttachShader(program, compileShader(GL_VERTEX_SHADER, "data/shaders/particles_update.vert"));
+    glAttachShader(program, compileShader(GL_FRAGMENT_SHADER, "data/shaders/particles_update.frag"));
+    glBindAttribLocation(program, 0, "position");
+    for (int i = 0; i < STATE_TEXTURES; i++) {
+        glBindFragDataLocation(program, i, STATE_OUTPUTS[i]);
+    }
+    glLinkProgram(program);
+
+    GLint linked = 0;
+    glGetProgramiv(program, GL_LINK_STATUS, &linked);
+    return linked ? program : 0;
+}
+
+static GLuint makeFloatTexture(int width, int height, const float* data) {
+    GLuint texture;
+    glGenTextures(1, &texture);
+    glBindTexture(GL_TEXTURE_2D, texture);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA32F, width, height, 0, GL_RGBA, GL_FLOAT, data);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    return texture;
+}
+
+static void bindTexture(GLuint program, const char* name, GLuint texture, int unit) {
+    glActiveTexture(GL_TEXTURE0 + unit);
+    glBindTexture(GL_TEXTURE_2D, texture);
+    glUniform1i(glGetUniformLocation(program, name), unit);
+}
+
+// Difference of two angles, ignoring whole turns
+static float angleError(float a, float b) {
+    float error = fabsf(a - b);
+    return std::min(error, fabsf(error - TWO_PI));
+}
+
+int main() {
+    if (!createContext()) {
+        printf("GpuParticlesTest: no GL 3.2 context, skipped\n");
+        return SKIPPED;
+    }
+    printf("GL %s, %s\n", glGetString(GL_VERSION), glGetString(GL_RENDERER));
+
+    // Random particles of every GPU motion type, some starting at an edge
+    std::mt19937 random(3);
+    std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+    SpriteSystem system;
+    vector<int> handles;
+    vector<SpriteState> states;
+
+    for (int i = 0; i < PARTICLES; i++) {
+        SpriteState s;
+        s.x = s.baseX = unit(random);
+        s.y = s.baseY = unit(random);
+        s.velocityX = (unit(random) - 0.5f) * 0.3f;
+        s.velocityY = (unit(random) - 0.5f) * 0.3f;
+        s.rotation = unit(random) * 6.0f;
+        s.rotationSpeed = unit(random) - 0.5f;
+        s.motionType = (MotionType)(MOTION_LINEAR + i % 4);
+        s.motionAmount = 0.5f + unit(random);
+        s.reactsTo = (int)(unit(random) * (AUDIO_BAND_COUNT + 1)) - 1;
+        s.audioReactivity = unit(random);
+        s.circleRadius = 0.1f;
+        s.waveAmplitudeX = 0.1f;
+        s.waveAmplitudeY = 0.05f;
+        s.waveFrequencyX = 1.0f + unit(random);
+        s.waveFrequencyY = 1.0f + unit(random);
+        if (i % 50 == 0) {
+            s.x = 0.001f;
+            s.velocityX = -0.2f;
+        }
+        handles.push_back(system.add(s));
+        states.push_back(s);
+    }
+
+    // Packed by GpuParticles' own code
+    GpuParticleTexels texels;
+    texels.pack(states, vector<ofFloatColor>());
+    int columns = texels.columns;
+    int rows = texels.rows;
+    vector<float>* state[STATE_TEXTURES] = { &texels.stateA, &texels.stateB, &texels.stateC };
+
+    AudioFrame audio;
+    float energies[AUDIO_BAND_COUNT + 1];
+    float sum = 0;
+    for (int b = 0; b < AUDIO_BAND_COUNT; b++) {
+        audio.bandLevels[b] = energies[b] = unit(random);
+        sum += energies[b];
+    }
+    energies[AUDIO_BAND_COUNT] = sum / AUDIO_BAND_COUNT;
+
+    // Ping-pong framebuffers with three float attachments each
+    GLuint textures[2][STATE_TEXTURES];
+    GLuint framebuffers[2];
+    glGenFramebuffers(2, framebuffers);
+    for (int f = 0; f < 2; f++) {
+        glBindFramebuffer(GL_FRAMEBUFFER, framebuffers[f]);
+        for (int t = 0; t < STATE_TEXTURES; t++) {
+            textures[f][t] = makeFloatTexture(columns, rows, f == 0 ? state[t]->data() : nullptr);
+            glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0 + t, GL_TEXTURE_2D, textures[f][t], 0);
+        }
+        CHECK(glCheckFramebufferStatus(GL_FRAMEBUFFER) == GL_FRAMEBUFFER_COMPLETE, "state framebuffer incomplete");
+    }
+    GLuint motionTexture = makeFloatTexture(columns, rows, texels.motion.data());
+    GLuint waveTexture = makeFloatTexture(columns, rows, texels.wave.data());
+    GLuint baseTexture = makeFloatTexture(columns, rows, texels.base.data());
+
+    GLuint program = loadUpdateProgram();
+    CHECK(program != 0, "particle update shader failed to link");
+    if (program == 0) return checkResult("GpuParticlesTest");
+
+    // Full-target rectangle in state texel units, like ofDrawRectangle()
+    float quad[] = {
+        0, 0, 0, 1,  (float)columns, 0, 0, 1,  (float)columns, (float)rows, 0, 1,
+        0, 0, 0, 1,  (float)columns, (float)rows, 0, 1,  0, (float)rows, 0, 1
+    };
+    GLuint vertexArray, vertexBuffer;
+    glGenVertexArrays(1, &vertexArray);
+    glBindVertexArray(vertexArray);
+    glGenBuffers(1, &vertexBuffer);
+    glBindBuffer(GL_ARRAY_BUFFER, vertexBuffer);
+    glBufferData(GL_ARRAY_BUFFER, sizeof(quad), quad, GL_STATIC_DRAW);
+    glEnableVertexAttribArray(0);
+    glVertexAttribPointer(0, 4, GL_FLOAT, GL_FALSE, 0, nullptr);
+
+    float projection[16] = { 0 };
+    projection[0] = 2.0f / columns;
+    projection[5] = 2.0f / rows;
+    projection[10] = -1.0f;
+    projection[12] = -1.0f;
+    projection[13] = -1.0f;
+    projection[15] = 1.0f;
+
+    const float deltaTime = 1.0f / 60.0f;
+    const GLenum drawBuffers[STATE_TEXTURES] = { GL_COLOR_ATTACHMENT0, GL_COLOR_ATTACHMENT1, GL_COLOR_ATTACHMENT2 };
+    int current = 0;
+
+    glUseProgram(program);
+    glUniformMatrix4fv(glGetUniformLocation(program, "modelViewProjectionMatrix"), 1, GL_FALSE, projection);
+    glUniform1f(glGetUniformLocation(program, "deltaTime"), deltaTime);
+    glUniform1fv(glGetUniformLocation(program, "bandEnergies"), AUDIO_BAND_COUNT + 1, energies);
+    bindTexture(program, "motionParams", motionTexture, 4);
+    bindTexture(program, "waveParams", waveTexture, 5);
+    bindTexture(program, "baseParams", baseTexture, 6);
+    glViewport(0, 0, columns, rows);
+
+    for (int step = 0; step < STEPS; step++) {
+        // One draw into every attachment, as activateAllDrawBuffers() does
+        glBindFramebuffer(GL_FRAMEBUFFER, framebuffers[1 - current]);
+        glDrawBuffers(STATE_TEXTURES, drawBuffers);
+        bindTexture(program, "stateA", textures[current][0], 1);
+        bindTexture(program, "stateB", textures[current][1], 2);
+        bindTexture(program, "stateC", textures[current][2], 3);
+        glDrawArrays(GL_TRIANGLES, 0, 6);
+        current = 1 - current;
+
+        system.update(deltaTime, audio);
+    }
+    CHECK(glGetError() == GL_NO_ERROR, "GL error during the update passes");
+
+    // Read every attachment back
+    glBindFramebuffer(GL_READ_FRAMEBUFFER, framebuffers[current]);
+    for (int t = 0; t < STATE_TEXTURES; t++) {
+        glReadBuffer(GL_COLOR_ATTACHMENT0 + t);
+        glReadPixels(0, 0, columns, rows, GL_RGBA, GL_FLOAT, state[t]->data());
+    }
+
+    // SpriteSystem uses fast sine and atan approximations, the shader the
+    // GLSL built-ins, so allow a little drift over the steps
+    const float maxError = 2e-3f;
+    float positionError = 0, rotationError = 0, velocityError = 0, phaseError = 0;
+    int worstParticle = 0;
+    for (int i = 0; i < PARTICLES; i++) {
+        SpriteState s = system.get(handles[i]);
+        const float* a = &texels.stateA[i * 4];
+        const float* b = &texels.stateB[i * 4];
+        const float* c = &texels.stateC[i * 4];
+
+        float error = std::max(std::max(fabsf(a[0] - s.x), fabsf(a[1] - s.y)), fabsf(a[3] - s.scale));
+        if (error > positionError) {
+            positionError = error;
+            worstParticle = i;
+        }
+        rotationError = std::max(rotationError, angleError(a[2], s.rotation));
+        velocityError = std::max(velocityError, std::max(fabsf(b[0] - s.velocityX), fabsf(b[1] - s.velocityY)));
+        velocityError = std::max(velocityError, fabsf(b[2] - s.rotationSpeed));
+        phaseError = std::max(phaseError, angleError(b[3], s.circlePhase));
+        phaseError = std::max(phaseError, std::max(angleError(c[0], s.wavePhaseX), angleError(c[1], s.wavePhaseY)));
+    }
+
+    CHECK(positionError <= maxError, "position/scale error %g at particle %d", positionError, worstParticle);
+    CHECK(rotationError <= maxError, "rotation error %g", rotationError);
+    CHECK(velocityError <= maxError, "velocity error %g", velocityError);
+    CHECK(phaseError <= maxError, "circle/wave phase error %g", phaseError);
+
+    return checkResult("GpuParticlesTest");
+}
@@ -0,0 +1,148 @@
+// File: tests/PixelateTest.cpp
+// Checks PixelateEffect::pixelatePixels against a naive per-pixel reference
+#include "ofMain.h"
+#include "PixelateEffect.h"
+#include "Check.h"
+#include <random>
+
+// Naive reference: every output pixel averages its whole block again, and
+// the block turns black (keeping alpha) when its brightness is below the
+// threshold. Only 3 and 4 channel pixels have a brightness
+static void referencePixelate(const ofPixels& src, vector<unsigned char>& dst, int sizeX, int sizeY, float threshold) {
+    int w = (int)src.getWidth();
+    int h = (int)src.getHeight();
+    int channels = (int)src.getNumChannels();
+    const unsigned char* data = src.getData();
+    sizeX = std::max(1, std::min(sizeX, w));
+    sizeY = std::max(1, std::min(sizeY, h));
+    dst.assign(w * h * channels, 0);
+
+    for (int y = 0; y < h; y++) {
+        for (int x = 0; x < w; x++) {
+            int x0 = x / sizeX * sizeX;
+            int y0 = y / sizeY * sizeY;
+            int x1 = std::min(x0 + sizeX, w);
+            int y1 = std::min(y0 + sizeY, h);
+
+            double average[4] = { 0, 0, 0, 0 };
+            for (int by = y0; by < y1; by++) {
+                for (int bx = x0; bx < x1; bx++) {
+                    for (int c = 0; c < channels; c++) {
+                        average[c] += data[(by * w + bx) * channels + c];
+                    }
+                }
+            }
+            int rounded[4];
+            for (int c = 0; c < channels; c++) {
+                rounded[c] = (int)floor(average[c] / ((x1 - x0) * (y1 - y0)) + 0.5);
+            }
+
+            if (channels >= 3 && threshold < 1.0f) {
+                double brightness = (rounded[0] + rounded[1] + rounded[2]) / 3.0 / 255.0;
+                if (brightness < threshold) {
+                    rounded[0] = rounded[1] = rounded[2] = 0;
+                }
+            }
+            for (int c = 0; c < channels; c++) {
+                dst[(y * w + x) * channels + c] = (unsigned char)rounded[c];
+            }
+        }
+    }
+}
+
+static void fillRandom(ofPixels& pixels, int w, int h, int channels, unsigned int seed) {
+    std::mt19937 random(seed);
+    pixels.allocate(w, h, channels);
+    unsigned char* data = pixels.getData();
+    for (int i = 0; i < w * h * channels; i++) {
+        data[i] = random() & 255;
+    }
+}
+
+static int countMismatches(const ofPixels& pixels, const vector<unsigned char>& expected) {
+    const unsigned char* data = pixels.getData();
+    int mismatches = 0;
+    for (size_t i = 0; i < expected.size(); i++) {
+        mismatches += data[i] != expected[i];
+    }
+    return mismatches;
+}
+
+int main() {
+    // Sizes that do and do not divide the image, so the right and bottom
+    // edge blocks are partial, plus blocks larger than the image
+    const int sizes[][2] = { { 1, 1 }, { 4, 4 }, { 7, 5 }, { 16, 3 }, { 37, 29 }, { 200, 200 } };
+    const float thresholds[] = { 1.0f, 0.0f, 0.3f, 0.5f };
+
+    for (int channels : { 1, 3, 4 }) {
+        ofPixels src;
+        fillRandom(src, 61, 43, channels, 11 + channels);
+
+        for (auto& size : sizes) {
+            for (float threshold : thresholds) {
+                ofPixels dst;
+                vector<unsigned char> expected;
+                PixelateEffect::pixelatePixels(src, dst, size[0], size[1], threshold);
+                referencePixelate(src, expected, size[0], size[1], threshold);
+
+                CHECK(dst.getWidth() == src.getWidth() && dst.getHeight() == src.getHeight() &&
+                      dst.getNumChannels() == src.getNumChannels(),
+                      "%d channels: output not allocated to match the input", channels);
+                if (dst.getWidth() != src.getWidth()) continue;
+
+                int mismatches = countMismatches(dst, expected);
+                CHECK(mismatches == 0, "%d channels, %dx%d blocks, threshold %.1f: %d bytes differ",
+                      channels, size[0], size[1], threshold, mismatches);
+            }
+        }
+    }
+
+    // Threshold boundary: flat 3x3 blocks whose brightness sum steps across
+    // threshold * 765, for a threshold that falls between two sums and for
+    // thresholds at the nearest float to sum / 765. Blocks below the
+    // threshold are black, blocks at or above it are kept
+    for (int channels : { 3, 4 }) {
+        vector<float> boundaryThresholds = { 0.5f };
+        for (int sum = 1; sum < 765; sum += 7) {
+            boundaryThresholds.push_back(sum / 765.0f);
+        }
+
+        for (float threshold : boundaryThresholds) {
+            int center = (int)floor(threshold * 765.0);
+            ofPixels src;
+            src.allocate(3 * 5, 3, channels);
+            unsigned char* data = src.getData();
+            for (int block = 0; block < 5; block++) {
+                // Sums center - 2 to center + 2 spread over r, g and b
+                int sum = std::max(0, std::min(center - 2 + block, 765));
+                unsigned char color[4] = { (unsigned char)(sum / 3), (unsigned char)((sum + 1) / 3),
+                                           (unsigned char)((sum + 2) / 3), 200 };
+                for (int y = 0; y < 3; y++) {
+                    for (int x = block * 3; x < block * 3 + 3; x++) {
+                        memcpy(&data[(y * 15 + x) * channels], color, channels);
+                    }
+                }
+            }
+
+            ofPixels dst;
+            vector<unsigned char> expected;
+            PixelateEffect::pixelatePixels(src, dst, 3, 3, threshold);
+            referencePixelate(src, expected, 3, 3, threshold);
+            int mismatches = countMismatches(dst, expected);
+            CHECK(mismatches == 0, "%d channels, threshold %.9f (sum %d): %d bytes differ at the boundary",
+                  channels, threshold, center, mismatches);
+        }
+    }
+
+    // A dst that already matches the source is reused, not reallocated
+    {
+        ofPixels src, dst;
+        fillRandom(src, 33, 17, 4, 5);
+        dst.allocate(33, 17, 4);
+        const unsigned char* before = dst.getData();
+        PixelateEffect::pixelatePixels(src, dst, 8, 8, 0.4f);
+        CHECK(dst.getData() == before, "matching dst was reallocated");
+    }
+
+    return checkResult("PixelateTest");
+}
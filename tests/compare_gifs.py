@@ -0,0 +1,132 @@
+# Checks GifDecoder against Pillow, frame for frame and pixel for pixel.
+# Decodes every GIF under the given directories, plus a few generated ones
+# covering interlacing, local palettes, transparency and each disposal
+# method, with GifDecoderDump and compares the frames, durations and
+# skipFrame() count.
+#
+# Usage: python3 tests/compare_gifs.py bin/tests/GifDecoderDump data/Sprites
+import glob
+import os
+import subprocess
+import sys
+import tempfile
+
+from PIL import Image, ImageChops, ImageDraw
+
+
+def make_synthetic_gifs(directory):
+    paths = []
+
+    # Moving boxes over a transparent background, one file per disposal
+    # method
+    for disposal in (1, 2, 3):
+        frames = []
+        for i in range(6):
+            frame = Image.new("P", (48, 40), 0)
+            frame.putpalette([0, 0, 0, 255, 0, 0, 0, 255, 0, 0, 0, 255] + [0] * 756)
+            draw = ImageDraw.Draw(frame)
+            draw.rectangle([4 + i * 6, 4 + i * 3, 16 + i * 6, 18 + i * 3], fill=1 + i % 3)
+            frames.append(frame)
+        path = os.path.join(directory, "disposal%d.gif" % disposal)
+        frames[0].save(path, save_all=True, append_images=frames[1:], transparency=0,
+                       disposal=disposal, duration=[0, 10, 20, 50, 100, 70], loop=0)
+        paths.append(path)
+
+    # Pillow only interlaces single-frame files, so a still with a
+    # different colour on every row
+    still = Image.new("RGB", (48, 40))
+    still.putdata([(y * 6, 255 - y * 6, x * 5) for y in range(40) for x in range(48)])
+    path = os.path.join(directory, "interlaced.gif")
+    still.quantize(colors=128).save(path, interlace=True)
+    paths.append(path)
+
+    # Full-colour frames, so Pillow writes a local palette per frame
+    frames = []
+    for i in range(4):
+        frame = Image.new("RGB", (40, 36))
+        frame.putdata([((x * 6 + i * 40) % 256, (y * 7) % 256, (x * y + i * 60) % 256)
+                       for y in range(36) for x in range(40)])
+        frames.append(frame.quantize(colors=64))
+    path = os.path.join(directory, "palettes.gif")
+    frames[0].save(path, save_all=True, append_images=frames[1:], duration=40, loop=0)
+    paths.append(path)
+
+    return paths
+
+
+def expected_duration(milliseconds):
+    # GifDecoder plays delays of 0 or 1 hundredths at 100 ms, like browsers
+    return milliseconds / 1000.0 if milliseconds > 10 else 0.1
+
+
+def compare(dump, path, raw_path):
+    result = subprocess.run([dump, path, raw_path], capture_output=True, text=True)
+    if result.returncode != 0:
+        return "decoder failed"
+
+    lines = result.stdout.split()
+    width, height = int(lines[0]), int(lines[1])
+    durations = [float(value) for value in lines[2:-2]]
+    skipped = int(lines[-1])
+
+    with open(raw_path, "rb") as f:
+        raw = f.read()
+    frame_bytes = width * height * 4
+
+    image = Image.open(path)
+    frame_count = getattr(image, "n_frames", 1)
+    if (image.width, image.height) != (width, height):
+        return "size %dx%d, Pillow %dx%d" % (width, height, image.width, image.height)
+    if len(durations) != frame_count or skipped != frame_count:
+        return "%d frames, %d skipped, Pillow %d" % (len(durations), skipped, frame_count)
+
+    for i in range(frame_count):
+        image.seek(i)
+        decoded = Image.frombytes("RGBA", (width, height), raw[i * frame_bytes:(i + 1) * frame_bytes])
+
+        # GIF alpha is 0 or 255, so premultiplying is exact and makes every
+        # fully transparent pixel 0, 0, 0, 0 whatever its palette colour
+        reference = image.convert("RGBA").convert("RGBa")
+        decoded = decoded.convert("RGBa")
+        if reference.tobytes() != decoded.tobytes():
+            box = ImageChops.difference(reference, decoded).getbbox(alpha_only=False)
+            return "frame %d differs within %s" % (i, box)
+
+        expected = expected_duration(image.info.get("duration", 0))
+        if abs(durations[i] - expected) > 1e-4:
+            return "frame %d lasts %g s, expected %g s" % (i, durations[i], expected)
+
+    return None
+
+
+def main():
+    if len(sys.argv) < 2:
+        print("Usage: compare_gifs.py GifDecoderDump [directory...]")
+        return 2
+
+    dump = os.path.abspath(sys.argv[1])
+    failures = 0
+    checked = 0
+
+    with tempfile.TemporaryDirectory() as directory:
+        paths = make_synthetic_gifs(directory)
+        for root in sys.argv[2:]:
+            paths += sorted(glob.glob(os.path.join(root, "**", "*.gif"), recursive=True))
+
+        raw_path = os.path.join(directory, "frames.raw")
+        for path in paths:
+            error = compare(dump, path, raw_path)
+            checked += 1
+            if error:
+                failures += 1
+                print("FAIL %s: %s" % (path, error))
+
+    if failures:
+        print("compare_gifs: %d of %d files differ" % (failures, checked))
+        return 1
+    print("compare_gifs: %d files ok" % checked)
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())